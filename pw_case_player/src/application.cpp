@@ -19,6 +19,10 @@
  ***************************************************************************/
 // application.cpp: implementation of Application class
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <sstream>
 #include <glibmm.h>
 #include "SDL.h"
@@ -26,9 +30,15 @@
 
 #include "application.h"
 #include "audio.h"
+#include "clock.h"
 #include "font.h"
+#include "input.h"
 #include "iohandler.h"
 #include "intl.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "textparser.h"
+#include "texture.h"
 #include "utilities.h"
 
 Application *g_Application=NULL;
@@ -38,6 +48,10 @@ ustring Application::VERSION="1.0b";
 // constructor
 Application::Application(int argc, char *argv[]) {
 	m_ArgFlags=ARG_NONE;
+	m_HeadlessFrames=3600;
+	m_FrameTime=16;
+	m_Frame=0;
+	m_NextEvent=0;
 	
 	// iterate over arguments
 	for (int i=1; i<argc; i++) {
@@ -71,6 +85,49 @@ Application::Application(int argc, char *argv[]) {
 			else if (longArg=="fullscreen" || shortArg=="fs")
 				m_ArgFlags |= ARG_FULLSCREEN;
 			
+			// synchronize with the display
+			else if (longArg=="vsync")
+				m_ArgFlags |= ARG_VSYNC;
+			
+			// load case images only when needed
+			else if (longArg=="lazy-assets" || shortArg=="la")
+				m_ArgFlags |= ARG_LAZY_ASSETS;
+			
+			// run without video and audio output
+			else if (longArg=="headless")
+				m_ArgFlags |= ARG_HEADLESS;
+			
+			// input script for headless mode
+			else if (longArg.find("input=")==0)
+				m_InputPath=longArg.substr(longArg.find("=")+1);
+			
+			// amount of frames to run in headless mode
+			else if (longArg.find("frames=")==0)
+				m_HeadlessFrames=atoi(longArg.substr(longArg.find("=")+1).c_str());
+			
+			// length of a headless frame
+			else if (longArg.find("frame-time=")==0)
+				m_FrameTime=std::max(1, atoi(longArg.substr(longArg.find("=")+1).c_str()));
+			
+			// record input to a file
+			else if (longArg.find("record=")==0)
+				m_RecordPath=longArg.substr(longArg.find("=")+1);
+			
+			// play back recorded input
+			else if (longArg.find("replay=")==0)
+				m_ReplayPath=longArg.substr(longArg.find("=")+1);
+			
+			// record a trace of loading and playing
+			else if (longArg.find("trace=")==0)
+				m_TracePath=longArg.substr(longArg.find("=")+1);
+			
+			// limit texture memory; evicted case images are decoded again from
+			// the case file, so it needs to stay mapped
+			else if (longArg.find("texture-budget=")==0) {
+				Textures::setBudget(atoi(longArg.substr(longArg.find("=")+1).c_str())*1024*1024);
+				m_ArgFlags |= ARG_LAZY_ASSETS;
+			}
+			
 			else
 				Utils::alert(_("Unrecognized argument passed to player")+": '"+arg+"'.");
 		}
@@ -91,18 +148,36 @@ Application* Application::instance() {
 
 // run the application
 void Application::run() {
+	// the trace covers everything from here on
+	if (m_TracePath!="")
+		Profiler::startTrace();
+	
 	// create a new gl context
 	m_SDLContext=SDLContext::create();
 	
 	// initialize it
-	if (!m_SDLContext->init())
+	bool headless=(m_ArgFlags & ARG_HEADLESS);
+	if (!m_SDLContext->init(headless))
 		return;
 	
+	// recorded input replaces the input script, and brings its own random seed
+	if (m_ReplayPath!="") {
+		if (!loadInputLog(m_ReplayPath))
+			return;
+	}
+	
+	// otherwise start recording before anything can draw a random number
+	else if (m_RecordPath!="")
+		Input::startRecording(Utils::getRandomSeed(), m_FrameTime);
+	
 	// see how much time has elapsed since the program started loading
 	int start=SDL_GetTicks();
 	
-	// unpack the resource file before anything
-	if (!IO::unpackResourceFile("data.dpkg"))
+	// read the resource file into memory before anything
+	Profiler::begin("load resources");
+	bool resources=IO::loadResourceFile("data.dpkg");
+	Profiler::end("load resources");
+	if (!resources)
 		return;
 	
 	// set the language to use
@@ -112,86 +187,367 @@ void Application::run() {
 	}
 	
 	// initialize audio, unless NO_SOUND was passed
-	if (!(m_ArgFlags & ARG_NO_SOUND))
+	if (!(m_ArgFlags & ARG_NO_SOUND) && !headless)
 		Audio::g_Output=m_SDLContext->initAudio();
 	
 	// initialize video
-	if (!m_SDLContext->initVideo(256, 389, (m_ArgFlags & ARG_FULLSCREEN)))
+	if (headless) {
+		if (!m_SDLContext->initNullVideo(256, 389))
+			return;
+		
+		// read scripted input before the clock starts
+		if (m_ReplayPath=="" && m_InputPath!="" && !loadInputScript(m_InputPath))
+			return;
+	}
+	
+	else if (!m_SDLContext->initVideo(256, 389, (m_ArgFlags & ARG_FULLSCREEN), (m_ArgFlags & ARG_VSYNC)))
 		return;
 	
+	// buffer swaps already pace the frames
+	if (m_SDLContext->hasVSync())
+		m_Timer.setFPSLock(0);
+	
+	// recording and playback need game time to depend only on the frame count
+	if (headless || m_RecordPath!="" || m_ReplayPath!="") {
+		Clock::useVirtual();
+		m_Timer.setFPSLock(1000.0/m_FrameTime);
+	}
+	
 	// initialize ttf font library
 	if (TTF_Init()==-1)
 		return;
 	
 	// initialize game data
-	if (!m_SDLContext->initGame(m_CasePath))
+	if (!m_SDLContext->initGame(m_CasePath, (m_ArgFlags & ARG_LAZY_ASSETS)))
 		return;
 	
-	// remove the resource directory
-	Utils::FS::removeDir(".temp");
-	
 	// calculate elapsed time
 	int time=(SDL_GetTicks()-start);
 	std::cout << _("Loading time was") << " " << float((time/1000)) << " " << _("seconds") << ".\n";
 	
+	// show how much texture memory the case needs
+	if (Utils::g_DebugOn)
+		Textures::printUsage();
+	
+	// without output, just run the game logic and report on it
+	if (headless) {
+		runHeadless();
+		saveRecording();
+		saveTrace();
+		TTF_Quit();
+		return;
+	}
+	
 	// set the window manager title
 	SDL_WM_SetCaption("PW Case Player", 0);
 	
 	// start main loop
 	bool loop=true;
 	while(loop) {
+		Profiler::beginFrame();
+		
 		// process pending events in the loop
-		loop=processEvents();
+		loop=processEvents() && deliverScriptedEvents();
+		if (!loop)
+			break;
 		
 		// make sure to keep a consistent frame rate
+		Profiler::beginPhase(Profiler::PHASE_WAIT);
 		m_Timer.delay();
+		Profiler::endPhase(Profiler::PHASE_WAIT);
 		
-		// render the scene
+		// move game time forward, and render the scene
+		Clock::advance(m_FrameTime);
 		m_SDLContext->render();
+		m_Frame++;
 		
 		// calculate and display FPS
 		calculateFPS();
+		
+		// a replay ends where its recording did
+		if (m_ReplayPath!="" && m_Frame>=m_HeadlessFrames)
+			loop=false;
+		
+		// frames of the virtual clock must not be skipped
+		else if (!Clock::g_Virtual) {
+			Profiler::beginPhase(Profiler::PHASE_WAIT);
+			waitForChange();
+			Profiler::endPhase(Profiler::PHASE_WAIT);
+		}
+		
+		Profiler::endFrame();
 	}
 	
+	// save what was recorded
+	saveRecording();
+	saveTrace();
+	
 	// and clean up the ttf library
 	TTF_Quit();
 }
 
+// run the game logic without output
+void Application::runHeadless() {
+	TextParser *parser=TextParser::instance();
+	int startBlocks=(parser ? parser->getExecutedBlocks() : 0);
+	
+	Uint32 start=SDL_GetTicks();
+	while(m_Frame<m_HeadlessFrames) {
+		// deliver input scheduled for this frame
+		if (!deliverScriptedEvents())
+			break;
+		
+		// move time forward by exactly one frame, and run it
+		Profiler::beginFrame();
+		Clock::advance(m_FrameTime);
+		m_SDLContext->render();
+		m_Frame++;
+		Profiler::endFrame();
+	}
+	Uint32 elapsed=SDL_GetTicks()-start;
+	
+	// the parser might have been created once the game started
+	parser=TextParser::instance();
+	int blocks=(parser ? parser->getExecutedBlocks()-startBlocks : 0);
+	
+	// avoid dividing by zero for very short runs
+	double seconds=(elapsed>0 ? elapsed/1000.0 : 0.001);
+	
+	std::cout << "Headless run: " << m_Frame << " frames (" << m_Frame*m_FrameTime << "ms of game time) in " 
+		  << elapsed << "ms\n";
+	std::cout << "  " << m_Frame/seconds << " frames/sec\n";
+	std::cout << "  " << blocks << " blocks executed, " << blocks/seconds << " blocks/sec\n";
+	std::cout << "  " << m_NextEvent << " of " << m_Script.size() << " scripted events delivered\n";
+	Textures::printUsage();
+}
+
+// deliver scripted input for the current frame
+bool Application::deliverScriptedEvents() {
+	while(m_NextEvent<m_Script.size() && m_Script[m_NextEvent].frame<=m_Frame) {
+		SDL_Event &e=m_Script[m_NextEvent++].event;
+		
+		// scripted input can be recorded as well, but a replay never is
+		Input::record(m_Frame, e);
+		if (!handleEvent(e))
+			return false;
+	}
+	
+	return true;
+}
+
+// save recorded input
+void Application::saveRecording() {
+	if (!Input::g_Recording)
+		return;
+	
+	Input::stopRecording(m_Frame);
+	if (!IO::saveInputLog(m_RecordPath, Input::g_Log))
+		Utils::alert("Unable to save input recording: '"+m_RecordPath+"'", Utils::MESSAGE_WARNING);
+}
+
+// save the recorded trace
+void Application::saveTrace() {
+	if (!Profiler::g_Tracing)
+		return;
+	
+	if (!Profiler::saveTrace(m_TracePath))
+		Utils::alert("Unable to save trace: '"+m_TracePath+"'", Utils::MESSAGE_WARNING);
+}
+
+// load recorded input
+bool Application::loadInputLog(const ustring &path) {
+	Input::Log log;
+	if (!IO::loadInputLog(path, log)) {
+		Utils::alert("Unable to load input recording: '"+path+"'");
+		return false;
+	}
+	
+	// replay with the exact same parameters the session was recorded with
+	Utils::seedRandom(log.seed);
+	m_FrameTime=log.frameTime;
+	m_HeadlessFrames=log.frames;
+	
+	// events were recorded in the order they were handled
+	m_Script.clear();
+	for (int i=0; i<log.events.size(); i++) {
+		ScriptedEvent se;
+		se.frame=log.events[i].frame;
+		se.event=Input::toSDLEvent(log.events[i]);
+		m_Script.push_back(se);
+	}
+	
+	return true;
+}
+
+// order scripted events by frame
+static bool compareScriptedEvents(const ScriptedEvent &a, const ScriptedEvent &b) {
+	return a.frame<b.frame;
+}
+
+// load scripted input events
+bool Application::loadInputScript(const ustring &path) {
+	std::ifstream file(path.c_str());
+	if (!file) {
+		Utils::alert("Unable to open input script: '"+path+"'");
+		return false;
+	}
+	
+	std::string line;
+	int lineNum=0;
+	while(std::getline(file, line)) {
+		lineNum++;
+		
+		std::stringstream ss(line);
+		std::string type;
+		ScriptedEvent se;
+		memset(&se.event, 0, sizeof(SDL_Event));
+		
+		// skip empty lines and comments
+		if (!(ss >> se.frame)) {
+			std::stringstream cs(line);
+			if ((cs >> type) && type[0]!='#')
+				Utils::alert("Input script line "+Utils::itoa(lineNum)+" has no frame number", Utils::MESSAGE_WARNING);
+			continue;
+		}
+		
+		ss >> type;
+		
+		// key press, either by name or by key code
+		if (type=="key") {
+			std::string name;
+			ss >> name;
+			
+			SDLKey key=SDLK_UNKNOWN;
+			if (name=="return") key=SDLK_RETURN;
+			else if (name=="up") key=SDLK_UP;
+			else if (name=="down") key=SDLK_DOWN;
+			else if (name=="left") key=SDLK_LEFT;
+			else if (name=="right") key=SDLK_RIGHT;
+			else if (name=="escape") key=SDLK_ESCAPE;
+			else key=(SDLKey) atoi(name.c_str());
+			
+			if (key==SDLK_UNKNOWN) {
+				Utils::alert("Input script line "+Utils::itoa(lineNum)+" has an unknown key: '"+name+"'", Utils::MESSAGE_WARNING);
+				continue;
+			}
+			
+			se.event.type=SDL_KEYDOWN;
+			se.event.key.type=SDL_KEYDOWN;
+			se.event.key.state=SDL_PRESSED;
+			se.event.key.keysym.sym=key;
+		}
+		
+		// left mouse button click at a point
+		else if (type=="click") {
+			int x=0, y=0;
+			ss >> x >> y;
+			
+			se.event.type=SDL_MOUSEBUTTONDOWN;
+			se.event.button.type=SDL_MOUSEBUTTONDOWN;
+			se.event.button.button=SDL_BUTTON_LEFT;
+			se.event.button.state=SDL_PRESSED;
+			se.event.button.x=x;
+			se.event.button.y=y;
+		}
+		
+		else {
+			Utils::alert("Input script line "+Utils::itoa(lineNum)+" has an unknown event: '"+type+"'", Utils::MESSAGE_WARNING);
+			continue;
+		}
+		
+		m_Script.push_back(se);
+	}
+	
+	// events need to be delivered in order, but keep lines on the same frame as written
+	std::stable_sort(m_Script.begin(), m_Script.end(), compareScriptedEvents);
+	
+	return true;
+}
+
 // process any events
 bool Application::processEvents() {
 	SDL_Event e;
 	
 	// see if we have any events
 	while(SDL_PollEvent(&e)) {
-		switch(e.type) {
-			// quit event
-			case SDL_QUIT: return false;
-			
-			// keyboard event
-			case SDL_KEYDOWN: {
-				// process this event first
-				bool ret=keyboardEvent(e.key);
-				if (!ret)
-					return ret;
-				
-				// if it wasn't a critical event, pass it to the context
-				m_SDLContext->onKeyboardEvent(&e.key);
-			}; break;
-			
-			// mouse button event
-			case SDL_MOUSEBUTTONUP:
-			case SDL_MOUSEBUTTONDOWN: {
-				// pass this event to the context
-				m_SDLContext->onMouseEvent(&e.button);
-			}; break;
-			
-			default: break;
+		// while replaying, the player may only quit
+		if (m_ReplayPath!="") {
+			if (e.type==SDL_QUIT || (e.type==SDL_KEYDOWN && !keyboardEvent(e.key)))
+				return false;
+			continue;
 		}
+		
+		Input::record(m_Frame, e);
+		if (!handleEvent(e))
+			return false;
+	}
+	
+	return true;
+}
+
+// deliver an event to the context
+bool Application::handleEvent(SDL_Event &e) {
+	// keep track of which keys and buttons are held
+	Input::update(e);
+	
+	switch(e.type) {
+		// quit event
+		case SDL_QUIT: return false;
+		
+		// keyboard event
+		case SDL_KEYDOWN: {
+			// process this event first
+			bool ret=keyboardEvent(e.key);
+			if (!ret)
+				return ret;
+			
+			// if it wasn't a critical event, pass it to the context
+			m_SDLContext->onKeyboardEvent(&e.key);
+		}; break;
+		
+		// mouse button event
+		case SDL_MOUSEBUTTONUP:
+		case SDL_MOUSEBUTTONDOWN: {
+			// pass this event to the context
+			m_SDLContext->onMouseEvent(&e.button);
+		}; break;
+		
+		default: break;
 	}
 	
 	return true;
 }
 
+// wake up the main loop once a scheduled change is due
+static Uint32 onChangeDue(Uint32 interval, void *param) {
+	SDL_Event e;
+	e.type=SDL_USEREVENT;
+	e.user.code=0;
+	e.user.data1=NULL;
+	e.user.data2=NULL;
+	SDL_PushEvent(&e);
+	
+	return 0;
+}
+
+// sleep while nothing is about to change
+void Application::waitForChange() {
+	Uint32 now=Clock::ticks();
+	Uint32 next=Clock::nextChange();
+	
+	// something changes before the next frame anyway
+	if (next<=now || next-now<=Clock::FRAME_TIME)
+		return;
+	
+	// check back every so often, in case something changes without telling
+	Uint32 timeout=std::min(next-now, (Uint32) MAX_IDLE_WAIT);
+	SDL_TimerID timer=SDL_AddTimer(timeout, onChangeDue, NULL);
+	
+	// wait for either the timer or some input, leaving the event in the queue
+	SDL_WaitEvent(NULL);
+	SDL_RemoveTimer(timer);
+}
+
 // calculate and display fps
 void Application::calculateFPS() {
 	static Uint32 last=0;
@@ -205,6 +561,13 @@ void Application::calculateFPS() {
 		// set the wm title to include fps
 		std::stringstream ss;
 		ss << "PW Case Player - " << ff << " FPS";
+		
+		// include renderer counters when debugging
+		if (Utils::g_DebugOn) {
+			Renderer::FrameStats stats=Renderer::g_LastFrameStats;
+			ss << " (" << stats.quads << " quads, " << stats.drawCalls << " draw calls, "
+			   << stats.stateChanges << " state changes, " << stats.regionHits << " retained regions)";
+		}
 		SDL_WM_SetCaption(ss.str().c_str(), 0);
 		
 		// reset frame counter
@@ -23,10 +23,21 @@
 #define APPLICATION_H
 
 #include <iostream>
+#include <vector>
 
 #include "fpstimer.h"
 #include "sdlcontext.h"
 
+/// Longest time the main loop sleeps while nothing changes, in milliseconds
+const int MAX_IDLE_WAIT=250;
+
+/// An input event scheduled for a certain frame in headless mode
+struct _ScriptedEvent {
+	int frame;		///< The frame to deliver the event at
+	SDL_Event event;	///< The synthesized SDL event
+};
+typedef struct _ScriptedEvent ScriptedEvent;
+
 /** Class that controls toplevel functions.
   * The Application class handles many functions that relate to the
   * functionality of the player as a whole. This includes window manager
@@ -38,7 +49,7 @@ class Application {
 		static ustring VERSION;
 		
 		/// Possible command line arguments
-		enum ArgFlags { ARG_NONE=0x00, ARG_NO_SOUND=0x01, ARG_FULLSCREEN=0x02 };
+		enum ArgFlags { ARG_NONE=0x00, ARG_NO_SOUND=0x01, ARG_FULLSCREEN=0x02, ARG_LAZY_ASSETS=0x04, ARG_HEADLESS=0x08, ARG_VSYNC=0x10 };
 		
 		/** Constructor
 		  * \param argc Amount of arguments
@@ -60,11 +71,55 @@ class Application {
 		void run();
 		
 	private:
+		/** Run the game logic without video or audio output, as fast as possible.
+		  * Time is taken from a virtual clock that advances by a fixed amount each 
+		  * frame, and input is read from a script instead of the event queue.
+		*/
+		void runHeadless();
+		
+		/** Load scripted input events from a file.
+		  * Each line has the form <i>frame key name</i> or <i>frame click x y</i>, 
+		  * where <i>name</i> is a key name such as <i>return</i> or an SDL key code. 
+		  * Empty lines and lines starting with # are ignored.
+		  * \param path Path to the input script
+		  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
+		*/
+		bool loadInputScript(const ustring &path);
+		
+		/** Load recorded input, and set up the session it was recorded in
+		  * \param path Path to the recording
+		  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
+		*/
+		bool loadInputLog(const ustring &path);
+		
+		/** Deliver scripted or recorded input for the current frame
+		  * \return <b>true</b> if the event loop should continue, <b>false</b> otherwise
+		*/
+		bool deliverScriptedEvents();
+		
+		/// Stop recording input, and save it to file
+		void saveRecording();
+		
+		/// Stop recording the trace, and save it to file
+		void saveTrace();
+		
 		/** Process any events
 		  * \return <b>true</b> if the event loop should continue, <b>false</b> otherwise
 		*/
 		bool processEvents();
 		
+		/** Deliver an event to the context
+		  * \param e The event to handle
+		  * \return <b>true</b> if the event loop should continue, <b>false</b> otherwise
+		*/
+		bool handleEvent(SDL_Event &e);
+		
+		/** Sleep while nothing on screen is about to change.
+		  * Drawing a frame schedules the time of the next change on the clock. If that's 
+		  * further away than a frame, this waits until then, or until an event arrives.
+		*/
+		void waitForChange();
+		
 		/// Calculate and display the FPS
 		void calculateFPS();
 		
@@ -85,6 +140,33 @@ class Application {
 		
 		/// Arguments from the command line
 		int m_ArgFlags;
+		
+		/// Path to the input script used in headless mode
+		ustring m_InputPath;
+		
+		/// Path to save recorded input to
+		ustring m_RecordPath;
+		
+		/// Path to recorded input to play back
+		ustring m_ReplayPath;
+		
+		/// Path to save the trace to
+		ustring m_TracePath;
+		
+		/// Amount of frames to run in headless mode, or to replay
+		int m_HeadlessFrames;
+		
+		/// Virtual milliseconds that pass each frame in headless mode or while recording
+		int m_FrameTime;
+		
+		/// Scripted input events, sorted by frame
+		std::vector<ScriptedEvent> m_Script;
+		
+		/// Index of the next scripted event to deliver
+		int m_NextEvent;
+		
+		/// Amount of frames run so far
+		int m_Frame;
 };
 
 #endif
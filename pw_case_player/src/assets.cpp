@@ -0,0 +1,228 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// assets.cpp: implementation of the Assets namespace
+
+#include "SDL_image.h"
+
+#include "assets.h"
+#include "clock.h"
+#include "decodequeue.h"
+#include "profiler.h"
+#include "sprite.h"
+#include "texture.h"
+#include "utilities.h"
+#include "vfs.h"
+
+namespace Assets {
+
+std::map<GLuint, DeferredTexture> g_Deferred;
+std::map<ustring, GLuint> g_DeferredIds;
+std::map<GLuint, DeferredTexture> g_Sources;
+std::map<GLuint, ustring> g_Prefetching;
+std::vector<IO::MappedFile> g_Files;
+DecodeQueue *g_Prefetcher=NULL;
+
+}
+
+// record an image without decoding it
+GLuint Assets::deferTexture(const ustring &id, IO::MappedFile &mf, int alpha) {
+	DeferredTexture tex;
+	tex.id=id;
+	tex.alpha=alpha;
+	tex.data=IO::readImageData(mf, tex.size);
+	tex.file="";
+	
+	// reserve a name for the texture, so it can be referenced right away
+	GLuint name=Textures::generateName();
+	
+	g_Deferred[name]=tex;
+	if (id!=STR_NULL)
+		g_DeferredIds[id]=name;
+	
+	return name;
+}
+
+// keep a mapped file open
+void Assets::keepMapped(const IO::MappedFile &mf) {
+	g_Files.push_back(mf);
+}
+
+// make sure a texture is loaded
+bool Assets::require(GLuint id) {
+	// the texture might already be on its way; upload just this one, and
+	// let the rest of the queue keep decoding in the background
+	std::map<GLuint, ustring>::iterator pit=g_Prefetching.find(id);
+	if (pit!=g_Prefetching.end()) {
+		if ((*pit).second!=STR_NULL)
+			g_DeferredIds.erase((*pit).second);
+		g_Prefetching.erase(pit);
+		
+		return g_Prefetcher->uploadNow(id);
+	}
+	
+	std::map<GLuint, DeferredTexture>::iterator it=g_Deferred.find(id);
+	if (it==g_Deferred.end())
+		return false;
+	
+	DeferredTexture tex=(*it).second;
+	g_Deferred.erase(it);
+	if (tex.id!=STR_NULL)
+		g_DeferredIds.erase(tex.id);
+	g_Sources[id]=tex;
+	
+	if (Utils::g_IDebugOn)
+		Utils::message("Loading texture on demand: "+Utils::itoa(id)+"\n");
+	
+	// decode the image now, from the case file or from an image file
+	SDL_Surface *srf=NULL;
+	SDL_RWops *rw=NULL;
+	if (tex.data)
+		rw=SDL_RWFromConstMem(tex.data, tex.size);
+	else if (tex.file!="")
+		rw=VFS::open(tex.file);
+	if (rw)
+		srf=IMG_Load_RW(rw, 1);
+	
+	Textures::PreparedImage img;
+	if (!srf || !Textures::prepareSurface(srf, tex.alpha, img)) {
+		Utils::alert("Error loading internal image: '"+ustring(SDL_GetError())+"'");
+		
+		// keep the name reserved, since it is already stored; it resolves to the null texture
+		return false;
+	}
+	
+	Textures::uploadTexture(tex.id, img, id);
+	return true;
+}
+
+// make sure a texture is loaded
+bool Assets::require(const ustring &id) {
+	std::map<ustring, GLuint>::iterator it=g_DeferredIds.find(id);
+	if (it==g_DeferredIds.end())
+		return false;
+	
+	return require((*it).second);
+}
+
+// start decoding a texture in the background
+void Assets::prefetch(GLuint id) {
+	std::map<GLuint, DeferredTexture>::iterator it=g_Deferred.find(id);
+	if (it==g_Deferred.end() || !(*it).second.data)
+		return;
+	
+	// start the worker threads the first time they are needed
+	if (!g_Prefetcher)
+		g_Prefetcher=new DecodeQueue;
+	
+	// the id stays in g_DeferredIds until the texture is uploaded
+	DeferredTexture tex=(*it).second;
+	g_Deferred.erase(it);
+	
+	g_Sources[id]=tex;
+	g_Prefetcher->push(tex.id, tex.data, tex.size, tex.alpha, id);
+	g_Prefetching[id]=tex.id;
+}
+
+// start decoding a sprite in the background
+void Assets::prefetchSprite(Sprite *sprite) {
+	if (!sprite || g_Deferred.empty())
+		return;
+	
+	AnimationMap anims=sprite->getAnimations();
+	for (AnimationMapIter it=anims.begin(); it!=anims.end(); ++it) {
+		for (int i=0; i<(*it).second.frames.size(); i++)
+			prefetch((*it).second.frames[i].image);
+	}
+}
+
+// remember the file a texture was loaded from
+void Assets::addSource(GLuint id, const ustring &file, int alpha) {
+	DeferredTexture tex;
+	tex.id=STR_NULL;
+	tex.data=NULL;
+	tex.size=0;
+	tex.file=file;
+	tex.alpha=alpha;
+	
+	g_Sources[id]=tex;
+}
+
+// check if a texture can be loaded again
+bool Assets::hasSource(GLuint id) {
+	return (g_Sources.find(id)!=g_Sources.end());
+}
+
+// defer an evicted texture
+void Assets::restore(GLuint id, const ustring &texId) {
+	std::map<GLuint, DeferredTexture>::iterator it=g_Sources.find(id);
+	if (it==g_Sources.end())
+		return;
+	
+	// register it under the same id as before
+	DeferredTexture tex=(*it).second;
+	tex.id=texId;
+	
+	g_Deferred[id]=tex;
+	if (texId!=STR_NULL)
+		g_DeferredIds[texId]=id;
+}
+
+// upload textures that finished decoding
+void Assets::update() {
+	if (!g_Prefetcher || g_Prefetching.empty())
+		return;
+	
+	// keep drawing frames until everything is uploaded
+	Clock::busy();
+	
+	Profiler::begin("upload assets");
+	g_Prefetcher->uploadFinished();
+	Profiler::end("upload assets");
+	
+	// once everything is uploaded, the textures can be found by id as usual
+	if (g_Prefetcher->empty()) {
+		for (std::map<GLuint, ustring>::iterator it=g_Prefetching.begin(); it!=g_Prefetching.end(); ++it) {
+			// unless it was evicted again in the meantime
+			if ((*it).second!=STR_NULL && g_Deferred.find((*it).first)==g_Deferred.end())
+				g_DeferredIds.erase((*it).second);
+		}
+		g_Prefetching.clear();
+	}
+}
+
+// release everything
+void Assets::clear() {
+	if (g_Prefetcher) {
+		delete g_Prefetcher;
+		g_Prefetcher=NULL;
+	}
+	g_Prefetching.clear();
+	
+	// give back the names of images that were never used
+	for (std::map<GLuint, DeferredTexture>::iterator it=g_Deferred.begin(); it!=g_Deferred.end(); ++it)
+		Textures::deleteName((*it).first);
+	g_Deferred.clear();
+	g_DeferredIds.clear();
+	g_Sources.clear();
+	
+	for (int i=0; i<g_Files.size(); i++)
+		IO::unmapFile(g_Files[i]);
+	g_Files.clear();
+}
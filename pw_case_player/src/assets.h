@@ -0,0 +1,140 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// assets.h: on-demand loading of case images
+
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <map>
+#include <set>
+#include <vector>
+#include <GL/gl.h>
+
+#include "common.h"
+#include "iohandler.h"
+
+class DecodeQueue;
+class Sprite;
+
+/** Namespace for case images that are loaded only when needed.
+  * When a case is loaded lazily, its images are not decoded right away. Instead, 
+  * a GL texture name is reserved for each image and the location of its data in the 
+  * case file is recorded, while the file itself stays mapped. The image is then decoded 
+  * and uploaded the first time the texture is queried, or ahead of time on a background 
+  * thread when it is prefetched.
+  *
+  * The source of every image is remembered after it is loaded, so that a texture 
+  * evicted to stay within the texture memory budget can be decoded again later.
+*/
+namespace Assets {
+
+/// Struct representing an image that has not been decoded yet
+struct _DeferredTexture {
+	ustring id;		///< The ID to register the texture under
+	const char *data;	///< Pointer to the compressed image data, or NULL if it's read from a file
+	int size;		///< Size of the image data in bytes
+	ustring file;		///< Path to the image file, if there is no image data
+	int alpha;		///< The alpha value to apply
+};
+typedef struct _DeferredTexture DeferredTexture;
+
+/// Map of GL texture names to images that haven't been loaded yet
+extern std::map<GLuint, DeferredTexture> g_Deferred;
+
+/// Map of texture IDs to GL texture names of images that haven't been loaded yet
+extern std::map<ustring, GLuint> g_DeferredIds;
+
+/// Map of GL texture names to where their images can be loaded from again
+extern std::map<GLuint, DeferredTexture> g_Sources;
+
+/** GL texture names of images that are being decoded in the background, mapped to their IDs.
+  * Their IDs stay in g_DeferredIds until they are uploaded, so they can still be found by ID.
+*/
+extern std::map<GLuint, ustring> g_Prefetching;
+
+/// Mapped files which deferred images point into
+extern std::vector<IO::MappedFile> g_Files;
+
+/// Worker threads used for prefetching
+extern DecodeQueue *g_Prefetcher;
+
+/** Record an image in a mapped file, without decoding it
+  * \param id The ID of the texture, or STR_NULL for an automatic name
+  * \param mf The mapped file with read pointer set to the image
+  * \param alpha The requested alpha value to apply
+  * \return The GL texture name reserved for this image
+*/
+GLuint deferTexture(const ustring &id, IO::MappedFile &mf, int alpha=255);
+
+/** Keep a mapped file open for as long as deferred images need it
+  * \param mf The mapped file
+*/
+void keepMapped(const IO::MappedFile &mf);
+
+/** Make sure a texture is loaded, decoding it right away if needed
+  * \param id The GL texture name
+  * \return <b>true</b> if the texture was just loaded, <b>false</b> otherwise
+*/
+bool require(GLuint id);
+
+/** Make sure a texture is loaded, decoding it right away if needed
+  * \param id The ID of the texture
+  * \return <b>true</b> if the texture was just loaded, <b>false</b> otherwise
+*/
+bool require(const ustring &id);
+
+/** Start decoding a texture in the background
+  * \param id The GL texture name
+*/
+void prefetch(GLuint id);
+
+/** Start decoding all frames of a sprite in the background
+  * \param sprite The sprite to prefetch
+*/
+void prefetchSprite(Sprite *sprite);
+
+/** Remember that a texture can be loaded again from a file
+  * \param id The GL texture name
+  * \param file Path to the image file
+  * \param alpha The alpha value applied to the image
+*/
+void addSource(GLuint id, const ustring &file, int alpha);
+
+/** Check if a texture can be loaded again after it's evicted
+  * \param id The GL texture name
+  * \return <b>true</b> if its source is known, <b>false</b> otherwise
+*/
+bool hasSource(GLuint id);
+
+/** Defer a texture that was evicted, so it's loaded from its source when next needed
+  * \param id The GL texture name
+  * \param texId The ID the texture was registered under
+*/
+void restore(GLuint id, const ustring &texId);
+
+/// Upload textures that finished decoding in the background; call once per frame
+void update();
+
+/// Release all deferred images and the mapped files
+void clear();
+
+}; // namespace Assets
+
+#endif
@@ -19,10 +19,16 @@
  ***************************************************************************/
 // audio.cpp: implementation of Audio namespace
 
+#include <algorithm>
+#include <cstdio>
+#include <deque>
 #include "SDL_mixer.h"
+#include "SDL_thread.h"
 
 #include "audio.h"
+#include "clock.h"
 #include "utilities.h"
+#include "vfs.h"
 
 namespace Audio {
 	// global variable the stores whether or not sound is to be outputted
@@ -30,12 +36,273 @@ namespace Audio {
 	
 	// music currently playing
 	Sample g_Music;
+	
+	// music files held in memory, and how much memory they use
+	MusicCache g_MusicCache;
+	int g_MusicCacheSize=0;
+	int g_MusicCacheBudget=MUSIC_CACHE_BUDGET;
+	
+	// time the last music switch took
+	Uint32 g_LastSwitchTime=0;
+	
+	// memory used by decoded effects, and how often they were already decoded when played
+	int g_EffectsSize=0;
+	int g_EffectsBudget=EFFECT_CACHE_BUDGET;
+	int g_EffectHits=0;
+	int g_EffectMisses=0;
+	
+	// counter used to order effects by use
+	Uint32 g_EffectUses=0;
+	
+	// counter used to order cached music by use
+	Uint32 g_MusicUses=0;
+	
+	// path of the music file currently playing, and the stream it's read from
+	ustring g_MusicPath;
+	SDL_RWops *g_MusicRW=NULL;
+	
+	// music to start once the current music has faded out
+	ustring g_PendingMusic;
+	int g_PendingFade=0;
+	
+	// when music was last requested, and whether it has been mixed yet
+	ustring g_SwitchId;
+	Uint32 g_SwitchStart=0;
+	volatile bool g_SwitchPending=false;
+	volatile bool g_SwitchDone=false;
+	
+	// thread reading music files ahead of time, and the files it has yet to read
+	SDL_Thread *g_Loader=NULL;
+	SDL_mutex *g_CacheLock=NULL;
+	SDL_cond *g_CacheChanged=NULL;
+	std::deque<ustring> g_LoadQueue;
+	bool g_StopLoader=false;
 }
 
 // handler for music completion
 void onMusicFinished() {
 }
 
+// decode a sound effect
+static bool decodeEffect(Audio::Sample &sample) {
+	SDL_RWops *rw=VFS::open(sample.file);
+	sample.effect=(rw ? Mix_LoadWAV_RW(rw, 1) : NULL);
+	if (!sample.effect) {
+		Utils::debugMessage("Audio: unable to decode effect: '"+sample.file+"': "+Mix_GetError());
+		return false;
+	}
+	
+	sample.size=sample.effect->alen;
+	Audio::g_EffectsSize+=sample.size;
+	
+	return true;
+}
+
+// free a decoded sound effect, keeping its path
+static void freeEffect(Audio::Sample &sample) {
+	Mix_FreeChunk(sample.effect);
+	sample.effect=NULL;
+	
+	Audio::g_EffectsSize-=sample.size;
+	sample.size=0;
+}
+
+// see if a decoded effect is playing on any channel
+static bool isEffectPlaying(Mix_Chunk *chunk) {
+	for (int i=Audio::CHANNEL_DIALOGUE; i<=Audio::CHANNEL_GUI; i++) {
+		if (Mix_Playing(i) && Mix_GetChunk(i)==chunk)
+			return true;
+	}
+	
+	return false;
+}
+
+// free the least recently played effects until they fit their budget
+static void trimEffects() {
+	while(Audio::g_EffectsSize>Audio::g_EffectsBudget) {
+		Audio::AudioMap::iterator oldest=Audio::g_Audio.end();
+		for (Audio::AudioMap::iterator it=Audio::g_Audio.begin(); it!=Audio::g_Audio.end(); ++it) {
+			Audio::Sample &sample=(*it).second;
+			if (sample.type!=Audio::SAMPLE_EFFECT || !sample.effect || isEffectPlaying(sample.effect))
+				continue;
+			
+			if (oldest==Audio::g_Audio.end() || sample.lastUsed<(*oldest).second.lastUsed)
+				oldest=it;
+		}
+		
+		if (oldest==Audio::g_Audio.end())
+			break;
+		
+		freeEffect((*oldest).second);
+	}
+}
+
+// called by the mixer after each buffer was mixed
+static void onPostMix(void *udata, Uint8 *stream, int len) {
+	// the first buffer with the new music in it
+	if (Audio::g_SwitchPending) {
+		Audio::g_LastSwitchTime=SDL_GetTicks()-Audio::g_SwitchStart;
+		Audio::g_SwitchPending=false;
+		Audio::g_SwitchDone=true;
+	}
+}
+
+// read an entire music file into memory
+static char* readMusicFile(const ustring &path, int &size) {
+	FILE *f=fopen(path.c_str(), "rb");
+	if (!f)
+		return NULL;
+	
+	fseek(f, 0, SEEK_END);
+	size=ftell(f);
+	fseek(f, 0, SEEK_SET);
+	
+	char *data=new char[size];
+	if (fread(data, 1, size, f)!=size) {
+		delete [] data;
+		data=NULL;
+		size=0;
+	}
+	
+	fclose(f);
+	return data;
+}
+
+// entry point for the thread that reads music files ahead of time
+static int musicLoaderMain(void *data) {
+	SDL_mutexP(Audio::g_CacheLock);
+	while(!Audio::g_StopLoader) {
+		if (Audio::g_LoadQueue.empty()) {
+			SDL_CondWait(Audio::g_CacheChanged, Audio::g_CacheLock);
+			continue;
+		}
+		
+		ustring path=Audio::g_LoadQueue.front();
+		Audio::g_LoadQueue.pop_front();
+		
+		// don't hold the lock while reading
+		SDL_mutexV(Audio::g_CacheLock);
+		int size=0;
+		char *contents=readMusicFile(path, size);
+		SDL_mutexP(Audio::g_CacheLock);
+		
+		Audio::CachedMusic &music=Audio::g_MusicCache[path];
+		music.data=contents;
+		music.size=size;
+		music.loading=false;
+		Audio::g_MusicCacheSize+=size;
+		
+		SDL_CondBroadcast(Audio::g_CacheChanged);
+	}
+	SDL_mutexV(Audio::g_CacheLock);
+	
+	return 0;
+}
+
+// drop the least recently used music until the cache fits its budget
+// the cache lock must be held
+static void trimMusicCache() {
+	while(Audio::g_MusicCacheSize>Audio::g_MusicCacheBudget) {
+		Audio::MusicCache::iterator oldest=Audio::g_MusicCache.end();
+		for (Audio::MusicCache::iterator it=Audio::g_MusicCache.begin(); it!=Audio::g_MusicCache.end(); ++it) {
+			// never drop music that is still being read or is playing
+			if ((*it).second.loading || (*it).first==Audio::g_MusicPath)
+				continue;
+			
+			if (oldest==Audio::g_MusicCache.end() || (*it).second.lastUsed<(*oldest).second.lastUsed)
+				oldest=it;
+		}
+		
+		if (oldest==Audio::g_MusicCache.end())
+			break;
+		
+		Audio::g_MusicCacheSize-=(*oldest).second.size;
+		delete [] (*oldest).second.data;
+		Audio::g_MusicCache.erase(oldest);
+	}
+}
+
+// open a music file from the resource pack or the cache, reading it if needed
+static SDL_RWops* openMusic(const ustring &path) {
+	// music from the resource pack is played from memory
+	if (VFS::exists(path))
+		return VFS::open(path);
+	
+	SDL_mutexP(Audio::g_CacheLock);
+	
+	// if the file hasn't been picked up by the loader yet, read it here instead
+	std::deque<ustring>::iterator queued=std::find(Audio::g_LoadQueue.begin(), Audio::g_LoadQueue.end(), path);
+	if (queued!=Audio::g_LoadQueue.end()) {
+		Audio::g_LoadQueue.erase(queued);
+		Audio::g_MusicCache.erase(path);
+	}
+	
+	// otherwise, wait for the loader to finish reading it
+	while(Audio::g_MusicCache.find(path)!=Audio::g_MusicCache.end() && Audio::g_MusicCache[path].loading)
+		SDL_CondWait(Audio::g_CacheChanged, Audio::g_CacheLock);
+	
+	if (Audio::g_MusicCache.find(path)==Audio::g_MusicCache.end()) {
+		SDL_mutexV(Audio::g_CacheLock);
+		int size=0;
+		char *contents=readMusicFile(path, size);
+		SDL_mutexP(Audio::g_CacheLock);
+		
+		Audio::CachedMusic music={ contents, size, 0, false };
+		Audio::g_MusicCache[path]=music;
+		Audio::g_MusicCacheSize+=size;
+	}
+	
+	Audio::CachedMusic &music=Audio::g_MusicCache[path];
+	SDL_RWops *rw=NULL;
+	if (music.data) {
+		music.lastUsed=++Audio::g_MusicUses;
+		rw=SDL_RWFromConstMem(music.data, music.size);
+	}
+	
+	// the file couldn't be read
+	else
+		Audio::g_MusicCache.erase(path);
+	
+	SDL_mutexV(Audio::g_CacheLock);
+	return rw;
+}
+
+// load a music sample and start playing it
+static void startMusic(const Audio::Sample *audio, int fade) {
+	// free any previous music
+	Audio::freeMusic();
+	
+	// read the file from memory if possible
+	Audio::g_MusicRW=openMusic(audio->music);
+	if (Audio::g_MusicRW)
+		Audio::g_Music.mBuffer=Mix_LoadMUS_RW(Audio::g_MusicRW);
+	else
+		Audio::g_Music.mBuffer=Mix_LoadMUS(audio->music.c_str());
+	
+	if (!Audio::g_Music.mBuffer) {
+		Utils::debugMessage("Audio: unable to load music: '"+audio->music+"'");
+		Audio::freeMusic();
+		return;
+	}
+	
+	Audio::g_MusicPath=audio->music;
+	if (fade>0)
+		Mix_FadeInMusic(Audio::g_Music.mBuffer, -1, fade);
+	else
+		Mix_PlayMusic(Audio::g_Music.mBuffer, -1);
+	
+	// measure the time until it's first mixed
+	Audio::g_SwitchPending=true;
+}
+
+// set up music playback
+void Audio::initMusic() {
+	g_CacheLock=SDL_CreateMutex();
+	g_CacheChanged=SDL_CreateCond();
+	
+	Mix_SetPostMix(onPostMix, NULL);
+}
+
 // load an audio sample from file
 bool Audio::loadSample(const ustring &path, Audio::Sample &sample) {
 	if (!Audio::g_Output)
@@ -56,11 +323,19 @@ bool Audio::loadSample(const ustring &path, Audio::Sample &sample) {
 	// find the basename
 	ustring base=path.substr(path.rfind(sep)+1);
 	
-	// any file prefixed with an s_ is an effect
+	// any file prefixed with an s_ is an effect, which is decoded when first played
 	if (base[0]=='s' && base[1]=='_') {
 		sample.type=SAMPLE_EFFECT;
-		sample.effect=Mix_LoadWAV(path.c_str());
-		if (!sample.effect)
+		sample.effect=NULL;
+		sample.file=path;
+		sample.size=0;
+		sample.lastUsed=0;
+		
+		// make sure it can be opened later on
+		SDL_RWops *rw=VFS::open(path);
+		if (rw)
+			SDL_RWclose(rw);
+		else
 			success=false;
 	}
 	
@@ -94,13 +369,47 @@ void Audio::playEffect(const ustring &id, EffectChannel channel) {
 	
 	// play this chunk once
 	if (audio->type==SAMPLE_EFFECT) {
+		// decode it the first time it's played
+		if (audio->effect)
+			g_EffectHits++;
+		else {
+			g_EffectMisses++;
+			if (!decodeEffect(*audio))
+				return;
+		}
+		audio->lastUsed=++g_EffectUses;
+		
 		Mix_HaltChannel(channel);
 		Mix_PlayChannel(channel, audio->effect, 0);
+		
+		// make room for it, if needed
+		trimEffects();
 	}
 }
 
+// decode an effect sample ahead of time
+void Audio::warmEffect(const ustring &id) {
+	if (!Audio::g_Output)
+		return;
+	
+	Audio::Sample *audio=queryAudio(id);
+	if (!audio || audio->type!=SAMPLE_EFFECT)
+		return;
+	
+	if (audio->effect || decodeEffect(*audio)) {
+		audio->lastUsed=++g_EffectUses;
+		trimEffects();
+	}
+}
+
+// set the sound effect budget
+void Audio::setEffectsBudget(int bytes) {
+	g_EffectsBudget=bytes;
+	trimEffects();
+}
+
 // play a music sample
-void Audio::playMusic(const ustring &id) {
+void Audio::playMusic(const ustring &id, int fade) {
 	if (!Audio::g_Output)
 		return;
 	
@@ -113,19 +422,83 @@ void Audio::playMusic(const ustring &id) {
 	
 	// and play it, if it's a music file
 	if (audio->type==SAMPLE_MUSIC) {
-		if (Audio::g_Music.mBuffer!=NULL) {
-			Mix_HaltMusic();
-			Mix_FreeMusic(Audio::g_Music.mBuffer);
-		}
+		g_SwitchId=id;
+		g_SwitchStart=SDL_GetTicks();
+		g_SwitchPending=false;
 		
-		// load our new music sample
-		Audio::g_Music.mBuffer=Mix_LoadMUS(audio->music.c_str());
-		if (!Audio::g_Music.mBuffer) {
-			Utils::debugMessage("Audio: unable to load music: '"+audio->music+"'");
+		// fade out the current music first, and start this once it's done
+		if (fade>0 && Mix_PlayingMusic()) {
+			g_PendingMusic=id;
+			g_PendingFade=fade;
+			if (Mix_FadingMusic()!=MIX_FADING_OUT)
+				Mix_FadeOutMusic(fade);
+			
+			preloadMusic(id);
 			return;
 		}
 		
-		Mix_PlayMusic(Audio::g_Music.mBuffer, -1);
+		g_PendingMusic="";
+		startMusic(audio, 0);
+	}
+}
+
+// read a music sample's file in the background
+void Audio::preloadMusic(const ustring &id) {
+	if (!Audio::g_Output || !g_CacheLock)
+		return;
+	
+	// music from the resource pack is in memory already
+	Audio::Sample *audio=queryAudio(id);
+	if (!audio || audio->type!=SAMPLE_MUSIC || VFS::exists(audio->music))
+		return;
+	
+	SDL_mutexP(g_CacheLock);
+	MusicCache::iterator it=g_MusicCache.find(audio->music);
+	
+	// keep it around for a while longer if it's already cached
+	if (it!=g_MusicCache.end())
+		(*it).second.lastUsed=++g_MusicUses;
+	
+	else {
+		CachedMusic music={ NULL, 0, ++g_MusicUses, true };
+		g_MusicCache[audio->music]=music;
+		g_LoadQueue.push_back(audio->music);
+		SDL_CondBroadcast(g_CacheChanged);
+	}
+	SDL_mutexV(g_CacheLock);
+	
+	// start the loader the first time it's needed
+	if (!g_Loader)
+		g_Loader=SDL_CreateThread(musicLoaderMain, NULL);
+}
+
+// start pending music and report switch times
+void Audio::update() {
+	if (!Audio::g_Output)
+		return;
+	
+	// check back soon while the previous music is fading out
+	if (g_PendingMusic!="")
+		Clock::busy();
+	
+	// the previous music has faded out
+	if (g_PendingMusic!="" && !Mix_PlayingMusic()) {
+		Audio::Sample *audio=queryAudio(g_PendingMusic);
+		g_PendingMusic="";
+		if (audio)
+			startMusic(audio, g_PendingFade);
+	}
+	
+	if (g_SwitchDone) {
+		g_SwitchDone=false;
+		Utils::debugMessage("Audio: music '"+g_SwitchId+"' started "+Utils::itoa(g_LastSwitchTime)+"ms after it was requested");
+	}
+	
+	// drop music that was read ahead but is no longer needed
+	if (g_CacheLock) {
+		SDL_mutexP(g_CacheLock);
+		trimMusicCache();
+		SDL_mutexV(g_CacheLock);
 	}
 }
 
@@ -134,7 +507,8 @@ bool Audio::isMusicPlaying() {
 	if (!Audio::g_Output)
 		return false;
 	
-	return Mix_PlayingMusic();
+	// music that is waiting for a fade out counts as well
+	return Mix_PlayingMusic() || g_PendingMusic!="";
 }
 
 // halt music playback
@@ -142,6 +516,9 @@ void Audio::haltMusic() {
 	if (!Audio::g_Output)
 		return;
 	
+	// don't start music that was waiting for a fade out
+	g_PendingMusic="";
+	
 	// first, halt playback
 	Mix_HaltMusic();
 	
@@ -165,9 +542,9 @@ void Audio::popAudio(const ustring &id) {
 	if (queryAudio(id)) {
 		Audio::Sample *audio=queryAudio(id);
 		
-		// free the music chunk
-		if (audio->type==SAMPLE_EFFECT)
-			Mix_FreeChunk(audio->effect);
+		// free the effect chunk
+		if (audio->type==SAMPLE_EFFECT && audio->effect)
+			freeEffect(*audio);
 		
 		// remove it from the map
 		g_Audio.erase(audio->id);
@@ -195,12 +572,13 @@ void Audio::clearAudioStack() {
 		// free the effect
 		if ((*it).second.type==SAMPLE_EFFECT) {
 			if ((*it).second.effect)
-				Mix_FreeChunk((*it).second.effect);
+				freeEffect((*it).second);
 		}
 	}
 	
 	// free any music buffers
 	freeMusic();
+	clearMusicCache();
 	
 	g_Audio.clear();
 }
@@ -215,4 +593,43 @@ void Audio::freeMusic() {
 		Mix_FreeMusic(Audio::g_Music.mBuffer);
 		Audio::g_Music.mBuffer=NULL;
 	}
+	
+	// the stream isn't closed by the mixer
+	if (g_MusicRW) {
+		SDL_RWclose(g_MusicRW);
+		g_MusicRW=NULL;
+	}
+	g_MusicPath="";
+}
+
+// set the music cache budget
+void Audio::setMusicCacheBudget(int bytes) {
+	g_MusicCacheBudget=bytes;
+	
+	if (g_CacheLock) {
+		SDL_mutexP(g_CacheLock);
+		trimMusicCache();
+		SDL_mutexV(g_CacheLock);
+	}
+}
+
+// free all cached music
+void Audio::clearMusicCache() {
+	// stop the loader first, since it might be reading a file
+	if (g_Loader) {
+		SDL_mutexP(g_CacheLock);
+		g_StopLoader=true;
+		g_LoadQueue.clear();
+		SDL_CondBroadcast(g_CacheChanged);
+		SDL_mutexV(g_CacheLock);
+		
+		SDL_WaitThread(g_Loader, NULL);
+		g_Loader=NULL;
+		g_StopLoader=false;
+	}
+	
+	for (MusicCache::iterator it=g_MusicCache.begin(); it!=g_MusicCache.end(); ++it)
+		delete [] (*it).second.data;
+	g_MusicCache.clear();
+	g_MusicCacheSize=0;
 }
@@ -37,12 +37,25 @@ enum EffectChannel { CHANNEL_DIALOGUE=0, CHANNEL_SCRIPT, CHANNEL_GUI };
 /// Types of audio samples
 enum SampleType { SAMPLE_EFFECT, SAMPLE_MUSIC };
 
+/// Default amount of memory used to keep music files cached, in bytes
+const int MUSIC_CACHE_BUDGET=32*1024*1024;
+
+/// Time to fade between two pieces of music, in milliseconds
+const int MUSIC_FADE_TIME=500;
+
+/// Default amount of memory used by decoded sound effects, in bytes
+const int EFFECT_CACHE_BUDGET=8*1024*1024;
+
 /// Audio struct representing music or sound effect
 struct _Sample {
 	ustring id; ///< ID referenced from within the script
 	SampleType type; ///< The type of sample
 	
-	Mix_Chunk *effect; ///< The effect to play
+	Mix_Chunk *effect; ///< The effect to play, or NULL if it hasn't been decoded yet
+	ustring file; ///< Path to the effect, decoded when first played
+	int size; ///< Size of the decoded effect in bytes
+	Uint32 lastUsed; ///< Order in which the effect was last played
+	
 	ustring music; ///< The music sample to play
 	
 	Mix_Music *mBuffer; ///< Music buffer
@@ -70,7 +83,47 @@ static ChannelMap Channels;
 /// The music currently playing
 extern Sample g_Music;
 
+/// Music file held in memory, so it can be played without reading from disk
+struct _CachedMusic {
+	char *data;		///< The contents of the file, or NULL while it's being read
+	int size;		///< Size of the contents in bytes
+	Uint32 lastUsed;	///< Order in which the music was last requested
+	bool loading;		///< Whether the file is still being read in the background
+};
+typedef struct _CachedMusic CachedMusic;
+
+/// Typedef'd map of music file paths to their contents
+typedef std::map<ustring, CachedMusic> MusicCache;
+
+/// Music files read ahead of time, or kept since they were last played
+extern MusicCache g_MusicCache;
+
+/// Amount of memory used by cached music, in bytes
+extern int g_MusicCacheSize;
+
+/// Amount of memory cached music may use before older files are dropped, in bytes
+extern int g_MusicCacheBudget;
+
+/// Time it took from requesting the last piece of music until it was first mixed, in milliseconds
+extern Uint32 g_LastSwitchTime;
+
+/// Amount of memory used by decoded sound effects, in bytes
+extern int g_EffectsSize;
+
+/// Amount of memory decoded sound effects may use before older ones are freed, in bytes
+extern int g_EffectsBudget;
+
+/// Amount of times a sound effect was played that was already decoded
+extern int g_EffectHits;
+
+/// Amount of times a sound effect had to be decoded before it was played
+extern int g_EffectMisses;
+
+/// Set up music playback after the audio device was opened
+void initMusic();
+
 /** Load an audio sample from file
+  * Neither effects nor music are decoded right away; only their paths are kept.
   * \param path The path to the audio sample
   * \param sample The audio sample object to load the data into
   * \return <b>true</b> if there were no errors, <b>false</b> otherwise
@@ -83,10 +136,31 @@ bool loadSample(const ustring &path, Sample &sample);
 */
 void playEffect(const ustring &id, EffectChannel channel);
 
+/** Decode a sound effect ahead of time, so it plays without delay
+  * \param id The ID of the sample
+*/
+void warmEffect(const ustring &id);
+
+/** Set how much memory decoded sound effects may use
+  * \param bytes The budget, in bytes
+*/
+void setEffectsBudget(int bytes);
+
 /** Play a music sample
+  * If music is already playing and a fade time is given, the current music fades out 
+  * first and the new music fades in once it's done.
   * \param id The ID of the sample
+  * \param fade Time to fade between the two, in milliseconds
 */
-void playMusic(const ustring &id);
+void playMusic(const ustring &id, int fade=0);
+
+/** Start reading a music sample's file in the background, so it plays without delay
+  * \param id The ID of the sample
+*/
+void preloadMusic(const ustring &id);
+
+/// Start music that was waiting for the previous music to fade out, and report switch times
+void update();
 
 /** See if music is playing
   * \return <b>true</b> if music is playing, <b>false</b> otherwise
@@ -119,6 +193,14 @@ void clearAudioStack();
 /// Free the current music buffer
 void freeMusic();
 
+/** Set how much memory cached music may use
+  * \param bytes The budget, in bytes
+*/
+void setMusicCacheBudget(int bytes);
+
+/// Stop reading music in the background, and free all cached music
+void clearMusicCache();
+
 }; // namespace Audio
 
 #endif
@@ -20,6 +20,8 @@
 // case.cpp: implementations of Case structs and classes
 
 #include "case.h"
+#include "triggers.h"
+#include "utilities.h"
 
 // constructor
 Case::Case::Case() {
@@ -27,7 +29,7 @@ Case::Case::Case() {
 	clear();
 	
 	// add some default blocks
-	addBuffer("INTERNAL_testimony", STR_NULL);
+	addBuffer("INTERNAL_testimony", Utils::toUTF32(STR_NULL));
 	
 	// add our default blocks
 	for (int i=0; i<Case::Case::CORE_BLOCK_COUNT; i++)
@@ -74,54 +76,230 @@ void Case::Case::addTestimony(const Testimony &testimony) {
 }
 
 // add a text buffer
-void Case::Case::addBuffer(const ustring &id, const ustring &contents) {
-	m_Buffers[id]=contents;
+void Case::Case::addBuffer(const ustring &id, const UTF32String &contents) {
+	// replace an existing block in place, so its handle stays valid
+	BlockHandle handle=getBlockHandle(id);
+	if (handle!=NULL_BLOCK) {
+		m_Blocks[handle]=Script::compile(contents);
+		return;
+	}
+	
+	m_BlockIndex[id]=m_Blocks.size();
+	m_BlockIds.push_back(id);
+	m_Blocks.push_back(Script::compile(contents));
+}
+
+// resolve block references to handles
+void Case::Case::linkBlocks() {
+	// hotspots in each location
+	for (LocationMap::iterator it=m_Locations.begin(); it!=m_Locations.end(); ++it) {
+		std::vector<Hotspot> &hotspots=(*it).second.hotspots;
+		for (int i=0; i<hotspots.size(); i++) {
+			hotspots[i].blockHandle=getBlockHandle(hotspots[i].block);
+			if (hotspots[i].blockHandle==NULL_BLOCK)
+				Utils::debugMessage("Hotspot in location '"+(*it).first+"' refers to unknown block: "+hotspots[i].block);
+		}
+	}
+	
+	// testimonies, and the pieces that make them up
+	for (TestimonyMap::iterator it=m_Testimonies.begin(); it!=m_Testimonies.end(); ++it) {
+		Testimony &testimony=(*it).second;
+		testimony.xExamineEndHandle=getBlockHandle(testimony.xExamineEndBlock);
+		
+		for (int i=0; i<testimony.pieces.size(); i++)
+			linkProgram(testimony.pieces[i].text);
+	}
+	
+	// and finally, all regular blocks
+	for (int i=0; i<m_Blocks.size(); i++)
+		linkProgram(m_Blocks[i]);
+	
+	// now that jumps are resolved, find what each block refers to
+	m_Dependencies.clear();
+	m_Dependencies.resize(m_Blocks.size());
+	for (int i=0; i<m_Blocks.size(); i++)
+		collectDependencies(m_Blocks[i], m_Dependencies[i]);
+}
+
+// get the handle of a text block
+Case::BlockHandle Case::Case::getBlockHandle(const ustring &id) const {
+	BlockIndex::const_iterator it=m_BlockIndex.find(id);
+	if (it==m_BlockIndex.end())
+		return NULL_BLOCK;
+	
+	return (*it).second;
+}
+
+// get a compiled text block by its handle
+const Script::Program& Case::Case::getBlock(BlockHandle handle) const {
+	static const Script::Program empty;
+	if (handle<0 || handle>=m_Blocks.size())
+		return empty;
+	
+	return m_Blocks[handle];
+}
+
+// get the dependencies of a text block
+const Case::Dependencies& Case::Case::getDependencies(BlockHandle handle) const {
+	static const Dependencies empty;
+	if (handle<0 || handle>=m_Dependencies.size())
+		return empty;
+	
+	return m_Dependencies[handle];
+}
+
+// find the objects a compiled block refers to
+void Case::Case::collectDependencies(const Script::Program &program, Dependencies &deps) const {
+	for (int i=0; i<program.code.size(); i++) {
+		const Script::Instruction &ins=program.code[i];
+		if (ins.op!=Script::OP_TRIGGER)
+			continue;
+		
+		// triggers with too few arguments were already reported when compiling
+		Triggers::ID id=(Triggers::ID) ins.value;
+		StringVector params=Utils::explodeString(',', ins.args);
+		if (id==Triggers::TRIGGER_UNKNOWN || params.size()<Triggers::info(id).arity)
+			continue;
+		
+		switch(id) {
+			// jumps were already resolved when linking
+			case Triggers::TRIGGER_GOTO:
+			case Triggers::TRIGGER_DIRECT_GOTO:
+			case Triggers::TRIGGER_TIMED_GOTO: {
+				if (ins.target!=NULL_BLOCK)
+					deps.blocks.push_back(ins.target);
+			}; break;
+			
+			// blocks that the player can choose
+			case Triggers::TRIGGER_ADD_TALK_OPTION:
+			case Triggers::TRIGGER_ADD_PRESENTABLE: {
+				BlockHandle handle=getBlockHandle(params[2]);
+				if (handle!=NULL_BLOCK)
+					deps.blocks.push_back(handle);
+			}; break;
+			
+			case Triggers::TRIGGER_SET_BAD_PRESENTABLE_BLOCK: {
+				BlockHandle handle=getBlockHandle(params[1]);
+				if (handle!=NULL_BLOCK)
+					deps.blocks.push_back(handle);
+			}; break;
+			
+			case Triggers::TRIGGER_SET_LOCATION_TRIGGER: {
+				deps.locations.push_back(params[0]);
+				
+				BlockHandle handle=getBlockHandle(params[1]);
+				if (handle!=NULL_BLOCK)
+					deps.blocks.push_back(handle);
+			}; break;
+			
+			// locations
+			case Triggers::TRIGGER_SET_LOCATION: deps.locations.push_back(params[0]); break;
+			case Triggers::TRIGGER_ADD_LOCATION: deps.locations.push_back(params[1]); break;
+			
+			case Triggers::TRIGGER_PUT_CHARACTER: {
+				deps.characters.push_back(params[0]);
+				deps.locations.push_back(params[1]);
+			}; break;
+			
+			// characters
+			case Triggers::TRIGGER_SPEAKER:
+			case Triggers::TRIGGER_SET_ANIMATION: deps.characters.push_back(params[0]); break;
+			
+			// evidence
+			case Triggers::TRIGGER_SHOW_EVIDENCE:
+			case Triggers::TRIGGER_ADD_EVIDENCE_ANIMATED: deps.evidence.push_back(params[0]); break;
+			
+			// images
+			case Triggers::TRIGGER_SET_TEMP_IMAGE:
+			case Triggers::TRIGGER_FLASHBACK_IMAGE: deps.images.push_back(params[0]); break;
+			case Triggers::TRIGGER_SET_COURT_OVERVIEW_IMAGE: deps.images.push_back(params[1]); break;
+			
+			// music
+			case Triggers::TRIGGER_PLAY_MUSIC:
+			case Triggers::TRIGGER_SET_LOCATION_MUSIC: deps.music.push_back(params[0]); break;
+			
+			// testimonies are given by a witness
+			case Triggers::TRIGGER_DISPLAY_TESTIMONY:
+			case Triggers::TRIGGER_CROSS_EXAMINE: {
+				TestimonyMap::const_iterator it=m_Testimonies.find(params[0]);
+				if (it!=m_Testimonies.end())
+					deps.characters.push_back((*it).second.speaker);
+			}; break;
+			
+			default: break;
+		}
+	}
+}
+
+// resolve the targets of goto triggers in a block
+void Case::Case::linkProgram(Script::Program &program) {
+	for (int i=0; i<program.code.size(); i++) {
+		Script::Instruction &ins=program.code[i];
+		if (ins.op!=Script::OP_TRIGGER)
+			continue;
+		
+		// only jumps refer to other blocks
+		Triggers::ID id=(Triggers::ID) ins.value;
+		if (id!=Triggers::TRIGGER_GOTO && id!=Triggers::TRIGGER_DIRECT_GOTO && id!=Triggers::TRIGGER_TIMED_GOTO)
+			continue;
+		
+		ustring target=Utils::explodeString(',', ins.args)[0];
+		ins.target=getBlockHandle(target);
+		if (ins.target==NULL_BLOCK)
+			Utils::debugMessage("Trigger "+ins.name+" refers to unknown block: "+target);
+	}
 }
 
 // get a character
 Character* Case::Case::getCharacter(const ustring &id) {
-	if (m_Characters.find(id)!=m_Characters.end())
-		return &m_Characters[id];
+	CharacterMap::iterator it=m_Characters.find(id);
+	if (it!=m_Characters.end())
+		return &(*it).second;
 	else
 		return NULL;
 }
 
 // get a background
 Case::Background* Case::Case::getBackground(const ustring &id) {
-	if (m_Backgrounds.find(id)!=m_Backgrounds.end())
-		return &m_Backgrounds[id];
+	BackgroundMap::iterator it=m_Backgrounds.find(id);
+	if (it!=m_Backgrounds.end())
+		return &(*it).second;
 	else
 		return NULL;
 }
 
 // get a piece of evidence
 Case::Evidence* Case::Case::getEvidence(const ustring &id) {
-	if (m_Evidence.find(id)!=m_Evidence.end())
-		return &m_Evidence[id];
+	EvidenceMap::iterator it=m_Evidence.find(id);
+	if (it!=m_Evidence.end())
+		return &(*it).second;
 	else
 		return NULL;
 }
 
 // get an image
 Case::Image* Case::Case::getImage(const ustring &id) {
-	if (m_Images.find(id)!=m_Images.end())
-		return &m_Images[id];
+	ImageMap::iterator it=m_Images.find(id);
+	if (it!=m_Images.end())
+		return &(*it).second;
 	else
 		return NULL;
 }
 
 // get a location
 Case::Location* Case::Case::getLocation(const ustring &id) {
-	if (m_Locations.find(id)!=m_Locations.end())
-		return &m_Locations[id];
+	LocationMap::iterator it=m_Locations.find(id);
+	if (it!=m_Locations.end())
+		return &(*it).second;
 	else
 		return NULL;
 }
 
 // get a testimony
 Case::Testimony* Case::Case::getTestimony(const ustring &id) {
-	if (m_Testimonies.find(id)!=m_Testimonies.end())
-		return &m_Testimonies[id];
+	TestimonyMap::iterator it=m_Testimonies.find(id);
+	if (it!=m_Testimonies.end())
+		return &(*it).second;
 	else
 		return NULL;
 }
@@ -162,7 +340,9 @@ void Case::Case::clear() {
 	m_Backgrounds.clear();
 	m_Characters.clear();
 	m_Locations.clear();
-	m_Buffers.clear();
+	m_Blocks.clear();
+	m_BlockIds.clear();
+	m_BlockIndex.clear();
 }
 
 // set the case overview
@@ -24,12 +24,14 @@
 
 #include <GL/gl.h>
 #include <map>
+#include <tr1/unordered_map>
 #include <vector>
 #include "SDL.h"
 #include "SDL_mixer.h"
 
 #include "character.h"
 #include "common.h"
+#include "script.h"
 
 /// Namespace for all Case related objects and definitions
 namespace Case {
@@ -40,6 +42,15 @@ enum LawSystem { TWO_DAY=0, THREE_DAY };
 /// The type of background
 enum BackgroundType { BG_SINGLE_SCREEN=0, BG_DOUBLE_SCREEN };
 
+/// Dense integer handle of a compiled text block
+typedef int BlockHandle;
+
+/// Handle used for blocks that don't exist
+const BlockHandle NULL_BLOCK=-1;
+
+/// Hashed index of block IDs to handles
+typedef std::tr1::unordered_map<std::string, BlockHandle> BlockIndex;
+
 /// General case data and technical info
 struct _Overview {
 	/// The name of the case (Turnabout Whatever, etc)
@@ -108,6 +119,9 @@ struct _Hotspot {
 	
 	/// ID of block to set when this hotspot is examined
 	ustring block;
+	
+	/// Handle of the block, resolved when the case is linked
+	BlockHandle blockHandle;
 };
 typedef struct _Hotspot Hotspot;
 
@@ -161,8 +175,8 @@ typedef struct _Image Image;
 
 /// A single piece of testimony
 struct _TestimonyPiece {
-	/// The dialogue spoken in this piece of testimony
-	ustring text;
+	/// The compiled dialogue spoken in this piece of testimony
+	Script::Program text;
 	
 	/// ID of evidence that can be presented at this point
 	ustring presentId;
@@ -198,11 +212,36 @@ struct _Testimony {
 	/// Block to execute if the cross examination is completed
 	Glib::ustring xExamineEndBlock;
 	
+	/// Handle of the block to execute if the cross examination is completed
+	BlockHandle xExamineEndHandle;
+	
 	/// Vector of pieces making up this testimony
 	std::vector<TestimonyPiece> pieces;
 };
 typedef struct _Testimony Testimony;
 
+/// Objects that a text block refers to, used to load assets before they are needed
+struct _Dependencies {
+	/// Blocks that can follow, through jumps, talk options, presentables and location triggers
+	std::vector<BlockHandle> blocks;
+	
+	/// Locations that are shown or changed
+	std::vector<ustring> locations;
+	
+	/// Characters that speak, are animated or are placed somewhere
+	std::vector<ustring> characters;
+	
+	/// Evidence that is shown or added to the Court Record
+	std::vector<ustring> evidence;
+	
+	/// Images that are displayed
+	std::vector<ustring> images;
+	
+	/// Music that is played
+	std::vector<ustring> music;
+};
+typedef struct _Dependencies Dependencies;
+
 }; // namespace Case
 
 // typedefs for cleaner code
@@ -212,7 +251,6 @@ typedef std::map<ustring, Case::Evidence> EvidenceMap;
 typedef std::map<ustring, Case::Image> ImageMap;
 typedef std::map<ustring, Case::Location> LocationMap;
 typedef std::map<ustring, Case::Testimony> TestimonyMap;
-typedef std::map<ustring, ustring> BufferMap;
 
 typedef std::vector<ustring> StringVector;
 
@@ -311,10 +349,50 @@ class Case {
 		void addTestimony(const Testimony &testimony);
 		
 		/** Add a text buffer to the internal map
+		  * The contents are compiled before being stored.
 		  * \param id The ID of the block
 		  * \param contents The block contents
 		*/
-		void addBuffer(const ustring &id, const ustring &contents);
+		void addBuffer(const ustring &id, const UTF32String &contents);
+		
+		/** Resolve block references to handles once all blocks were added
+		  * This covers hotspots, testimonies and goto triggers. References to 
+		  * blocks that don't exist are reported. The dependencies of each block 
+		  * are collected as well.
+		*/
+		void linkBlocks();
+		
+		/** Get the handle of a text block
+		  * \param id The ID of the block
+		  * \return The handle of the block, or NULL_BLOCK if it doesn't exist
+		*/
+		BlockHandle getBlockHandle(const ustring &id) const;
+		
+		/** Get a compiled text block by its handle
+		  * \param handle The handle of the block
+		  * \return The requested block, or an empty block if the handle is invalid
+		*/
+		const Script::Program& getBlock(BlockHandle handle) const;
+		
+		/** Get a compiled text block
+		  * \param id The ID of the block
+		  * \return The requested block, or an empty block if it doesn't exist
+		*/
+		const Script::Program& getBlock(const ustring &id) const { return getBlock(getBlockHandle(id)); }
+		
+		/** Get the objects a text block refers to
+		  * \param handle The handle of the block
+		  * \return The dependencies of the block, or empty ones if the handle is invalid
+		*/
+		const Dependencies& getDependencies(BlockHandle handle) const;
+		
+		/** Find the objects a compiled block refers to.
+		  * This is done for every block when the case is linked, but can be used 
+		  * for other programs as well, such as testimony pieces.
+		  * \param program The compiled block
+		  * \param deps Dependencies struct to fill in
+		*/
+		void collectDependencies(const Script::Program &program, Dependencies &deps) const;
 		
 		/** Get a character
 		  * \param id The ID of the character
@@ -370,39 +448,50 @@ class Case {
 		/** Get a full map of characters
 		  * \return Map of all characters
 		*/
-		CharacterMap getCharacters() const { return m_Characters; }
+		const CharacterMap& getCharacters() const { return m_Characters; }
 		
 		/** Get a full map of backgrounds
 		  * \return Map of all backgrounds
 		*/
-		BackgroundMap getBackgrounds() const { return m_Backgrounds; }
+		const BackgroundMap& getBackgrounds() const { return m_Backgrounds; }
 		
 		/** Get a full map of evidence
 		  * \return Map of all evidence
 		*/
-		EvidenceMap getEvidence() const { return m_Evidence; }
+		const EvidenceMap& getEvidence() const { return m_Evidence; }
 		
 		/** Get a full map of images
 		  * \return Map of all images
 		*/
-		ImageMap getImages() const { return m_Images; }
+		const ImageMap& getImages() const { return m_Images; }
 		
 		/** Get a full map of locations
 		  * \return Map of all locations
 		*/
-		LocationMap getLocations() const { return m_Locations; }
+		const LocationMap& getLocations() const { return m_Locations; }
 		
 		/** Get a full map of testimonies
 		  * \return Map of all testimonies
 		*/
-		TestimonyMap getTestimonies() const { return m_Testimonies; }
+		const TestimonyMap& getTestimonies() const { return m_Testimonies; }
+		
+		/** Get the amount of text blocks
+		  * \return Amount of blocks; valid handles range from 0 up to this value
+		*/
+		int getBlockCount() const { return m_Blocks.size(); }
 		
-		/** Get a map of buffers
-		  * \return Map of all text buffers
+		/** Get the ID of a text block
+		  * \param handle The handle of the block
+		  * \return The ID of the block
 		*/
-		BufferMap getBuffers() const { return m_Buffers; }
+		const ustring& getBlockId(BlockHandle handle) const { return m_BlockIds[handle]; }
 	
 	private:
+		/** Resolve the targets of goto triggers in a block
+		  * \param program The compiled block
+		*/
+		void linkProgram(Script::Program &program);
+		
 		/// Case overrides
 		Overrides m_Overrides;
 		
@@ -430,8 +519,17 @@ class Case {
 		/// Map of testimonies
 		TestimonyMap m_Testimonies;
 		
-		/// Map of buffers
-		BufferMap m_Buffers;
+		/// Compiled text blocks, indexed by handle
+		std::vector<Script::Program> m_Blocks;
+		
+		/// IDs of text blocks, indexed by handle
+		StringVector m_BlockIds;
+		
+		/// Index of block IDs to handles
+		BlockIndex m_BlockIndex;
+		
+		/// Dependencies of each text block, indexed by handle
+		std::vector<Dependencies> m_Dependencies;
 		
 		/// Vector of core blocks
 		StringVector m_CoreBlocks;
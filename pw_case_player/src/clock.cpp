@@ -0,0 +1,88 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// clock.cpp: implementation of Clock namespace
+
+#include "clock.h"
+
+namespace Clock {
+	bool g_Virtual=false;
+	Uint32 g_Now=0;
+	
+	// frame clock
+	Uint32 g_FrameStart=0;
+	Uint32 g_FrameDelta=0;
+	Uint32 g_NextChange=NEVER;
+}
+
+// switch to the virtual clock
+void Clock::useVirtual(Uint32 start) {
+	g_Virtual=true;
+	g_Now=start;
+}
+
+// get the current time
+Uint32 Clock::ticks() {
+	return (g_Virtual ? g_Now : SDL_GetTicks());
+}
+
+// advance the virtual clock
+void Clock::advance(Uint32 ms) {
+	if (g_Virtual)
+		g_Now+=ms;
+}
+
+// start a new frame
+void Clock::beginFrame() {
+	Uint32 now=ticks();
+	
+	// the first frame doesn't advance anything, and neither should long stalls
+	g_FrameDelta=(g_FrameStart==0 ? 0 : now-g_FrameStart);
+	if (g_FrameDelta>MAX_FRAME_DELTA)
+		g_FrameDelta=MAX_FRAME_DELTA;
+	
+	g_FrameStart=now;
+	g_NextChange=NEVER;
+}
+
+// note a time at which something changes
+void Clock::schedule(Uint32 time) {
+	if (time<g_NextChange)
+		g_NextChange=time;
+}
+
+// note that something changes every frame
+void Clock::busy() {
+	schedule(g_FrameStart);
+}
+
+// get the earliest scheduled change
+Uint32 Clock::nextChange() {
+	return g_NextChange;
+}
+
+// get the time at which the current frame started
+Uint32 Clock::frame() {
+	return g_FrameStart;
+}
+
+// get the time since the previous frame
+Uint32 Clock::delta() {
+	return g_FrameDelta;
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// clock.h: game logic time source
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "SDL.h"
+
+/** Namespace for the time source used by game logic.
+  * Animations, text speed and other timed effects read the time from here 
+  * rather than from SDL directly. Normally this is just SDL_GetTicks(), but the 
+  * clock can be switched to a virtual one that only moves when it is advanced, 
+  * which makes a run reproducible and independent of wall time.
+  *
+  * The time is also latched once at the start of every frame, so everything drawn 
+  * in a frame sees the same time, along with how much time passed since the last one.
+*/
+namespace Clock {
+
+/// Length of a frame that frame counts in scripts and animations were designed for, in milliseconds
+const int FRAME_TIME=16;
+
+/// Longest time a single frame may advance animations by, in milliseconds
+const int MAX_FRAME_DELTA=250;
+
+/// Time used when no change is scheduled
+const Uint32 NEVER=0xFFFFFFFF;
+
+/// Flag whether or not the virtual clock is in use
+extern bool g_Virtual;
+
+/// Current time of the virtual clock, in milliseconds
+extern Uint32 g_Now;
+
+/// Time at which the current frame started
+extern Uint32 g_FrameStart;
+
+/// Time that passed between the start of the previous frame and this one
+extern Uint32 g_FrameDelta;
+
+/// Earliest time something drawn in the current frame will change
+extern Uint32 g_NextChange;
+
+/** Switch to the virtual clock
+  * \param start The time to start the virtual clock at
+*/
+void useVirtual(Uint32 start=0);
+
+/** Get the current time
+  * \return Milliseconds since the clock started
+*/
+Uint32 ticks();
+
+/** Advance the virtual clock; does nothing for the real clock
+  * \param ms Amount of milliseconds to advance by
+*/
+void advance(Uint32 ms);
+
+/// Start a new frame, latching the current time and clearing scheduled changes
+void beginFrame();
+
+/** Note a time at which something on screen will change
+  * Anything that is animated should call this while it's drawn, so that the 
+  * main loop knows how long it may wait when nothing else is going on.
+  * \param time The time of the change
+*/
+void schedule(Uint32 time);
+
+/// Note that something on screen changes every frame
+void busy();
+
+/** Get the earliest change scheduled while drawing the current frame
+  * \return The time of the change, or NEVER if nothing was scheduled
+*/
+Uint32 nextChange();
+
+/** Get the time at which the current frame started
+  * \return Milliseconds since the clock started
+*/
+Uint32 frame();
+
+/** Get the time that passed since the previous frame, limited to MAX_FRAME_DELTA
+  * \return Elapsed time in milliseconds
+*/
+Uint32 delta();
+
+}; // namespace Clock
+
+#endif
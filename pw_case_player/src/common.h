@@ -25,6 +25,7 @@
 #include <glibmm/ustring.h>
 #include <iostream>
 #include <signal.h>
+#include <string>
 #include <vector>
 #include "SDL.h"
 
@@ -37,6 +38,9 @@ typedef Glib::ustring ustring;
 /// Typedef'd Unicode character
 typedef gunichar uchar;
 
+/// String of decoded Unicode characters, one per element, for constant time indexing
+typedef std::basic_string<uchar> UTF32String;
+
 /// Typedef for a null string
 const ustring STR_NULL="null";
 
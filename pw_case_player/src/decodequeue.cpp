@@ -0,0 +1,277 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// decodequeue.cpp: implementation of the DecodeQueue class
+
+#include "SDL_image.h"
+
+#include "decodequeue.h"
+#include "utilities.h"
+
+// constructor
+DecodeQueue::DecodeQueue(int threads) {
+	m_NextJob=0;
+	m_Pending=0;
+	m_Finished=false;
+	
+	m_Lock=SDL_CreateMutex();
+	m_JobReady=SDL_CreateCond();
+	m_JobDone=SDL_CreateCond();
+	
+	// use one thread per processor by default
+	if (threads<=0)
+		threads=Utils::processorCount();
+	
+	for (int i=0; i<threads; i++) {
+		SDL_Thread *thread=SDL_CreateThread(&DecodeQueue::workerMain, this);
+		if (thread)
+			m_Threads.push_back(thread);
+	}
+	
+	if (Utils::g_IDebugOn)
+		Utils::debugMessage("Decoding images on "+Utils::itoa(m_Threads.size())+" thread(s)");
+}
+
+// destructor
+DecodeQueue::~DecodeQueue() {
+	// make sure nothing is left behind
+	flush();
+	
+	SDL_DestroyCond(m_JobReady);
+	SDL_DestroyCond(m_JobDone);
+	SDL_DestroyMutex(m_Lock);
+}
+
+// queue an image for decoding
+GLuint DecodeQueue::push(const ustring &id, IO::MappedFile &mf, int alpha) {
+	int size;
+	const char *data=IO::readImageData(mf, size);
+	
+	return push(id, data, size, alpha);
+}
+
+// queue image data for decoding
+GLuint DecodeQueue::push(const ustring &id, const char *data, int size, int alpha, GLuint glId) {
+	Job job;
+	job.id=id;
+	job.data=data;
+	job.size=size;
+	job.alpha=alpha;
+	job.glId=glId;
+	job.img.surface=NULL;
+	job.error="";
+	job.claimed=false;
+	job.done=false;
+	job.uploaded=false;
+	
+	// reserve a texture name now, so that it can be stored right away
+	if (job.glId==0)
+		job.glId=Textures::generateName();
+	
+	SDL_LockMutex(m_Lock);
+	m_Jobs.push_back(job);
+	m_Pending++;
+	SDL_CondSignal(m_JobReady);
+	SDL_UnlockMutex(m_Lock);
+	
+	return job.glId;
+}
+
+// keep a mapped file open until flushed
+void DecodeQueue::adopt(const IO::MappedFile &mf) {
+	m_Files.push_back(mf);
+}
+
+// wait for decoding, and upload textures
+void DecodeQueue::flush() {
+	// tell the workers that no more jobs are coming
+	SDL_LockMutex(m_Lock);
+	m_Finished=true;
+	SDL_CondBroadcast(m_JobReady);
+	SDL_UnlockMutex(m_Lock);
+	
+	// the calling thread helps with the remaining jobs
+	work();
+	
+	for (int i=0; i<m_Threads.size(); i++)
+		SDL_WaitThread(m_Threads[i], NULL);
+	m_Threads.clear();
+	
+	// upload all textures in the order they were queued
+	for (int i=0; i<m_Jobs.size(); i++)
+		upload(m_Jobs[i]);
+	m_Jobs.clear();
+	m_NextJob=0;
+	
+	// the image data is no longer needed
+	for (int i=0; i<m_Files.size(); i++)
+		IO::unmapFile(m_Files[i]);
+	m_Files.clear();
+}
+
+// upload textures that have been decoded so far
+void DecodeQueue::uploadFinished() {
+	SDL_LockMutex(m_Lock);
+	
+	// upload from the front of the queue, so that the order is kept
+	while(!m_Jobs.empty() && m_Jobs.front().done) {
+		Job job=m_Jobs.front();
+		m_Jobs.pop_front();
+		m_NextJob--;
+		
+		// no need to hold the lock while uploading
+		SDL_UnlockMutex(m_Lock);
+		upload(job);
+		SDL_LockMutex(m_Lock);
+	}
+	
+	SDL_UnlockMutex(m_Lock);
+}
+
+// upload a single image right away
+bool DecodeQueue::uploadNow(GLuint glId) {
+	SDL_LockMutex(m_Lock);
+	
+	// jobs are only removed from this thread, so the pointer stays valid
+	Job *job=NULL;
+	for (int i=0; i<m_Jobs.size(); i++) {
+		if (m_Jobs[i].glId==glId && !m_Jobs[i].uploaded) {
+			job=&m_Jobs[i];
+			break;
+		}
+	}
+	
+	if (!job) {
+		SDL_UnlockMutex(m_Lock);
+		return false;
+	}
+	
+	// decode it here rather than waiting for the workers to get to it
+	if (!job->claimed) {
+		job->claimed=true;
+		SDL_UnlockMutex(m_Lock);
+		
+		decode(*job);
+		
+		SDL_LockMutex(m_Lock);
+		job->done=true;
+		m_Pending--;
+		SDL_CondBroadcast(m_JobDone);
+	}
+	
+	// otherwise, a worker is decoding it already
+	else {
+		while(!job->done)
+			SDL_CondWait(m_JobDone, m_Lock);
+	}
+	
+	// the job stays queued, so that the order of the others is kept
+	Job copy=*job;
+	job->uploaded=true;
+	job->img.surface=NULL;
+	SDL_UnlockMutex(m_Lock);
+	
+	upload(copy);
+	return true;
+}
+
+// see if all images were uploaded
+bool DecodeQueue::empty() {
+	SDL_LockMutex(m_Lock);
+	bool ret=m_Jobs.empty();
+	SDL_UnlockMutex(m_Lock);
+	
+	return ret;
+}
+
+// upload a single decoded job
+void DecodeQueue::upload(Job &job) {
+	// this was already uploaded out of order
+	if (job.uploaded)
+		return;
+	
+	if (!job.img.surface) {
+		Utils::alert("Error loading internal image: '"+(job.error!="" ? job.error : ustring("no image data"))+"'");
+		
+		// the name was already handed out, so it must not be given back, or it could
+		// be reused for another texture; left unregistered, it resolves to the null texture
+		return;
+	}
+	
+	Textures::uploadTexture(job.id, job.img, job.glId);
+}
+
+// decode the image of a job
+void DecodeQueue::decode(Job &job) {
+	if (!job.data)
+		return;
+	
+	// decode the image straight from the mapped bytes
+	SDL_RWops *rw=SDL_RWFromConstMem(job.data, job.size);
+	SDL_Surface *srf=(rw ? IMG_Load_RW(rw, 1) : NULL);
+	
+	// errors are reported from the main thread once uploaded
+	if (!srf)
+		job.error=SDL_GetError();
+	else
+		Textures::prepareSurface(srf, job.alpha, job.img);
+}
+
+// worker thread entry point
+int DecodeQueue::workerMain(void *data) {
+	((DecodeQueue*) data)->work();
+	return 0;
+}
+
+// decode jobs until finished
+void DecodeQueue::work() {
+	while(1) {
+		SDL_LockMutex(m_Lock);
+		
+		// wait for work to show up
+		while(m_NextJob==m_Jobs.size() && !m_Finished)
+			SDL_CondWait(m_JobReady, m_Lock);
+		
+		// nothing left to do
+		if (m_NextJob==m_Jobs.size()) {
+			SDL_UnlockMutex(m_Lock);
+			return;
+		}
+		
+		Job *job=&m_Jobs[m_NextJob++];
+		
+		// the main thread already took this one
+		if (job->claimed) {
+			SDL_UnlockMutex(m_Lock);
+			continue;
+		}
+		
+		job->claimed=true;
+		SDL_UnlockMutex(m_Lock);
+		
+		decode(*job);
+		
+		// flag that this job can be uploaded
+		SDL_LockMutex(m_Lock);
+		job->done=true;
+		m_Pending--;
+		SDL_CondBroadcast(m_JobDone);
+		SDL_UnlockMutex(m_Lock);
+	}
+}
@@ -0,0 +1,163 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// decodequeue.h: the DecodeQueue class
+
+#ifndef DECODEQUEUE_H
+#define DECODEQUEUE_H
+
+#include <deque>
+#include <vector>
+#include "SDL_thread.h"
+
+#include "common.h"
+#include "iohandler.h"
+#include "texture.h"
+
+/** A pool of worker threads that decode images in parallel.
+  * Compressed image payloads are pushed onto the queue from the main thread, 
+  * and each is given a GL texture name right away, so the caller can store it 
+  * as usual. Workers decode the payloads and apply alpha and color key 
+  * processing in the background. Calling flush() waits for the workers and 
+  * uploads the textures on the calling (GL) thread, in the order in which 
+  * they were pushed, so texture names and IDs are the same as with serial loading.
+*/
+class DecodeQueue {
+	public:
+		/** Constructor
+		  * \param threads Amount of worker threads, or 0 to use one per processor
+		*/
+		DecodeQueue(int threads=0);
+		
+		/// Destructor
+		~DecodeQueue();
+		
+		/** Queue an image stored in a mapped file for decoding
+		  * The image data must stay mapped until flush() is called.
+		  * \param id The ID of the texture, or STR_NULL for an automatic name
+		  * \param mf The mapped file with read pointer set to the image
+		  * \param alpha The requested alpha value to apply
+		  * \return The GL texture name reserved for this image
+		*/
+		GLuint push(const ustring &id, IO::MappedFile &mf, int alpha=255);
+		
+		/** Queue image data for decoding
+		  * The image data must stay valid until the image is uploaded.
+		  * \param id The ID of the texture, or STR_NULL for an automatic name
+		  * \param data Pointer to the compressed image data
+		  * \param size Size of the image data in bytes
+		  * \param alpha The requested alpha value to apply
+		  * \param glId A previously generated GL texture name, or 0 to reserve a new one
+		  * \return The GL texture name reserved for this image
+		*/
+		GLuint push(const ustring &id, const char *data, int size, int alpha=255, GLuint glId=0);
+		
+		/** Keep a mapped file open until the queue is flushed
+		  * \param mf The mapped file, which the queue now owns
+		*/
+		void adopt(const IO::MappedFile &mf);
+		
+		/** Wait for all images to be decoded, and upload them
+		  * This must be called from the thread that owns the GL context.
+		*/
+		void flush();
+		
+		/** Upload images that have already been decoded, without stopping the workers
+		  * Images are uploaded in queue order, so this stops at the first image that is
+		  * still being decoded. This must be called from the thread that owns the GL context.
+		*/
+		void uploadFinished();
+		
+		/** Upload a single queued image right away, leaving the rest of the queue running
+		  * If no worker has picked the image up yet, it is decoded on the calling thread, 
+		  * otherwise this waits only for that image. This must be called from the thread 
+		  * that owns the GL context.
+		  * \param glId The GL texture name reserved for the image
+		  * \return <b>true</b> if the image was uploaded, <b>false</b> if it's not in the queue
+		*/
+		bool uploadNow(GLuint glId);
+		
+		/** See if all queued images have been uploaded
+		  * \return <b>true</b> if the queue is empty, <b>false</b> otherwise
+		*/
+		bool empty();
+		
+	private:
+		/// A single queued image
+		struct Job {
+			ustring id;
+			const char *data;
+			int size;
+			int alpha;
+			GLuint glId;
+			Textures::PreparedImage img;
+			ustring error;
+			bool claimed;
+			bool done;
+			bool uploaded;
+		};
+		
+		/** Decode the image of a job
+		  * \param job The job to decode
+		*/
+		static void decode(Job &job);
+		
+		/** Upload a decoded job, or report why it failed
+		  * \param job The job to upload
+		*/
+		void upload(Job &job);
+		
+		/** Entry point for worker threads
+		  * \param data Pointer to the DecodeQueue object
+		  * \return Always 0
+		*/
+		static int workerMain(void *data);
+		
+		/// Decode jobs until the queue is finished
+		void work();
+		
+		/// Queued jobs; a deque so references stay valid as it grows
+		std::deque<Job> m_Jobs;
+		
+		/// Index of the next job to be picked up by a worker
+		int m_NextJob;
+		
+		/// Amount of jobs that have not been decoded yet
+		int m_Pending;
+		
+		/// Flag that no more jobs will be pushed
+		bool m_Finished;
+		
+		/// Mapped files to release once flushed
+		std::vector<IO::MappedFile> m_Files;
+		
+		/// Worker threads
+		std::vector<SDL_Thread*> m_Threads;
+		
+		/// Lock protecting the job queue
+		SDL_mutex *m_Lock;
+		
+		/// Signaled when jobs are added or the queue is finished
+		SDL_cond *m_JobReady;
+		
+		/// Signaled when a job has been decoded
+		SDL_cond *m_JobDone;
+};
+
+#endif
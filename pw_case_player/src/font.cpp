@@ -26,9 +26,12 @@
 
 #include "iohandler.h"
 #include "font.h"
+#include "profiler.h"
 #include "renderer.h"
+#include "textlayout.h"
 #include "texture.h"
 #include "utilities.h"
+#include "vfs.h"
 
 namespace Fonts {
 
@@ -43,16 +46,111 @@ const Color COLOR_YELLOW(229, 204, 148);
 
 }
 
+// create an empty rgba surface for a glyph atlas
+static SDL_Surface* createAtlasSurface(int h) {
+	Uint32 rm, gm, bm, am;
+	Utils::setRGBAMasks(rm, gm, bm, am);
+	
+	SDL_Surface *surface=SDL_CreateRGBSurface(SDL_SWSURFACE, Fonts::ATLAS_WIDTH, h, 32, rm, gm, bm, am);
+	if (surface)
+		SDL_FillRect(surface, NULL, 0);
+	
+	return surface;
+}
+
+// upload the entire atlas, resizing its texture
+static void uploadAtlas(Fonts::Font *f) {
+	if (!Renderer::g_Output)
+		return;
+	
+	glBindTexture(GL_TEXTURE_2D, f->atlasId);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, f->atlas->w, f->atlas->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, f->atlas->pixels);
+	Renderer::invalidateRegions();
+	Profiler::count(Profiler::COUNTER_UPLOADS);
+	
+	// the whole atlas is allocated, even if only some of it holds glyphs
+	Textures::setCategory(f->atlasId, Textures::CATEGORY_GLYPHS);
+	Textures::account(f->atlasId, f->atlas->w*f->atlas->h*4, f->atlas->w*f->atlas->h*4);
+}
+
+// upload a band of rows in the atlas
+static void uploadAtlasRows(Fonts::Font *f, int y, int h) {
+	if (!Renderer::g_Output)
+		return;
+	
+	Uint8 *pixels=(Uint8*) f->atlas->pixels+y*f->atlas->pitch;
+	
+	glBindTexture(GL_TEXTURE_2D, f->atlasId);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, f->atlas->w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	Renderer::invalidateRegions();
+	Profiler::count(Profiler::COUNTER_UPLOADS);
+}
+
+// double the height of an atlas
+static bool growAtlas(Fonts::Font *f) {
+	GLint maxSize=4096;
+	if (Renderer::g_Output)
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	if (f->atlas->h*2>maxSize)
+		return false;
+	
+	SDL_Surface *grown=createAtlasSurface(f->atlas->h*2);
+	if (!grown)
+		return false;
+	
+	// copy the existing glyphs over as they are
+	SDL_SetAlpha(f->atlas, 0, 0);
+	SDL_BlitSurface(f->atlas, NULL, grown, NULL);
+	SDL_FreeSurface(f->atlas);
+	
+	// quads that are already queued use texture coordinates for the old height
+	Renderer::flush();
+	
+	f->atlas=grown;
+	uploadAtlas(f);
+	
+	return true;
+}
+
+// get the width of a glyph in an already resolved font
+static int glyphWidth(Fonts::Font *font, Uint16 ch) {
+	if ((ch>=0x01 && ch<=0x05) || ch==0x00)
+		return -1;
+	
+	const Fonts::GlyphMetrics *m=Fonts::queryMetrics(font, ch);
+	return (m ? m->width : -1);
+}
+
 // load a font
 bool Fonts::loadFont(const ustring &str, int size) {
-	TTF_Font *font=TTF_OpenFontRW(SDL_RWFromFile(str.c_str(), "rb"), 1, size);
+	SDL_RWops *rw=VFS::open(str);
+	if (!rw)
+		return false;
+	
+	TTF_Font *font=TTF_OpenFontRW(rw, 1, size);
 	if (font) {
 		Font f;
 		f.font=font;
+		f.atlas=createAtlasSurface(ATLAS_HEIGHT);
+		f.penX=f.penY=ATLAS_PADDING;
+		f.rowHeight=0;
+		
+		for (int i=0; i<METRICS_PAGES; i++)
+			f.metrics[i]=NULL;
+		
+		if (!f.atlas) {
+			TTF_CloseFont(font);
+			return false;
+		}
+		
+		f.atlasId=Textures::generateName();
+		uploadAtlas(&f);
 		
-		// once the font is opened, generate 256 characters for the cache
+		// once the font is opened, pack the ascii characters into the atlas
 		for (uchar i=20; i<(uchar) 128; ++i)
-			f.glyphs[i]=renderGlyph(&f, i, (size==FONT_STANDARD ? QUALITY_SOLID : QUALITY_BLEND));
+			renderGlyph(&f, i, (size==FONT_STANDARD ? QUALITY_SOLID : QUALITY_BLEND));
 		
 		g_Fonts[size]=f;
 		
@@ -62,9 +160,14 @@ bool Fonts::loadFont(const ustring &str, int size) {
 	return false;
 }
 
-// get a texture with a rendered glyph
-Textures::Texture Fonts::renderGlyph(const Font *f, Uint16 ch, const Quality &quality) {
-	Textures::Texture tex;
+// render a glyph into the font's atlas
+const Fonts::Glyph* Fonts::renderGlyph(Font *f, uchar ch, const Quality &quality) {
+	// compute the metrics along with the glyph image
+	queryMetrics(f, ch);
+	
+	// glyphs that can't be rendered are remembered as empty ones
+	Glyph &g=f->glyphs[ch];
+	g.x=g.y=g.w=g.h=0;
 	
 	SDL_Surface *surface;
 	switch(quality) {
@@ -73,20 +176,96 @@ Textures::Texture Fonts::renderGlyph(const Font *f, Uint16 ch, const Quality &qu
 		case QUALITY_BLEND: surface=TTF_RenderGlyph_Blended(f->font, ch, COLOR_WHITE.toSDLColor()); break;
 	}
 	
-	return Textures::queryTexture(Textures::createTexture("null", surface));
+	if (!surface)
+		return &g;
+	
+	if (surface->w+ATLAS_PADDING*2>ATLAS_WIDTH) {
+		SDL_FreeSurface(surface);
+		return &g;
+	}
+	
+	// start a new row if this glyph doesn't fit on the current one
+	if (f->penX+surface->w+ATLAS_PADDING>ATLAS_WIDTH) {
+		f->penX=ATLAS_PADDING;
+		f->penY+=f->rowHeight+ATLAS_PADDING;
+		f->rowHeight=0;
+	}
+	
+	// make room if the atlas is full
+	while(f->penY+surface->h+ATLAS_PADDING>f->atlas->h) {
+		if (!growAtlas(f)) {
+			Utils::debugMessage("Font: glyph atlas is full");
+			SDL_FreeSurface(surface);
+			return &g;
+		}
+	}
+	
+	// copy the glyph into the atlas, replacing its alpha
+	SDL_SetAlpha(surface, 0, 0);
+	SDL_Rect drect={ f->penX, f->penY };
+	SDL_BlitSurface(surface, NULL, f->atlas, &drect);
+	
+	g.x=f->penX;
+	g.y=f->penY;
+	g.w=surface->w;
+	g.h=surface->h;
+	
+	SDL_FreeSurface(surface);
+	
+	uploadAtlasRows(f, g.y, g.h);
+	
+	// advance past this glyph
+	f->penX+=g.w+ATLAS_PADDING;
+	if (g.h>f->rowHeight)
+		f->rowHeight=g.h;
+	
+	return &g;
+}
+
+// get a glyph from the atlas, rendering it if needed
+const Fonts::Glyph* Fonts::queryGlyph(Font *font, uchar ch, int size) {
+	std::map<uchar, Glyph>::iterator it=font->glyphs.find(ch);
+	if (it!=font->glyphs.end())
+		return &(*it).second;
+	
+	return renderGlyph(font, ch, (size==FONT_STANDARD ? QUALITY_SOLID : QUALITY_BLEND));
+}
+
+// get the metrics of a glyph
+const Fonts::GlyphMetrics* Fonts::queryMetrics(Font *font, uchar ch) {
+	// the font might not be loaded
+	if (!font || ch>=0x10000 || !font->font)
+		return NULL;
+	
+	// allocate the page containing this glyph on first use
+	GlyphMetrics *&page=font->metrics[ch/METRICS_PAGE_SIZE];
+	if (!page)
+		page=new GlyphMetrics[METRICS_PAGE_SIZE]();
+	
+	GlyphMetrics &m=page[ch%METRICS_PAGE_SIZE];
+	if (!m.valid) {
+		int minx=0, maxx=0, maxy=0, advance=0;
+		TTF_GlyphMetrics(font->font, ch, &minx, &maxx, NULL, &maxy, &advance);
+		
+		m.advance=advance;
+		m.minx=minx;
+		m.maxy=maxy;
+		m.width=maxx-minx;
+		m.baseOffset=TTF_FontAscent(font->font)-maxy;
+		m.valid=true;
+	}
+	
+	return &m;
 }
 
 // calculate the y coordinate for a glyph to render correctly on baseline
 int Fonts::glyphBase(int y, Uint16 ch, int size) {
-	Font *f=queryFont(size);
-	if (!f)
+	const GlyphMetrics *m=queryMetrics(queryFont(size), ch);
+	if (!m)
 		return 0;
 	
-	int maxy;
-	TTF_GlyphMetrics(f->font, ch, NULL, NULL, NULL, &maxy, NULL);
-	
 	// calculate where to begin drawing this rectangle
-	return y+TTF_FontAscent(f->font)-maxy;
+	return y+m->baseOffset;
 }
 
 // see if a character should not be drawn
@@ -106,187 +285,74 @@ bool Fonts::discardChar(Uint16 ch) {
 
 // see if this string is too long and needs to be broken
 bool Fonts::lineWillBreak(const Point &p, int rightClamp, const ustring &str, int size) {
-	int breakCount=0;
-	int ex=p.x();
-	
+	return lineWillBreak(p, rightClamp, Utils::toUTF32(str), size);
+}
+
+// see if this decoded string is too long and needs to be broken
+bool Fonts::lineWillBreak(const Point &p, int rightClamp, const UTF32String &str, int size) {
 	// get the requested font
 	if (!queryFont(size)) {
 		Utils::debugMessage("Font: font size '"+Utils::itoa(size)+"' not found");
 		return -1;
 	}
-	Font *font=queryFont(size);
-	
-	for (int i=0; i<str.size(); i++) {
-		Uint16 ch=(Uint16) str[i];
-		
-		// see if we should force a new line
-		if (ch=='\n') {
-			// check if we already have three lines
-			if (breakCount==2)
-				return true;
-			
-			ex=p.x();
-			
-			breakCount++;
-			continue;
-		}
-		
-		// see if this is a literal new line character
-		if (ch=='\\' && str[i+1]=='n') {
-			// make sure we don't make any extra lines
-			if (breakCount==3)
-				return true;
-			
-			ex=p.x();
-			
-			breakCount++;
-			
-			// we skip the next character
-			i++;
-			
-			continue;
-		}
-		
-		// if a space is needed, skip some pixels
-		else if (ch==' ') {
-			ex+=SIZE_WHITESPACE;
-			
-			continue;
-		}
-		
-		// ignore certain characters
-		else if (discardChar(ch))
-			continue;
-		
-		// force a new line if needed
-		int width=getGlyphWidth(ch, size)+getGlyphWidth(str[i+1], size)+2;
-		if ((ex+width)>=rightClamp) {
-			// check if we already have three lines
-			if (breakCount==2)
-				return true;
-			
-			// reset for next row
-			ex=p.x();
-			
-			// move to next one
-			ex+=getGlyphWidth(ch, size);
-			
-			breakCount++;
-			continue;
-		}
-		
-		// move over to the next glyph
-		ex+=getGlyphWidth(ch, size);
-	}
 	
-	return false;
+	TextLayout layout(size, rightClamp-p.x());
+	return (layout.layout(str)!=-1);
 }
 
 // draw a string on the screen
 int Fonts::drawString(const Point &p, const ustring &str, int size, const Color &color) {
-	drawString(p, str.size(), SDL_GetVideoSurface()->w, str, size, color);
+	UTF32String decoded=Utils::toUTF32(str);
+	return drawString(p, decoded.size(), SDL_GetVideoSurface()->w, decoded, size, color);
 }
 
 // draw a string with clamped restrictions
 int Fonts::drawString(const Point &p, int limit, int rightClamp, const ustring &str, int size, const Color &color) {
+	return drawString(p, limit, rightClamp, Utils::toUTF32(str), size, color);
+}
+
+// draw a decoded string with clamped restrictions
+int Fonts::drawString(const Point &p, int limit, int rightClamp, const UTF32String &str, int size, const Color &color) {
 	ColorRangeVector vec;
 	vec.push_back(std::make_pair<ValueRange, Color> (ValueRange(0, 256), color));
 	
 	// draw the string using just this color
-	drawStringMulticolor(p, limit, rightClamp, str, size, vec);
+	return drawStringMulticolor(p, limit, rightClamp, str, size, vec);
 }
 
 // draw a multicolor string
 int Fonts::drawStringMulticolor(const Point &p, int limit, int rightClamp, const ustring &str, int size, const ColorRangeVector &vec) {
-	// also, make sure the default video surface exists
-	SDL_Surface *screen=SDL_GetVideoSurface();
-	
+	return drawStringMulticolor(p, limit, rightClamp, Utils::toUTF32(str), size, vec);
+}
+
+// draw a decoded multicolor string
+int Fonts::drawStringMulticolor(const Point &p, int limit, int rightClamp, const UTF32String &str, int size, const ColorRangeVector &vec) {
 	// get the requested font
 	if (!queryFont(size)) {
 		Utils::debugMessage("Font: font size '"+Utils::itoa(size)+"' not found");
 		return -1;
 	}
-	Font *font=queryFont(size);
 	
-	// set initial position
-	SDL_Rect drect;
-	drect.x=p.x();
-	drect.y=p.y();
+	// lay out the string and draw it
+	TextLayout layout(size, rightClamp-p.x());
+	int stop=layout.layout(str);
+	drawLayout(p, layout, limit, vec);
 	
-	// count the amount of times we started a new line
-	int breakCount=0;
+	return (stop<limit ? stop : -1);
+}
+
+// draw a laid out string
+void Fonts::drawLayout(const Point &p, const TextLayout &layout, int limit, const ColorRangeVector &vec) {
+	Font *font=queryFont(layout.fontSize());
 	
 	// bounds check
-	if (limit>str.size())
-		limit=str.size();
+	if (limit>layout.size())
+		limit=layout.size();
 	
-	// iterate over string and draw each character
 	for (int i=0; i<limit; i++) {
-		Uint16 ch=(Uint16) str[i];
-		
-		// don't bother drawing unknown characters
-		if (getGlyphWidth(ch, size)==-1)
-			continue;
-		
-		// see if we should force a new line
-		if (ch=='\n') {
-			// check if we already have three lines
-			if (breakCount==2)
-				return i;
-			
-			drect.x=p.x();
-			drect.y+=SIZE_LINE_BREAK;
-			
-			breakCount++;
-			continue;
-		}
-		
-		// see if this is a literal new line character
-		if (ch=='\\' && str[i+1]=='n') {
-			// make sure we don't make any extra lines
-			if (breakCount==2)
-				return i;
-			
-			drect.x=p.x();
-			drect.y+=SIZE_LINE_BREAK;
-			
-			breakCount++;
-			
-			// we skip the next character
-			i++;
-			
+		const LayoutGlyph &lg=layout.glyph(i);
+		if (!lg.visible)
 			continue;
-		}
-		
-		// if a space is needed, skip some pixels
-		else if (ch==' ') {
-			drect.x+=SIZE_WHITESPACE;
-			
-			continue;
-		}
-		
-		// ignore certain characters
-		else if (discardChar(ch))
-			continue;
-		
-		// force a new line if needed
-		int width=getGlyphWidth(ch, size)+getGlyphWidth(str[i+1], size)+SIZE_CHAR_SPACE;
-		if ((drect.x+width)>=rightClamp) {
-			// check if we already have three lines
-			if (breakCount==2)
-				return i;
-			
-			// reset for next row
-			drect.x=p.x();
-			drect.y+=SIZE_LINE_BREAK;
-			
-			breakCount++;
-		}
-		
-		// draw the glyph
-		// modify the y coordinate
-		SDL_Rect r={ drect.x, drect.y };
-		r.y=glyphBase(drect.y, ch, size);
 		
 		// see if we should apply a color to this glyph
 		Color color=COLOR_WHITE;
@@ -297,34 +363,38 @@ int Fonts::drawStringMulticolor(const Point &p, int limit, int rightClamp, const
 			}
 		}
 		
-		glColor3ub(color.r(), color.g(), color.b());
-		
-		// if this glyph doesn't exist, create it and cache it for future use
-		if (font->glyphs.find(ch)==font->glyphs.end())
-			font->glyphs[ch]=renderGlyph(font, ch, (size==FONT_STANDARD ? QUALITY_SOLID : QUALITY_BLEND));
-		
-		// draw this glyph
-		Textures::Texture g=font->glyphs[ch];
-		Renderer::drawImage(Point(r.x, r.y, Z_TEXT), g);
-		
-		glColor3ub(255, 255, 255);
-		
-		// move over to the next glyph
-		drect.x+=getGlyphWidth(ch, size)+SIZE_CHAR_SPACE;
+		// draw this glyph out of the font's atlas, rendering it first if needed
+		const Glyph *g=queryGlyph(font, lg.ch, layout.fontSize());
+		if (g->w>0) {
+			float aw=font->atlas->w, ah=font->atlas->h;
+			Renderer::drawQuad(Point(p.x()+lg.x, p.y()+lg.y, Z_TEXT), g->w, g->h, font->atlasId,
+					   g->x/aw, g->y/ah, (g->x+g->w)/aw, (g->y+g->h)/ah, color);
+			Profiler::count(Profiler::COUNTER_GLYPHS);
+		}
 	}
-	
-	return -1;
 }
 
 // draw a string centered on the screen
 int Fonts::drawStringCentered(int y, int delimiter, const ustring &str, int size, const Color &color) {
-	ustring nstr=str;
-	
+	return drawStringCentered(y, delimiter, Utils::toUTF32(str), size, color);
+}
+
+// draw a decoded string centered on the screen
+int Fonts::drawStringCentered(int y, int delimiter, const UTF32String &str, int size, const Color &color) {
 	// cache the right clamp value
 	int clamp=SDL_GetVideoSurface()->w;
 	
-	// explode the string
-	StringVector vec=Utils::explodeString("\\n", str);
+	// split the string at literal new lines
+	std::vector<UTF32String> vec;
+	int start=0;
+	for (int i=0; i+1<str.size(); i++) {
+		if (str[i]=='\\' && str[i+1]=='n') {
+			vec.push_back(str.substr(start, i-start));
+			start=i+2;
+			i++;
+		}
+	}
+	vec.push_back(str.substr(start));
 	
 	// draw first string, since there's always at least one
 	int x=128-(Fonts::getWidth(vec[0], size)/2);
@@ -343,6 +413,8 @@ int Fonts::drawStringCentered(int y, int delimiter, const ustring &str, int size
 			drawString(Point(x, y+Fonts::SIZE_LINE_BREAK*2, Z_TEXT), delimiter-(vec[0].size()+vec[1].size()), clamp, vec[2], size, color);
 		}
 	}
+	
+	return -1;
 }
 
 // draw a ttf font string
@@ -365,6 +437,11 @@ void Fonts::drawStringBlended(const Point &p, const ustring &str, int size, cons
 
 // get the width of a string
 int Fonts::getWidth(const ustring &str, int size) {
+	return getWidth(Utils::toUTF32(str), size);
+}
+
+// get the width of a decoded string
+int Fonts::getWidth(const UTF32String &str, int size) {
 	// get the requested font
 	if (!queryFont(size)) {
 		Utils::debugMessage("Font: font size '"+Utils::itoa(size)+"' not found");
@@ -385,7 +462,7 @@ int Fonts::getWidth(const ustring &str, int size) {
 				width+=SIZE_WHITESPACE;
 			
 			else
-				width+=getGlyphWidth(' ', size);
+				width+=glyphWidth(font, ' ');
 		}
 		
 		else {
@@ -394,7 +471,7 @@ int Fonts::getWidth(const ustring &str, int size) {
 			
 			else {
 				// increment width
-				width+=getGlyphWidth(str[i], size)+SIZE_CHAR_SPACE;
+				width+=glyphWidth(font, str[i])+SIZE_CHAR_SPACE;
 			}
 		}
 	}
@@ -418,14 +495,7 @@ int Fonts::getWidthTTF(const ustring &str, int size) {
 
 // get the width of a glyph
 int Fonts::getGlyphWidth(Uint16 ch, int size) {
-	Font *font=queryFont(size);
-	if (font && !(ch>=0x01 && ch<=0x05) && ch!=0x00) {
-		int min, max;
-		TTF_GlyphMetrics(font->font, ch, &min, &max, NULL, NULL, NULL);
-		return max-min;
-	}
-	
-	return -1;
+	return glyphWidth(queryFont(size), ch);
 }
 
 // get the height of a ttf font
@@ -454,5 +524,17 @@ void Fonts::clearFontStack() {
 	for (std::map<int, Font>::iterator it=g_Fonts.begin(); it!=g_Fonts.end(); ++it) {
 		if ((*it).second.font)
 			TTF_CloseFont((*it).second.font);
+		
+		// free the metrics table
+		for (int i=0; i<METRICS_PAGES; i++)
+			delete [] (*it).second.metrics[i];
+		
+		// free the glyph atlas as well
+		if ((*it).second.atlas) {
+			SDL_FreeSurface((*it).second.atlas);
+			Textures::deleteName((*it).second.atlasId);
+		}
 	}
+	
+	g_Fonts.clear();
 }
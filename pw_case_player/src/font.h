@@ -30,6 +30,8 @@
 #include "case.h"
 #include "texture.h"
 
+class TextLayout;
+
 /// Namespace for all font and string drawing related API
 namespace Fonts {
 
@@ -72,9 +74,53 @@ extern const Color COLOR_YELLOW;
 /// Quality of font glyph rendering
 enum Quality { QUALITY_SOLID=0, QUALITY_BLEND };
 
+/// Width of each font's glyph atlas
+const int ATLAS_WIDTH=256;
+
+/// Initial height of a glyph atlas; the height is doubled whenever it runs out of room
+const int ATLAS_HEIGHT=128;
+
+/// Pixels left empty around each glyph in the atlas
+const int ATLAS_PADDING=1;
+
+/// Location of a rendered glyph in its font's atlas
+struct _Glyph {
+	int x;	///< Left edge in the atlas
+	int y;	///< Top edge in the atlas
+	int w;	///< Width of the glyph image
+	int h;	///< Height of the glyph image
+};
+typedef struct _Glyph Glyph;
+
+/// Metrics of a single glyph, computed the first time they are needed
+struct _GlyphMetrics {
+	bool valid;		///< Whether or not this entry was computed yet
+	int advance;		///< Horizontal advance of the glyph
+	int minx;		///< Left edge of the glyph relative to the pen position
+	int maxy;		///< Top edge of the glyph relative to the baseline
+	int width;		///< Width of the glyph's bounding box
+	int baseOffset;		///< Distance from the top of the line to the top of the glyph
+};
+typedef struct _GlyphMetrics GlyphMetrics;
+
+/// Number of glyphs in each page of a font's metrics table
+const int METRICS_PAGE_SIZE=256;
+
+/// Number of pages needed to cover the Basic Multilingual Plane
+const int METRICS_PAGES=0x10000/METRICS_PAGE_SIZE;
+
 struct _Font {
 	TTF_Font *font;
-	std::map<uchar, Textures::Texture> glyphs;
+	std::map<uchar, Glyph> glyphs;
+	
+	/// Metrics table indexed by code point, allocated a page at a time
+	GlyphMetrics *metrics[METRICS_PAGES];
+	
+	SDL_Surface *atlas;	///< RGBA copy of the atlas, kept to rebuild the texture when it grows
+	GLuint atlasId;		///< The GL texture containing every cached glyph
+	int penX;		///< Left edge of the next glyph in the current row
+	int penY;		///< Top edge of the current row
+	int rowHeight;		///< Height of the tallest glyph in the current row
 };
 typedef struct _Font Font;
 
@@ -88,13 +134,28 @@ extern std::map<int, Font> g_Fonts;
 */
 bool loadFont(const ustring &path, int size);
 
-/** Draw a single glyph onto a new texture
+/** Draw a single glyph into the font's atlas
   * \param font The font to use
   * \param ch The Unicode character to render
   * \param quality The quality of the rendering
-  * \return A new OpenGL texture ID
+  * \return Pointer to the glyph's location in the atlas, or NULL on error
 */
-Textures::Texture renderGlyph(const Font *font, Uint16 ch, const Quality &quality);
+const Glyph* renderGlyph(Font *font, uchar ch, const Quality &quality);
+
+/** Get a glyph from the font's atlas, rendering it if it isn't cached yet
+  * \param font The font to use
+  * \param ch The Unicode character
+  * \param size The size of the source font
+  * \return Pointer to the glyph's location in the atlas, or NULL on error
+*/
+const Glyph* queryGlyph(Font *font, uchar ch, int size);
+
+/** Get the metrics of a glyph, computing them if this is the first request
+  * \param font The font to use, which may be NULL if it is not loaded
+  * \param ch The Unicode character
+  * \return Pointer to the glyph's metrics, or NULL if there is no font or the character is outside the Basic Multilingual Plane
+*/
+const GlyphMetrics* queryMetrics(Font *font, uchar ch);
 
 /** Calculates the y-coordinate for a glyph to render correctly on the baseline.
   * Since certain glyphs are bigger than others, this function computes the correct 
@@ -125,6 +186,15 @@ bool discardChar(Uint16 ch);
 */
 bool lineWillBreak(const Point &p, int rightClamp, const ustring &str, int size);
 
+/** Check to see if a decoded string is too long for one line
+  * \param p The point at which the string is to be drawn
+  * \param rightClamp The limit at which the line breaks
+  * \param str The string to check
+  * \param size The size of the source font
+  * \return <b>true</b> if this string exceeds the provided limit, <b>false</b> otherwise
+*/
+bool lineWillBreak(const Point &p, int rightClamp, const UTF32String &str, int size);
+
 /** Draw a string on the screen
   * \param p The point at which the string should be drawn
   * \param str The string to draw
@@ -145,6 +215,17 @@ int drawString(const Point &p, const ustring &str, int size, const Color &color)
 */
 int drawString(const Point &p, int delimiter, int rightClamp, const ustring &str, int size, const Color &color);
 
+/** Draw a decoded string with clamped restrictions and delimiter
+  * \param p The point at which the string should be drawn
+  * \param delimiter Index into string at which to stop drawing
+  * \param rightClamp X-coordinate to limit string drawing
+  * \param str The string to draw
+  * \param size The size of the source font
+  * \param color The color of the string
+  * \return Index into the string where drawing stopped
+*/
+int drawString(const Point &p, int delimiter, int rightClamp, const UTF32String &str, int size, const Color &color);
+
 /** Draw a multicolor string
   * \param p The point at which to start drawing
   * \param delimiter Index into string at which to stop drawing
@@ -155,6 +236,24 @@ int drawString(const Point &p, int delimiter, int rightClamp, const ustring &str
 */
 int drawStringMulticolor(const Point &p, int delimiter, int rightClamp, const ustring &str, int size, const ColorRangeVector &vec);
 
+/** Draw a decoded multicolor string
+  * \param p The point at which to start drawing
+  * \param delimiter Index into string at which to stop drawing
+  * \param rightClamp X-coordinate to limit string drawing
+  * \param str The string to draw
+  * \param vec A ColorRangeVector containing color offsets
+  * \return Index into string where drawing stopped
+*/
+int drawStringMulticolor(const Point &p, int delimiter, int rightClamp, const UTF32String &str, int size, const ColorRangeVector &vec);
+
+/** Draw a laid out string
+  * \param p The point at which the layout starts
+  * \param layout The laid out string
+  * \param limit Amount of characters to draw
+  * \param vec A ColorRangeVector containing color offsets
+*/
+void drawLayout(const Point &p, const TextLayout &layout, int limit, const ColorRangeVector &vec);
+
 /** Draw a string centered on the screen
   * \param y The y-coordinate of the string
   * \param delimiter Index into string at which to stop drawing
@@ -165,6 +264,16 @@ int drawStringMulticolor(const Point &p, int delimiter, int rightClamp, const us
 */
 int drawStringCentered(int y, int delimiter, const ustring &str, int size, const Color &color);
 
+/** Draw a decoded string centered on the screen
+  * \param y The y-coordinate of the string
+  * \param delimiter Index into string at which to stop drawing
+  * \param str The string to draw
+  * \param size The size of the source font
+  * \param color The color of the string
+  * \return Index into string at which drawing stopped
+*/
+int drawStringCentered(int y, int delimiter, const UTF32String &str, int size, const Color &color);
+
 /** Draw a string with nicer quality
   * \param p The point at which to draw the string
   * \param str The string to draw
@@ -180,6 +289,13 @@ void drawStringBlended(const Point &p, const ustring &str, int size, const Color
 */
 int getWidth(const ustring &str, int size);
 
+/** Calculate the width of a decoded string
+  * \param str The string to test
+  * \param size The size of the source font
+  * \return The calculated pixel string width as if it were drawn on the screen
+*/
+int getWidth(const UTF32String &str, int size);
+
 /** Calculate the width of a string drawn using the SDL_TTF library functions.
   * This function differs from the regular Fonts::getWidth() in that strings
   * which were drawn using functions such as TTF_RenderUNICODE_* don't follow
@@ -17,7 +17,7 @@
  *   Free Software Foundation, Inc.,                                       *
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
-// fpstimer.h: implementation of FPSTimer class
+// fpstimer.cpp: implementation of FPSTimer class
 
 #include "SDL.h"
 
@@ -26,6 +26,7 @@
 // constructor
 FPSTimer::FPSTimer() {
 	m_LastFrame=0;
+	m_NextFrame=0.0;
 	m_FPSLock=65.0;
 }
 
@@ -38,9 +39,25 @@ double FPSTimer::deltaSeconds(int ticks1, int ticks2) {
 void FPSTimer::delay() {
 	int now=SDL_GetTicks();
 	
-	// loop until delta time has reached the appropriate frame rate
-	while(deltaSeconds(m_LastFrame, now)<(1.0/m_FPSLock))
+	// the frame rate isn't limited
+	if (m_FPSLock<=0.0) {
+		m_LastFrame=now;
+		return;
+	}
+	
+	// if we fell behind by more than a frame, don't try to catch up
+	double frameTime=1000.0/m_FPSLock;
+	if (m_NextFrame<now-frameTime)
+		m_NextFrame=now;
+	
+	// sleep until shortly before the frame is due, then yield for the rest
+	while(now<m_NextFrame) {
+		double remaining=m_NextFrame-now;
+		SDL_Delay(remaining>2.0 ? (Uint32) remaining-2 : 0);
+		
 		now=SDL_GetTicks();
+	}
 	
 	m_LastFrame=now;
+	m_NextFrame+=frameTime;
 }
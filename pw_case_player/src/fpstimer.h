@@ -24,7 +24,10 @@
 
 /** Timer class used for game engine FPS consistency purposes.
   * Since not all computers run graphics games at equal speeds, this
-  * class is responsible for keeping the frame rate at a reasonable level
+  * class is responsible for keeping the frame rate at a reasonable level.
+  * It sleeps for most of the time until the next frame is due, and only 
+  * yields the processor for the last few milliseconds, since sleeping 
+  * can overshoot.
 */
 class FPSTimer {
 	public:
@@ -32,7 +35,7 @@ class FPSTimer {
 		FPSTimer();
 		
 		/** Set the fps to lock the frame rate to; used in delay()
-		  * \param fps The frame rate
+		  * \param fps The frame rate, or 0 to not limit it
 		*/
 		void setFPSLock(double fps) { m_FPSLock=fps; }
 		
@@ -55,6 +58,9 @@ class FPSTimer {
 		/// The last time a frame was drawn
 		int m_LastFrame;
 		
+		/// The time the next frame is due, kept with sub-millisecond precision
+		double m_NextFrame;
+		
 		/// Rate of FPS to lock
 		double m_FPSLock;
 };
@@ -20,12 +20,18 @@
 // game.cpp: implementation of Game class
 
 #include <cmath>
+#include <set>
 
+#include "assets.h"
 #include "audio.h"
+#include "clock.h"
 #include "game.h"
 #include "font.h"
+#include "input.h"
 #include "iohandler.h"
+#include "profiler.h"
 #include "renderer.h"
+#include "symbols.h"
 #include "texture.h"
 #include "utilities.h"
 
@@ -127,6 +133,9 @@ Game::Game(const ustring &rootPath, Case::Case *pcase): m_RootPath(rootPath), m_
 
 // destructor
 Game::~Game() {
+	// stop loading images in the background
+	Assets::clear();
+	
 	// free textures used
 	Textures::clearStack();
 	
@@ -154,7 +163,7 @@ Game* Game::instance() {
 // load stock textures
 bool Game::loadStockTextures() {
 	// load stock assets
-	if (!IO::loadStockFile(".temp/data/stock.cfg", m_Case)) {
+	if (!IO::loadStockFile("data/stock.cfg", m_Case)) {
 		Utils::alert("Unable to load stock assets from file.");
 		return false;
 	}
@@ -185,40 +194,73 @@ bool Game::loadGameState() {
 
 // render the current scene
 void Game::render() {
+	// stay within the texture memory budget before anything is drawn
+	Textures::trim();
+	
+	// upload any images that were loaded in the background
+	Assets::update();
+	
+	// start music that was waiting for a fade out
+	Audio::update();
+	
 	// if we are to shake the screen, do so now, since the elements depend
 	// on the current matrix
 	if (m_State.shake>0) {
-		Point p=Utils::calculateShakePoint(3);
+		Clock::busy();
 		
-		// we need to save our current matrix
-		glPushMatrix();
+		Point p=Utils::calculateShakePoint(3);
 		
-		// reset and translate above all z elements
-		glLoadIdentity();
-		glTranslatef(0.0f, 0.0f, Z_FADE+1.0f);
+		// draw anything queued so far with the current matrix
+		Renderer::flush();
 		
-		// now translate to our shake point
-		glTranslatef(p.x(), p.y(), 0.0f);
+		// we need to save our current matrix
+		if (Renderer::g_Output) {
+			glPushMatrix();
+			
+			// reset and translate above all z elements
+			glLoadIdentity();
+			glTranslatef(0.0f, 0.0f, Z_FADE+1.0f);
+			
+			// now translate to our shake point
+			glTranslatef(p.x(), p.y(), 0.0f);
+		}
 		
+		Profiler::beginPhase(Profiler::PHASE_TOP_VIEW);
 		renderTopView();
+		Renderer::flush();
+		Profiler::endPhase(Profiler::PHASE_TOP_VIEW);
 		
 		// we don't need this matrix anymore
-		glPopMatrix();
+		if (Renderer::g_Output)
+			glPopMatrix();
 		
-		// decrement counter
-		m_State.shake--;
+		// count down the time left to shake
+		m_State.shake-=Clock::delta();
 		if (m_State.shake<=0)
 			m_State.shake=0;
 	}
 	
-	else
+	// the upper screen is redrawn from its retained copy when nothing changed
+	else {
+		Profiler::beginPhase(Profiler::PHASE_TOP_VIEW);
+		Renderer::beginRegion(Renderer::REGION_TOP_SCREEN, Rect(Point(0, 0), 256, 192));
 		renderTopView();
+		Renderer::endRegion(Renderer::REGION_TOP_SCREEN);
+		Profiler::endPhase(Profiler::PHASE_TOP_VIEW);
+	}
 	
 	// render lower screen
+	Profiler::beginPhase(Profiler::PHASE_MENU_VIEW);
+	Renderer::beginRegion(Renderer::REGION_LOWER_SCREEN, Rect(Point(0, 197), 256, 192));
 	renderMenuView();
+	Renderer::endRegion(Renderer::REGION_LOWER_SCREEN);
+	Profiler::endPhase(Profiler::PHASE_MENU_VIEW);
 	
 	// render special effects now
-	if (!renderSpecialEffects())
+	Profiler::beginPhase(Profiler::PHASE_EFFECTS);
+	bool effectsDone=renderSpecialEffects();
+	Profiler::endPhase(Profiler::PHASE_EFFECTS);
+	if (!effectsDone)
 		return;
 	
 	// that annoying black bar separating the top and bottom screens? yeah,
@@ -226,13 +268,20 @@ void Game::render() {
 	Renderer::drawRect(Rect(Point(0, 192, 20.0f), 256, 5), Color(0, 0, 0));
 	
 	// once everything static is drawn, parse the block
+	Profiler::beginPhase(Profiler::PHASE_PARSE);
 	ustring status=m_Parser->parse(shouldDrawTextBox());
 	
 	// new block ready for parsing
 	if (status!=STR_NULL) {
-		m_Parser->setBlock(m_Case->getBuffers()[status]);
+		// jumps are usually resolved when the case is loaded; otherwise, look up the block
+		Case::BlockHandle handle=m_Parser->getNextHandle();
+		if (handle!=Case::NULL_BLOCK)
+			m_Parser->setBlock(m_Case->getBlock(handle));
+		else
+			m_Parser->setBlock(m_Case->getBlock(status));
 		m_Parser->nextStep();
 	}
+	Profiler::endPhase(Profiler::PHASE_PARSE);
 	
 	// pause here and wait for next step
 	// while waiting, be sure to keep redrawing the already present screen
@@ -241,12 +290,17 @@ void Game::render() {
 		updateFlags();
 		
 		// also, if we're in cross examination, update the speaker
-		if (m_State.curExamination && !m_State.curExaminationPaused && m_Parser->getSpeaker()!="none")
-			m_Parser->setSpeaker(m_Case->getTestimonies()[m_State.curTestimony].speaker);
+		if (m_State.curExamination && !m_State.curExaminationPaused && m_Parser->getSpeaker()!="none") {
+			Case::Testimony *testimony=m_Case->getTestimony(m_State.curTestimony);
+			if (testimony)
+				m_Parser->setSpeaker(testimony->speaker);
+		}
 	}
 	
 	// check input state at this point
+	Profiler::beginPhase(Profiler::PHASE_INPUT);
 	checkInputState();
+	Profiler::endPhase(Profiler::PHASE_INPUT);
 }
 
 // handle keyboard event
@@ -387,7 +441,7 @@ void Game::onKeyboardEvent(SDL_KeyboardEvent *e) {
 			ustring target=character->getTalkOptions()[m_State.selectedTalkOption].second;
 			
 			// set this block
-			m_Parser->setBlock(m_Case->getBuffers()[target]);
+			m_Parser->setBlock(m_Case->getBlock(target));
 			m_Parser->nextStep();
 		}
 	}
@@ -512,7 +566,7 @@ void Game::onMouseEvent(SDL_MouseButtonEvent *e) {
 		// if the court record page is up, see if anything was clicked
 		if (flagged(STATE_EVIDENCE_PAGE) || flagged(STATE_PROFILES_PAGE)) {
 			// if we're in the add evidence animation's midpoint, toggle to progress it 
-			UI::Animation *anim=m_UI->getAnimation("an_add_evidence");
+			UI::Animation *anim=m_UI->getAnimation(Symbols::SYM_AN_ADD_EVIDENCE);
 			if (m_State.addEvidence!="none" && anim->current.x()==0) {
 				// move the animation along first
 				anim->current.setX(anim->current.x()-1);
@@ -666,26 +720,28 @@ void Game::registerAnimations() {
 void Game::checkInputState() {
 	// if the examination scene is shown, move the crosshairs
 	if (flagged(STATE_EXAMINE) || (flagged(STATE_CHECK_EVIDENCE_IMAGE) && m_State.contradictionImg!=STR_NULL)) {
-		// get the current keyboard state
-		Uint8 *keys=SDL_GetKeyState(NULL);
-		
 		int ex=m_State.examinePt.x();
 		int ey=m_State.examinePt.y();
 		
+		// the crosshairs move every frame while a key is held
+		if (Input::isKeyDown(SDLK_UP) || Input::isKeyDown(SDLK_DOWN) || 
+		    Input::isKeyDown(SDLK_LEFT) || Input::isKeyDown(SDLK_RIGHT))
+			Clock::busy();
+		
 		// move cursor up
-		if (keys[SDLK_UP] && ey!=0)
+		if (Input::isKeyDown(SDLK_UP) && ey!=0)
 			m_State.examinePt.setY(ey-1);
 		
 		// move cursor down
-		if (keys[SDLK_DOWN] && ey<256)
+		if (Input::isKeyDown(SDLK_DOWN) && ey<256)
 			m_State.examinePt.setY(ey+1);
 		
 		// move cursor left
-		if (keys[SDLK_LEFT] && ex!=0)
+		if (Input::isKeyDown(SDLK_LEFT) && ex!=0)
 			m_State.examinePt.setX(ex-1);
 		
 		// move cursor right
-		if (keys[SDLK_RIGHT] && ex<256)
+		if (Input::isKeyDown(SDLK_RIGHT) && ex<256)
 			m_State.examinePt.setX(ex+1);
 		
 		// get the mouse state
@@ -694,6 +750,8 @@ void Game::checkInputState() {
 		
 		// move the cursors if the first button is pressed
 		if ((state & SDL_BUTTON(1)) && (p.y()>=197+22 && p.y()<=391-22)) {
+			Clock::busy();
+			
 			// update position
 			m_State.examinePt.setX(p.x());
 			m_State.examinePt.setY(192-(391-p.y()));
@@ -780,17 +838,18 @@ void Game::setLocation(const ustring &locationId) {
 	
 	// don't play new music if requested
 	if (!m_State.continueMusic || !Audio::isMusicPlaying()) {
-		// fade out the current music, if any
-		Audio::haltMusic();
-		
-		// if this location has set music, then play it
+		// if this location has set music, then fade over to it
 		if (location->music!=STR_NULL)
-			Audio::playMusic(location->music);
+			Audio::playMusic(location->music, MUSIC_FADE_TIME);
+		
+		// otherwise, stop the current music, if any
+		else
+			Audio::haltMusic();
 	}
 	
 	// if this location has a trigger block, execute it now
 	if (location->triggerBlock!=STR_NULL) {
-		m_Parser->setBlock(m_Case->getBuffers()[location->triggerBlock]);
+		m_Parser->setBlock(m_Case->getBlock(location->triggerBlock));
 		m_Parser->nextStep();
 		
 		// clear the trigger
@@ -799,6 +858,163 @@ void Game::setLocation(const ustring &locationId) {
 	
 	// set the new location
 	m_State.currentLocation=locationId;
+	
+	// decode the sound effects of this location's sprites
+	warmLocationEffects(locationId);
+	
+	// load images for this location, and for those the player can move to next
+	prefetchLocation(locationId);
+	for (int i=0; i<location->moveLocations.size(); i++) {
+		prefetchLocation(location->moveLocations[i]);
+		
+		// as well as their music
+		Case::Location *next=m_Case->getLocation(location->moveLocations[i]);
+		if (next && next->music!=STR_NULL)
+			Audio::preloadMusic(next->music);
+	}
+}
+
+// start loading the images of a location
+void Game::prefetchLocation(const ustring &locationId) {
+	// nothing to do unless images are loaded lazily
+	if (Assets::g_Deferred.empty())
+		return;
+	
+	Case::Location *location=m_Case->getLocation(locationId);
+	if (!location)
+		return;
+	
+	// backgrounds for each state, or sprites for animated backgrounds
+	for (std::map<ustring, ustring>::iterator it=location->states.begin(); it!=location->states.end(); ++it) {
+		ustring bgId=(*it).second;
+		if (bgId.size()>0 && bgId[0]=='&') {
+			Character *bg=m_Case->getCharacter(bgId.substr(1, bgId.size()));
+			if (bg)
+				Assets::prefetchSprite(bg->getSprite());
+		}
+		
+		else if (m_Case->getBackground(bgId))
+			Assets::prefetch(m_Case->getBackground(bgId)->texture);
+	}
+	
+	// the character at this location
+	Character *character=m_Case->getCharacter(location->character);
+	if (character)
+		Assets::prefetchSprite(character->getSprite());
+}
+
+// decode sound effects used by a location's sprites
+void Game::warmLocationEffects(const ustring &locationId) {
+	Case::Location *location=m_Case->getLocation(locationId);
+	if (!location)
+		return;
+	
+	// the character at this location, and any animated backgrounds
+	std::vector<Character*> sprites;
+	sprites.push_back(m_Case->getCharacter(location->character));
+	for (std::map<ustring, ustring>::iterator it=location->states.begin(); it!=location->states.end(); ++it) {
+		ustring bgId=(*it).second;
+		if (bgId.size()>0 && bgId[0]=='&')
+			sprites.push_back(m_Case->getCharacter(bgId.substr(1, bgId.size())));
+	}
+	
+	for (int i=0; i<sprites.size(); i++) {
+		if (!sprites[i])
+			continue;
+		
+		AnimationMap anims=sprites[i]->getSprite()->getAnimations();
+		for (AnimationMapIter it=anims.begin(); it!=anims.end(); ++it) {
+			for (int j=0; j<(*it).second.frames.size(); j++) {
+				if ((*it).second.frames[j].sfx!="")
+					Audio::warmEffect((*it).second.frames[j].sfx);
+			}
+		}
+	}
+}
+
+// start loading the images of blocks that may follow
+void Game::prefetchScript(const Script::Program &block) {
+	Case::Dependencies deps;
+	m_Case->collectDependencies(block, deps);
+	
+	// walk the blocks that can follow, nearest first
+	std::set<Case::BlockHandle> visited;
+	std::vector<Case::BlockHandle> current=deps.blocks;
+	for (int depth=0; depth<PREFETCH_DEPTH && !current.empty() && visited.size()<PREFETCH_MAX_BLOCKS; depth++) {
+		std::vector<Case::BlockHandle> next;
+		for (int i=0; i<current.size() && visited.size()<PREFETCH_MAX_BLOCKS; i++) {
+			if (!visited.insert(current[i]).second)
+				continue;
+			
+			const Case::Dependencies &blockDeps=m_Case->getDependencies(current[i]);
+			deps.locations.insert(deps.locations.end(), blockDeps.locations.begin(), blockDeps.locations.end());
+			deps.characters.insert(deps.characters.end(), blockDeps.characters.begin(), blockDeps.characters.end());
+			deps.evidence.insert(deps.evidence.end(), blockDeps.evidence.begin(), blockDeps.evidence.end());
+			deps.images.insert(deps.images.end(), blockDeps.images.begin(), blockDeps.images.end());
+			deps.music.insert(deps.music.end(), blockDeps.music.begin(), blockDeps.music.end());
+			next.insert(next.end(), blockDeps.blocks.begin(), blockDeps.blocks.end());
+		}
+		
+		current=next;
+	}
+	
+	// music that is played, including that of locations
+	for (int i=0; i<deps.music.size(); i++)
+		Audio::preloadMusic(deps.music[i]);
+	for (int i=0; i<deps.locations.size(); i++) {
+		Case::Location *location=m_Case->getLocation(deps.locations[i]);
+		if (location && location->music!=STR_NULL)
+			Audio::preloadMusic(location->music);
+	}
+	
+	// the rest are images, which are only loaded lazily
+	if (Assets::g_Deferred.empty())
+		return;
+	
+	// backgrounds and sprites of locations, including what can be examined there
+	std::set<ustring> seen;
+	for (int i=0; i<deps.locations.size(); i++) {
+		if (!seen.insert(deps.locations[i]).second)
+			continue;
+		
+		prefetchLocation(deps.locations[i]);
+		
+		Case::Location *location=m_Case->getLocation(deps.locations[i]);
+		if (location) {
+			for (int j=0; j<location->hotspots.size(); j++) {
+				const Case::Dependencies &spotDeps=m_Case->getDependencies(location->hotspots[j].blockHandle);
+				deps.characters.insert(deps.characters.end(), spotDeps.characters.begin(), spotDeps.characters.end());
+				deps.evidence.insert(deps.evidence.end(), spotDeps.evidence.begin(), spotDeps.evidence.end());
+				deps.images.insert(deps.images.end(), spotDeps.images.begin(), spotDeps.images.end());
+			}
+		}
+	}
+	
+	// sprites of characters that appear
+	seen.clear();
+	for (int i=0; i<deps.characters.size(); i++) {
+		Character *character=m_Case->getCharacter(deps.characters[i]);
+		if (seen.insert(deps.characters[i]).second && character)
+			Assets::prefetchSprite(character->getSprite());
+	}
+	
+	// evidence that is shown or added
+	seen.clear();
+	for (int i=0; i<deps.evidence.size(); i++) {
+		Case::Evidence *evidence=m_Case->getEvidence(deps.evidence[i]);
+		if (seen.insert(deps.evidence[i]).second && evidence) {
+			Assets::prefetch(evidence->texture);
+			Assets::prefetch(evidence->thumb);
+		}
+	}
+	
+	// images that are displayed
+	seen.clear();
+	for (int i=0; i<deps.images.size(); i++) {
+		Case::Image *image=m_Case->getImage(deps.images[i]);
+		if (seen.insert(deps.images[i]).second && image)
+			Assets::prefetch(image->texture);
+	}
 }
 
 // set the evidence to draw on top screen
@@ -1040,7 +1256,7 @@ void Game::renderTopView() {
 		
 		// otherwise, fall back on the stock title screen set
 		else {
-			Renderer::drawImage(Point(0, 0), "stock_title");
+			Renderer::drawImage(Point(0, 0), Symbols::SYM_STOCK_TITLE);
 			
 			// get the case overview
 			Case::Overview overview=m_Case->getOverview();
@@ -1167,7 +1383,7 @@ void Game::renderTopView() {
 	// draw the green court record bar, if needed
 	if (flagged(STATE_COURT_GREEN_BAR) && m_State.exclamation=="none") {
 		// first, draw the border
-		Renderer::drawImage(Point(170, 8, Z_ANIM_SPRITE+0.1f), "tc_court_bar_border");
+		Renderer::drawImage(Point(170, 8, Z_ANIM_SPRITE+0.1f), Symbols::SYM_TC_COURT_BAR_BORDER);
 		
 		// now animate the green bar
 		m_UI->animateGreenBar("an_court_green_bar");
@@ -1175,7 +1391,7 @@ void Game::renderTopView() {
 	
 	// if we are required to present evidence, draw elements now
 	if (m_State.requestingEvidence || m_State.requestingAnswer)
-		Renderer::drawImage(Point(0, 168, Z_ANSWER_BAR), "tc_answer_bar");
+		Renderer::drawImage(Point(0, 168, Z_ANSWER_BAR), Symbols::SYM_TC_ANSWER_BAR);
 	
 	// if there is shown evidence, draw it as well
 	if (m_State.shownEvidence!=STR_NULL) {
@@ -1232,7 +1448,7 @@ void Game::renderMenuView() {
 	
 	// default to background
 	else
-		Renderer::drawImage(Point(0, 197), "court_overview_g");
+		Renderer::drawImage(Point(0, 197), Symbols::SYM_COURT_OVERVIEW_G);
 	
 	// draw the evidence page
 	if (flagged(STATE_EVIDENCE_PAGE))
@@ -1288,7 +1504,7 @@ void Game::renderMenuView() {
 	
 	// draw next button in case of dialog
 	else if (flagged(STATE_NEXT_BTN)) {
-		m_UI->drawButton("an_next_btn");
+		m_UI->drawButton(Symbols::SYM_AN_NEXT_BTN);
 		
 		// only animate the arrow if the dialogue is done, or if the dialogue
 		// can be skipped
@@ -1307,7 +1523,7 @@ void Game::renderMenuView() {
 			draw=false;
 		
 		if (draw)
-			m_UI->drawAnimation("an_button_arrow_next");
+			m_UI->drawAnimation(Symbols::SYM_AN_BUTTON_ARROW_NEXT);
 	}
 	
 	// draw controls, if needed
@@ -1326,8 +1542,8 @@ void Game::renderMenuView() {
 	// draw testimony movement buttons
 	else if (flagged(STATE_CROSS_EXAMINE_BTNS)) {
 		// first, draw the two testimony movement buttons
-		m_UI->drawButton("an_x_examine_btn_left");
-		m_UI->drawButton("an_x_examine_btn_right");
+		m_UI->drawButton(Symbols::SYM_AN_X_EXAMINE_BTN_LEFT);
+		m_UI->drawButton(Symbols::SYM_AN_X_EXAMINE_BTN_RIGHT);
 		
 		// don't draw the left arrow if there is not testimony piece
 		// that precedes this one
@@ -1342,7 +1558,7 @@ void Game::renderMenuView() {
 	
 	// top everything off with scanlines, except when presenting an image contradiction
 	if (!flagged(STATE_CHECK_EVIDENCE_IMAGE) || (flagged(STATE_CHECK_EVIDENCE_IMAGE) && m_State.contradictionImg==STR_NULL))
-		Renderer::drawImage(Point(0, 197, Z_SCANLINES), "scanlines_overlay");
+		Renderer::drawImage(Point(0, 197, Z_SCANLINES), Symbols::SYM_SCANLINES_OVERLAY);
 	
 	// draw the top and lower border bar
 	Renderer::drawImage(Point(0, 197, Z_BARS), "tc_top_bar"+append);
@@ -1352,36 +1568,36 @@ void Game::renderMenuView() {
 	if (m_State.fadeOut!="gui") {
 		// draw titles bars, if needed
 		if (flagged(STATE_EVIDENCE_PAGE) || flagged(STATE_EVIDENCE_INFO_PAGE))
-			Renderer::drawImage(Point(0, 206, Z_SCREEN_BARS), "tc_evidence_bar");
+			Renderer::drawImage(Point(0, 206, Z_SCREEN_BARS), Symbols::SYM_TC_EVIDENCE_BAR);
 		if (flagged(STATE_PROFILES_PAGE) || flagged(STATE_PROFILE_INFO_PAGE))
-			Renderer::drawImage(Point(0, 206, Z_SCREEN_BARS), "tc_profiles_bar");
+			Renderer::drawImage(Point(0, 206, Z_SCREEN_BARS), Symbols::SYM_TC_PROFILES_BAR);
 		
 		// draw activated buttons
 		if (flagged(STATE_COURT_REC_BTN))
 			m_UI->drawButton("an_court_rec_btn"+append);
 		else if (flagged(STATE_PRESENT_BTN))
-			m_UI->drawButton("an_present_item_btn");
+			m_UI->drawButton(Symbols::SYM_AN_PRESENT_ITEM_BTN);
 		else if (flagged(STATE_EVIDENCE_BTN))
-			m_UI->drawButton("an_evidence_btn");
+			m_UI->drawButton(Symbols::SYM_AN_EVIDENCE_BTN);
 		else if (flagged(STATE_PROFILES_BTN))
-			m_UI->drawButton("an_profiles_btn");
+			m_UI->drawButton(Symbols::SYM_AN_PROFILES_BTN);
 		
 		if (flagged(STATE_PRESS_BTN))
-			m_UI->drawButton("an_press_btn");
+			m_UI->drawButton(Symbols::SYM_AN_PRESS_BTN);
 		
 		// check evidence or confirm button, if needed
 		if (flagged(STATE_CHECK_BTN))
-			m_UI->drawButton("an_check_btn");
+			m_UI->drawButton(Symbols::SYM_AN_CHECK_BTN);
 		else if (flagged(STATE_CONFIRM_BTN))
-			m_UI->drawButton("an_confirm_btn");
+			m_UI->drawButton(Symbols::SYM_AN_CONFIRM_BTN);
 	
 		// draw the present evidence button, centered on the upper portion of the lower screen
 		if (flagged(STATE_PRESENT_TOP_BTN))
-			m_UI->drawButton("an_present_top_btn");
+			m_UI->drawButton(Symbols::SYM_AN_PRESENT_TOP_BTN);
 		
 		// draw examine button if needed
 		if (flagged(STATE_EXAMINE) && canExamineRegion())
-			m_UI->drawButton("an_examine_btn_thin");
+			m_UI->drawButton(Symbols::SYM_AN_EXAMINE_BTN_THIN);
 		
 		// draw the back button
 		if (flagged(STATE_BACK_BTN))
@@ -1447,7 +1663,7 @@ bool Game::renderSpecialEffects() {
 				}
 				
 				else
-					m_Parser->setBlock(m_Case->getBuffers()[m_State.queuedBlock]);
+					m_Parser->setBlock(m_Case->getBlock(m_State.queuedBlock));
 				
 				m_Parser->nextStep();
 				m_State.queuedBlock=STR_NULL;
@@ -1558,7 +1774,7 @@ bool Game::renderSpecialEffects() {
 			// execute any queued cross examination blocks
 			if (m_State.curExamination && m_State.queuedBlock!=STR_NULL) {
 				m_State.curExaminationPaused=true;
-				m_Parser->setBlock(m_Case->getBuffers()[m_State.queuedBlock]);
+				m_Parser->setBlock(m_Case->getBlock(m_State.queuedBlock));
 				m_Parser->nextStep();
 				
 				m_State.queuedBlock=STR_NULL;
@@ -1675,7 +1891,7 @@ void Game::renderTextBox() {
 		shift=-24;
 	
 	// draw the actual text box body
-	Renderer::drawImage(Point(0, 128+shift, Z_TEXT_BOX), "tc_text_box");
+	Renderer::drawImage(Point(0, 128+shift, Z_TEXT_BOX), Symbols::SYM_TC_TEXT_BOX);
 	
 	// character speaking (ignore speaker during "add evidence" animations)
 	if (speaker!="none" && speaker!="" && m_Case->getCharacter(speaker) && m_State.addEvidence=="none") {
@@ -1688,7 +1904,7 @@ void Game::renderTextBox() {
 	
 	// narration or no one speaking
 	else
-		Renderer::drawImage(Point(0, 128+shift, Z_TEXT_BOX_TAG), Textures::queryTexture("tc_text_box_border"));
+		Renderer::drawImage(Point(0, 128+shift, Z_TEXT_BOX_TAG), Textures::queryTexture(Symbols::SYM_TC_TEXT_BOX_BORDER));
 	
 	// see if the two speakers vary
 	if (m_Parser->getSpeaker()!=speaker)
@@ -1725,7 +1941,7 @@ void Game::renderControls(int flags) {
 	int sy1=y, sy2=y+14;
 	
 	if ((flags & CONTROLS_EXAMINE) || (flags & CONTROLS_ALL)) {
-		Renderer::drawImage(Point(8, y, Z_GUI_BTN), "tc_examine_btn");
+		Renderer::drawImage(Point(8, y, Z_GUI_BTN), Symbols::SYM_TC_EXAMINE_BTN);
 		
 		// set high light coordinates if this is selected
 		if (m_State.selectedControl==0) {
@@ -1737,7 +1953,7 @@ void Game::renderControls(int flags) {
 	}
 	
 	if ((flags & CONTROLS_MOVE) || (flags & CONTROLS_ALL)) {
-		Renderer::drawImage(Point(134, y, Z_GUI_BTN), "tc_move_btn");
+		Renderer::drawImage(Point(134, y, Z_GUI_BTN), Symbols::SYM_TC_MOVE_BTN);
 		
 		// set high light coordinates if this is selected
 		if (m_State.selectedControl==1) {
@@ -1749,7 +1965,7 @@ void Game::renderControls(int flags) {
 	}
 	
 	if ((flags & CONTROLS_TALK) || (flags & CONTROLS_ALL)) {
-		Renderer::drawImage(Point(8, y+26+36), "tc_talk_btn");
+		Renderer::drawImage(Point(8, y+26+36), Symbols::SYM_TC_TALK_BTN);
 		
 		// set high light coordinates if this is selected
 		if (m_State.selectedControl==2) {
@@ -1761,7 +1977,7 @@ void Game::renderControls(int flags) {
 	}
 	
 	if ((flags & CONTROLS_PRESENT) || (flags & CONTROLS_ALL)) {
-		Renderer::drawImage(Point(134, y+26+36), "tc_present_btn");
+		Renderer::drawImage(Point(134, y+26+36), Symbols::SYM_TC_PRESENT_BTN);
 		
 		// set high light coordinates if this is selected
 		if (m_State.selectedControl==3) {
@@ -1773,10 +1989,10 @@ void Game::renderControls(int flags) {
 	}
 	
 	// draw selection box
-	Renderer::drawImage(Point(sx1, sy1), "tc_select_tl");
-	Renderer::drawImage(Point(sx1, sy2), "tc_select_bl");
-	Renderer::drawImage(Point(sx2, sy2), "tc_select_br");
-	Renderer::drawImage(Point(sx2, sy1), "tc_select_tr");
+	Renderer::drawImage(Point(sx1, sy1), Symbols::SYM_TC_SELECT_TL);
+	Renderer::drawImage(Point(sx1, sy2), Symbols::SYM_TC_SELECT_BL);
+	Renderer::drawImage(Point(sx2, sy2), Symbols::SYM_TC_SELECT_BR);
+	Renderer::drawImage(Point(sx2, sy1), Symbols::SYM_TC_SELECT_TR);
 }
 
 // render the courtroom overview
@@ -1807,7 +2023,7 @@ void Game::renderCourtroomOverview() {
 	}
 	
 	// draw the judge
-	Renderer::drawImage(Point(121, 68, 0.1f), "overview_judge");
+	Renderer::drawImage(Point(121, 68, 0.1f), Symbols::SYM_OVERVIEW_JUDGE);
 	
 	// draw jury
 	m_Case->getCharacter("jury_left")->getSprite()->animate(Point(0, 59, 0.1f));
@@ -1933,7 +2149,7 @@ void Game::onXExamineButtonClicked(const ustring &id) {
 			m_State.curTestimonyPiece=0;
 			
 			// now set the ending block
-			m_Parser->setBlock(m_Case->getBuffers()[testimony->xExamineEndBlock]);
+			m_Parser->setBlock(m_Case->getBlock(testimony->xExamineEndHandle));
 			
 			m_Parser->nextStep();
 		}
@@ -1995,7 +2211,7 @@ void Game::onTopRightButtonClicked(const ustring &id) {
 			for (int i=0; i<presentables.size(); i++) {
 				if (presentables[i].first==id) {
 					// set the block to use
-					m_Parser->setBlock(m_Case->getBuffers()[presentables[i].second]);
+					m_Parser->setBlock(m_Case->getBlock(presentables[i].second));
 					m_Parser->nextStep();
 					
 					found=true;
@@ -2004,7 +2220,7 @@ void Game::onTopRightButtonClicked(const ustring &id) {
 			
 			// if the presentable evidence was not found, then fall back on appropriate block
 			if (!found && character->getBadPresentableBlock()!=STR_NULL) {
-				m_Parser->setBlock(m_Case->getBuffers()[character->getBadPresentableBlock()]);
+				m_Parser->setBlock(m_Case->getBlock(character->getBadPresentableBlock()));
 				m_Parser->nextStep();
 			}
 			
@@ -2245,12 +2461,12 @@ void Game::onBottomRightButtonClicked(const ustring &id) {
 			// see if the click was in the contradiction region
 			if (Utils::pointInRect(m_State.examinePt, m_State.contradictionRegion)) {
 				// the user got it right, so follow up on the correct block
-				m_Parser->setBlock(m_Case->getBuffers()[vec[0]]);
+				m_Parser->setBlock(m_Case->getBlock(vec[0]));
 			}
 			
 			// the user is wrong, nice try though
 			else
-				m_Parser->setBlock(m_Case->getBuffers()[vec[1]]);
+				m_Parser->setBlock(m_Case->getBlock(vec[1]));
 			
 			// reset our variables relating to this image contradiction
 			m_State.contradictionImg=STR_NULL;
@@ -2299,12 +2515,12 @@ void Game::onPresentCenterClicked(const ustring &id) {
 		// now, we compare the correct evidence with what is presented
 		if (id==vec[0]) {
 			// set the next block to follow the correct choice
-			m_Parser->setBlock(m_Case->getBuffers()[vec[1]]);
+			m_Parser->setBlock(m_Case->getBlock(vec[1]));
 		}
 		
 		// otherwise, the player screwed up
 		else
-			m_Parser->setBlock(m_Case->getBuffers()[vec[2]]);
+			m_Parser->setBlock(m_Case->getBlock(vec[2]));
 		
 		// move along to set block
 		m_Parser->nextStep();
@@ -2460,7 +2676,7 @@ void Game::onTalkSceneClicked(const ustring &button) {
 		target=character->getTalkOptions()[index-1].second;
 	
 	// move along
-	m_Parser->setBlock(m_Case->getBuffers()[target]);
+	m_Parser->setBlock(m_Case->getBlock(target));
 	m_Parser->nextStep();
 }
 
@@ -2667,12 +2883,12 @@ void Game::onExamineThing(const Point &p) {
 	
 	// iterate over hotspots and see if one of them was clicked
 	for (int i=0; i<location->hotspots.size(); i++) {
-		Case::Hotspot hspot=location->hotspots[i];
+		const Case::Hotspot &hspot=location->hotspots[i];
 		
 		// see if the click occured in this area
 		if (Utils::pointInRect(p, hspot.rect)) {
-			if (m_Case->getBuffers().find(hspot.block)!=m_Case->getBuffers().end()) {
-				m_Parser->setBlock(m_Case->getBuffers()[hspot.block]);
+			if (hspot.blockHandle!=Case::NULL_BLOCK) {
+				m_Parser->setBlock(m_Case->getBlock(hspot.blockHandle));
 				m_Parser->nextStep();
 			}
 		}
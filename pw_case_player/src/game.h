@@ -32,6 +32,12 @@
 
 class Game;
 
+/// How many jumps ahead of the current block assets are prefetched
+const int PREFETCH_DEPTH=3;
+
+/// Maximum amount of blocks whose assets are prefetched at once
+const int PREFETCH_MAX_BLOCKS=32;
+
 /// Flags that define what should be drawn every cycle
 enum GameFlags {
 	STATE_QUEUED=			1 << 0,  ///< Specifies that the flags are queued to be drawn
@@ -155,7 +161,7 @@ struct _GameState {
 	bool curExaminationPaused; // for temporarily breaking away from cross examinations
 	
 	// special effects
-	int shake;
+	int shake; // time left to shake the screen, in milliseconds
 	ustring whiteFlash;
 	ustring alphaDecay;
 	ustring fadeOut;
@@ -315,6 +321,23 @@ class Game {
 		*/
 		void setLocation(const ustring &location);
 		
+		/** Start loading the images of a location in the background
+		  * \param location The ID of the location
+		*/
+		void prefetchLocation(const ustring &location);
+		
+		/** Decode the sound effects that sprites at a location play
+		  * \param location The ID of the location
+		*/
+		void warmLocationEffects(const ustring &location);
+		
+		/** Start loading the images and music that the blocks reachable from a block refer to.
+		  * Blocks are followed through jumps, talk options, presentables, location 
+		  * triggers and hotspots, up to PREFETCH_DEPTH jumps away.
+		  * \param block The compiled block that is about to be executed
+		*/
+		void prefetchScript(const Script::Program &block);
+		
 		/** Set the evidence to draw on top screen
 		  * \param id The ID of the evidence
 		  * \param pos Which place on the screen should the evidence be drawn at
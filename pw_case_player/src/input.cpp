@@ -0,0 +1,177 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// input.cpp: implementation of Input namespace
+
+#include <cstring>
+
+#include "clock.h"
+#include "input.h"
+
+namespace Input {
+	bool g_Recording=false;
+	Log g_Log;
+	
+	// tracked device state
+	bool g_Keys[SDLK_LAST];
+	int g_MouseX=0;
+	int g_MouseY=0;
+	Uint8 g_Buttons=0;
+}
+
+// update the tracked device state
+void Input::update(const SDL_Event &e) {
+	switch(e.type) {
+		case SDL_KEYDOWN:
+		case SDL_KEYUP: g_Keys[e.key.keysym.sym]=(e.type==SDL_KEYDOWN); break;
+		
+		case SDL_MOUSEMOTION: {
+			g_MouseX=e.motion.x;
+			g_MouseY=e.motion.y;
+		}; break;
+		
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP: {
+			g_MouseX=e.button.x;
+			g_MouseY=e.button.y;
+			
+			if (e.type==SDL_MOUSEBUTTONDOWN)
+				g_Buttons |= SDL_BUTTON(e.button.button);
+			else
+				g_Buttons &= ~SDL_BUTTON(e.button.button);
+		}; break;
+		
+		default: break;
+	}
+}
+
+// see if a key is held down
+bool Input::isKeyDown(SDLKey key) {
+	return g_Keys[key];
+}
+
+// get the location of the mouse pointer
+Point Input::getMouseLocation(Uint8 *buttons) {
+	if (buttons)
+		(*buttons)=g_Buttons;
+	return Point(g_MouseX, g_MouseY);
+}
+
+// start recording events
+void Input::startRecording(Uint32 seed, Uint32 frameTime) {
+	g_Log.seed=seed;
+	g_Log.frameTime=frameTime;
+	g_Log.frames=0;
+	g_Log.events.clear();
+	
+	g_Recording=true;
+}
+
+// record an event
+void Input::record(Uint32 frame, const SDL_Event &e) {
+	if (g_Recording && isRecordable(e.type))
+		g_Log.events.push_back(toEvent(frame, Clock::ticks(), e));
+}
+
+// stop recording events
+void Input::stopRecording(Uint32 frames) {
+	g_Log.frames=frames;
+	g_Recording=false;
+}
+
+// see if an event type should be recorded
+bool Input::isRecordable(Uint8 type) {
+	switch(type) {
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+		case SDL_MOUSEMOTION:
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+		case SDL_QUIT: return true;
+		
+		default: return false;
+	}
+}
+
+// convert an sdl event to its recorded form
+Input::Event Input::toEvent(Uint32 frame, Uint32 time, const SDL_Event &e) {
+	Event ev;
+	ev.frame=frame;
+	ev.time=time;
+	ev.type=e.type;
+	ev.button=0;
+	ev.key=0;
+	ev.x=ev.y=0;
+	
+	switch(e.type) {
+		case SDL_KEYDOWN:
+		case SDL_KEYUP: ev.key=e.key.keysym.sym; break;
+		
+		case SDL_MOUSEMOTION: {
+			ev.x=e.motion.x;
+			ev.y=e.motion.y;
+		}; break;
+		
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP: {
+			ev.button=e.button.button;
+			ev.x=e.button.x;
+			ev.y=e.button.y;
+		}; break;
+		
+		default: break;
+	}
+	
+	return ev;
+}
+
+// convert a recorded event back to an sdl event
+SDL_Event Input::toSDLEvent(const Event &ev) {
+	SDL_Event e;
+	memset(&e, 0, sizeof(SDL_Event));
+	e.type=ev.type;
+	
+	switch(ev.type) {
+		case SDL_KEYDOWN:
+		case SDL_KEYUP: {
+			e.key.type=ev.type;
+			e.key.state=(ev.type==SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED);
+			e.key.keysym.sym=(SDLKey) ev.key;
+		}; break;
+		
+		case SDL_MOUSEMOTION: {
+			e.motion.type=ev.type;
+			e.motion.x=ev.x;
+			e.motion.y=ev.y;
+		}; break;
+		
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP: {
+			e.button.type=ev.type;
+			e.button.button=ev.button;
+			e.button.state=(ev.type==SDL_MOUSEBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED);
+			e.button.x=ev.x;
+			e.button.y=ev.y;
+		}; break;
+		
+		default: break;
+	}
+	
+	return e;
+}
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// input.h: input device state, recording and replay
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <vector>
+#include "SDL.h"
+
+#include "common.h"
+
+/** Namespace for input device state.
+  * Game logic asks this namespace for the keyboard and mouse state, instead of 
+  * polling SDL. The state is only changed by the events that are passed to 
+  * Input::update(), so that a recorded stream of events reproduces it exactly 
+  * when played back.
+*/
+namespace Input {
+
+/// A single recorded input event, stored in a compact form
+struct _Event {
+	Uint32 frame;	///< Frame the event was handled in
+	Uint32 time;	///< Game clock time at that frame
+	Uint8 type;	///< SDL event type
+	Uint8 button;	///< Mouse button, or 0 for keyboard events
+	Uint16 key;	///< Key symbol, or 0 for mouse events
+	Sint16 x;	///< Mouse x coordinate
+	Sint16 y;	///< Mouse y coordinate
+};
+typedef struct _Event Event;
+
+/// A recorded play session
+struct _Log {
+	Uint32 seed;		///< Seed of the random number generator
+	Uint32 frameTime;	///< Game time that passed each frame, in milliseconds
+	Uint32 frames;		///< Total amount of frames in the session
+	std::vector<Event> events; ///< Events in the order they were handled
+};
+typedef struct _Log Log;
+
+/// Flag whether or not events are currently being recorded
+extern bool g_Recording;
+
+/// The session being recorded
+extern Log g_Log;
+
+/** Update the tracked device state with an event
+  * \param e The event that was handled
+*/
+void update(const SDL_Event &e);
+
+/** See if a key is held down
+  * \param key The SDL key symbol
+  * \return <b>true</b> if held down, <b>false</b> otherwise
+*/
+bool isKeyDown(SDLKey key);
+
+/** Get the location of the mouse pointer
+  * \param buttons Optional pointer to store the mouse button state in
+  * \return The location of the mouse pointer
+*/
+Point getMouseLocation(Uint8 *buttons=NULL);
+
+/** Start recording events
+  * \param seed Seed of the random number generator
+  * \param frameTime Game time that passes each frame, in milliseconds
+*/
+void startRecording(Uint32 seed, Uint32 frameTime);
+
+/** Record an event, if recording is enabled
+  * \param frame The frame the event is handled in
+  * \param e The event
+*/
+void record(Uint32 frame, const SDL_Event &e);
+
+/** Stop recording events
+  * \param frames Total amount of frames that were run
+*/
+void stopRecording(Uint32 frames);
+
+/** See if an event type should be recorded
+  * \param type The SDL event type
+  * \return <b>true</b> if the event affects the game, <b>false</b> otherwise
+*/
+bool isRecordable(Uint8 type);
+
+/** Convert an SDL event to its recorded form
+  * \param frame The frame the event is handled in
+  * \param time Game clock time at that frame
+  * \param e The SDL event
+  * \return The recorded event
+*/
+Event toEvent(Uint32 frame, Uint32 time, const SDL_Event &e);
+
+/** Convert a recorded event back to an SDL event
+  * \param ev The recorded event
+  * \return The SDL event
+*/
+SDL_Event toSDLEvent(const Event &ev);
+
+}; // namespace Input
+
+#endif
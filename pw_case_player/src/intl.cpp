@@ -36,7 +36,7 @@ std::map<ustring, ustring> g_Translations;
 // set the language to use
 bool Intl::setLanguage(const ustring &str) {
 	// set the right path
-	ustring path=".temp/data/lang/";
+	ustring path="data/lang/";
 	path+=str;
 	path+=".trs";
 	
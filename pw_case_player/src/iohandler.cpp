@@ -22,22 +22,54 @@
 #include <archive.h>
 #include <archive_entry.h>
 #include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <libxml/parser.h>
 #include <sstream>
+#include <sys/stat.h>
 #include "SDL_image.h"
 #include "SDL_rotozoom.h"
 
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
 #include "application.h"
+#include "assets.h"
 #include "audio.h"
+#include "decodequeue.h"
 #include "font.h"
 #include "iohandler.h"
+#include "script.h"
 #include "textparser.h"
 #include "utilities.h"
+#include "vfs.h"
+
+// decode an image from a mapped file, queue it for decoding, or only record
+// where it is when loading lazily
+static GLuint loadImage(IO::MappedFile &mf, const ustring &id, int alpha, DecodeQueue *queue, bool lazy, 
+			Textures::Category category) {
+	GLuint tex;
+	if (lazy)
+		tex=Assets::deferTexture(id, mf, alpha);
+	
+	else if (queue)
+		tex=queue->push(id, mf, alpha);
+	
+	else
+		tex=Textures::createTexture(id, IO::readImage(mf), alpha);
+	
+	Textures::setCategory(tex, category);
+	return tex;
+}
 
-// unpack the resource file
-bool IO::unpackResourceFile(const ustring &path) {
+// load the resource file into memory
+bool IO::loadResourceFile(const ustring &path) {
 	FILE *f=fopen(path.c_str(), "rb");
 	if (!f) {
 		Utils::alert("Unable to open resource file: "+path);
@@ -53,35 +85,51 @@ bool IO::unpackResourceFile(const ustring &path) {
 	
 	// open the archive
 	if (archive_read_open_FILE(ar, f)!=ARCHIVE_OK) {
+		archive_read_finish(ar);
 		fclose(f);
 		return false;
 	}
 	
-	// create a new file entry handle
-	struct archive_entry *entry=archive_entry_new();
+	// entry handle, owned by the archive
+	struct archive_entry *entry;
 	
-	// make our temporary directory
-	Utils::FS::makeDir(".temp");
-	
-	// read each file, and extract it
+	// read each regular file straight into memory
+	int count=0;
 	while(archive_read_next_header(ar, &entry)==ARCHIVE_OK) {
-		archive_read_extract(ar, entry, 0);
-		archive_read_data_skip(ar);
+		if (!S_ISREG(archive_entry_mode(entry))) {
+			archive_read_data_skip(ar);
+			continue;
+		}
+		
+		int size=archive_entry_size(entry);
+		char *buffer=new char[size];
+		
+		// read the entry contents; archive_read_data may return less than requested
+		int read=0;
+		while(read<size) {
+			int amount=archive_read_data(ar, buffer+read, size-read);
+			if (amount<=0)
+				break;
+			
+			read+=amount;
+		}
+		
+		if (read!=size) {
+			Utils::alert("Unable to read '"+ustring(archive_entry_pathname(entry))+"' from resource file: "+path);
+			delete [] buffer;
+			continue;
+		}
+		
+		VFS::addFile(archive_entry_pathname(entry), buffer, size);
+		count++;
 	}
 	
-	// windows needs to have an absolute path
-	ustring to=".temp";
-#ifdef __WIN32__
-	to+="\\data";
-#endif
-	
-	// move our data directory, to the hidden temporary directory
-	Utils::FS::move("data", to);
-	
 	// wrap up
 	archive_read_finish(ar);
 	fclose(f);
 	
+	std::cout << "Loaded " << count << " file(s) from resource file.\n";
+	
 	return true;
 }
 
@@ -323,13 +371,73 @@ bool IO::loadGameState(GameState &gstate, int number) {
 	return true;
 }
 
-// load a case from file
-bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
-	// open requested file
+// save recorded input to file
+bool IO::saveInputLog(const ustring &path, const Input::Log &log) {
+	FILE *f=fopen(path.c_str(), "wb");
+	if (!f)
+		return false;
+	
+	// write magic number and version
+	fwrite(&REC_FILE_MAGIC_NUM, sizeof(int), 1, f);
+	fwrite(&REC_VERSION, sizeof(int), 1, f);
+	
+	// write the session parameters
+	fwrite(&log.seed, sizeof(Uint32), 1, f);
+	fwrite(&log.frameTime, sizeof(Uint32), 1, f);
+	fwrite(&log.frames, sizeof(Uint32), 1, f);
+	
+	// and the events themselves, in one go
+	int count=log.events.size();
+	fwrite(&count, sizeof(int), 1, f);
+	if (count>0)
+		fwrite(&log.events[0], sizeof(Input::Event), count, f);
+	
+	fclose(f);
+	return true;
+}
+
+// load recorded input from file
+bool IO::loadInputLog(const ustring &path, Input::Log &log) {
 	FILE *f=fopen(path.c_str(), "rb");
 	if (!f)
 		return false;
 	
+	// verify magic number and version
+	int magic=0, version=0;
+	if (fread(&magic, sizeof(int), 1, f)!=1 || fread(&version, sizeof(int), 1, f)!=1 ||
+	    magic!=REC_FILE_MAGIC_NUM || version!=REC_VERSION) {
+		fclose(f);
+		return false;
+	}
+	
+	// read the session parameters
+	int count=0;
+	if (fread(&log.seed, sizeof(Uint32), 1, f)!=1 ||
+	    fread(&log.frameTime, sizeof(Uint32), 1, f)!=1 ||
+	    fread(&log.frames, sizeof(Uint32), 1, f)!=1 ||
+	    fread(&count, sizeof(int), 1, f)!=1 || count<0) {
+		fclose(f);
+		return false;
+	}
+	
+	// read the events
+	log.events.resize(count);
+	if (count>0 && fread(&log.events[0], sizeof(Input::Event), count, f)!=(size_t) count) {
+		fclose(f);
+		return false;
+	}
+	
+	fclose(f);
+	return true;
+}
+
+// load a case from file
+bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase, bool lazy) {
+	// map the requested file into memory
+	MappedFile mf;
+	if (!mapFile(path, mf))
+		return false;
+	
 	// get the root path
 	int npos;
 #ifndef __WIN32__
@@ -339,46 +447,60 @@ bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
 #endif
 	ustring root=path.substr(0, npos+1);
 	
+	// make sure the header fits
+	if (mf.size<(int) sizeof(PWTHeader)) {
+		unmapFile(mf);
+		return false;
+	}
+	
 	// read the header
 	PWTHeader header;
-	fread(&header, sizeof(PWTHeader), 1, f);
+	memcpy(&header, mf.data, sizeof(PWTHeader));
 	
 	// compare magic number
 	if (header.ident!=FILE_MAGIC_NUM) {
-		fclose(f);
+		unmapFile(mf);
 		return false;
 	}
 	
 	// compare version
 	if (header.version!=FILE_VERSION) {
-		fclose(f);
+		unmapFile(mf);
 		return false;
 	}
 	
+	// images are decoded in parallel, and uploaded once the case is read
+	DecodeQueue queue;
+	
+	// time spent in each section
+	int sectionStart=SDL_GetTicks();
+	int caseStart=sectionStart;
+	std::vector<std::pair<const char*, int> > timings;
+	
 	// create a new overview struct
 	Case::Overview overview;
 	
 	// skip to overview
-	fseek(f, header.overviewOffset, SEEK_SET);
+	seekMapped(mf, header.overviewOffset);
 	
 	// read in data
-	overview.name=readString(f);
-	overview.author=readString(f);
-	fread(&overview.lawSys, sizeof(int), 1, f);
+	overview.name=readString(mf);
+	overview.author=readString(mf);
+	overview.lawSys=readInt(mf);
 	
 	// read in core blocks
 	for (int i=0; i<Case::Case::CORE_BLOCK_COUNT; i++)
-		pcase.setCoreBlock(i, readString(f));
+		pcase.setCoreBlock(i, readString(mf));
 	
 	// skip to overrides
-	fseek(f, header.overridesOffset, SEEK_SET);
+	seekMapped(mf, header.overridesOffset);
 	
 	// create a new overrides object
 	Case::Overrides ov;
 	
 	// read data
-	fread(&ov.textboxAlpha, sizeof(int), 1, f);
-	ov.titleScreen=readString(f);
+	ov.textboxAlpha=readInt(mf);
+	ov.titleScreen=readString(mf);
 	
 	// set overrides
 	pcase.setOverrides(ov);
@@ -387,15 +509,17 @@ bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
 	pcase.setOverview(overview);
 	
 	// read initial block id
-	ustring initialBlock=readString(f);
+	ustring initialBlock=readString(mf);
 	pcase.setInitialBlockId(initialBlock);
 	
+	timings.push_back(std::make_pair("overview", SDL_GetTicks()-sectionStart));
+	sectionStart=SDL_GetTicks();
+	
 	// skip to characters
-	fseek(f, header.charOffset, SEEK_SET);
+	seekMapped(mf, header.charOffset);
 	
 	// read amount of characters
-	int ucharCount;
-	fread(&ucharCount, sizeof(int), 1, f);
+	int ucharCount=readInt(mf);
 	
 	// read each character
 	for (int i=0; i<ucharCount; i++) {
@@ -403,28 +527,27 @@ bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
 		ustring str;
 		
 		// read internal name
-		str=readString(f);
+		str=readString(mf);
 		character.setInternalName(str);
 		
 		// read displayed name
-		str=readString(f);
+		str=readString(mf);
 		character.setName(str);
 		
 		// read gender
-		int gender;
-		fread(&gender, sizeof(int), 1, f);
+		int gender=readInt(mf);
 		character.setGender((gender==0 ? Character::GENDER_MALE : Character::GENDER_FEMALE));
 		
 		// read caption
-		str=readString(f);
+		str=readString(mf);
 		character.setCaption(str);
 		
 		// read description
-		str=readString(f);
+		str=readString(mf);
 		character.setDescription(str);
 		
 		// read sprite name
-		str=readString(f);
+		str=readString(mf);
 		character.setSpriteName(str);
 		
 		// if the sprite name is not invalid, try loading said sprite
@@ -434,7 +557,7 @@ bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
 			
 			// try to load it
 			Sprite sprite;
-			if (!IO::loadSpriteFromFile(sprPath, sprite))
+			if (!IO::loadSpriteFromFile(sprPath, sprite, &queue, lazy))
 				Utils::alert("Unable to load sprite for '"+character.getInternalName()+"': '"+sprPath+"'", Utils::MESSAGE_WARNING);
 			
 			else
@@ -442,28 +565,26 @@ bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
 		}
 		
 		// see if this character has a text box tag
-		bool tag;
-		fread(&tag, sizeof(bool), 1, f);
+		bool tag=readBool(mf);
 		character.setHasTextBoxTag(tag);
 		
 		// if the tag exists, read the image
 		if (tag) {
-			GLuint texTag=Textures::createTexture(STR_NULL, readImage(f), 225);
+			GLuint texTag=loadImage(mf, STR_NULL, 225, &queue, lazy, Textures::CATEGORY_OTHER);
 			character.setTextBoxTag(texTag);
 		}
 		
 		// see if this character has a headshot image
-		bool headshot;
-		fread(&headshot, sizeof(bool), 1, f);
+		bool headshot=readBool(mf);
 		character.setHasHeadshot(headshot);
 		
 		// if the headshot exists, read the image
 		if (headshot) {
 			// read full image
-			GLuint headshot=Textures::createTexture(STR_NULL, readImage(f));
+			GLuint headshot=loadImage(mf, STR_NULL, 255, &queue, lazy, Textures::CATEGORY_OTHER);
 			
 			// read scaled thumbnail
-			GLuint thumb=Textures::createTexture(STR_NULL, readImage(f));
+			GLuint thumb=loadImage(mf, STR_NULL, 255, &queue, lazy, Textures::CATEGORY_OTHER);
 			
 			character.setHeadshot(headshot, thumb);
 		}
@@ -472,95 +593,102 @@ bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
 		pcase.addCharacter(character);
 	}
 	
+	timings.push_back(std::make_pair("characters", SDL_GetTicks()-sectionStart));
+	sectionStart=SDL_GetTicks();
+	
 	// skip to background
-	fseek(f, header.bgOffset, SEEK_SET);
+	seekMapped(mf, header.bgOffset);
 	
 	// read amount of backgrounds
-	int bgCount;
-	fread(&bgCount, sizeof(int), 1, f);
+	int bgCount=readInt(mf);
 	
 	// iterate over backgrounds
 	for (int i=0; i<bgCount; i++) {
 		Case::Background bg;
 		
 		// read id
-		bg.id=readString(f);
+		bg.id=readString(mf);
 		
 		// read type
-		int bgType;
-		fread(&bgType, sizeof(int), 1, f);
+		int bgType=readInt(mf);
 		bg.type=(bgType==0 ? Case::BG_SINGLE_SCREEN : Case::BG_DOUBLE_SCREEN);
 		
 		// read pixbuf data
-		bg.texture=Textures::createTexture(bg.id, readImage(f));
+		bg.texture=loadImage(mf, bg.id, 255, &queue, lazy, Textures::CATEGORY_BACKGROUNDS);
 		
 		// add this background
 		pcase.addBackground(bg);
 	}
 	
+	timings.push_back(std::make_pair("backgrounds", SDL_GetTicks()-sectionStart));
+	sectionStart=SDL_GetTicks();
+	
 	// skip to evidence
-	fseek(f, header.evidenceOffset, SEEK_SET);
+	seekMapped(mf, header.evidenceOffset);
 	
 	// read amount of evidence
-	int evidenceCount;
-	fread(&evidenceCount, sizeof(int), 1, f);
+	int evidenceCount=readInt(mf);
 	
 	// iterate over evidence
 	for (int i=0; i<evidenceCount; i++) {
 		Case::Evidence evidence;
 	
 		// read id
-		evidence.id=readString(f);
+		evidence.id=readString(mf);
 		
 		// read name
-		evidence.name=readString(f);
+		evidence.name=readString(mf);
 		
 		// read caption
-		evidence.caption=readString(f);
+		evidence.caption=readString(mf);
 		
 		// read description
-		evidence.description=readString(f);
+		evidence.description=readString(mf);
 		
 		// read check image id
-		evidence.checkID=readString(f);
+		evidence.checkID=readString(mf);
 		
 		// read pixbuf data
-		evidence.texture=Textures::createTexture(STR_NULL, readImage(f));
+		evidence.texture=loadImage(mf, STR_NULL, 255, &queue, lazy, Textures::CATEGORY_EVIDENCE);
 		
 		// read thumbnail data
-		evidence.thumb=Textures::createTexture(STR_NULL, readImage(f));
+		evidence.thumb=loadImage(mf, STR_NULL, 255, &queue, lazy, Textures::CATEGORY_EVIDENCE);
 		
 		// add this evidence
 		pcase.addEvidence(evidence);
 	}
 	
+	timings.push_back(std::make_pair("evidence", SDL_GetTicks()-sectionStart));
+	sectionStart=SDL_GetTicks();
+	
 	// skip to images
-	fseek(f, header.imgOffset, SEEK_SET);
+	seekMapped(mf, header.imgOffset);
 	
 	// read amount of images
-	int imageCount;
-	fread(&imageCount, sizeof(int), 1, f);
+	int imageCount=readInt(mf);
 	
 	// iterate over images
 	for (int i=0; i<imageCount; i++) {
 		Case::Image img;
 		
 		// read id
-		img.id=readString(f);
+		img.id=readString(mf);
 		
 		// read image
-		img.texture=Textures::createTexture(STR_NULL, readImage(f));
+		img.texture=loadImage(mf, STR_NULL, 255, &queue, lazy, Textures::CATEGORY_OTHER);
 		
 		// add this image
 		pcase.addImage(img);
 	}
 	
+	timings.push_back(std::make_pair("images", SDL_GetTicks()-sectionStart));
+	sectionStart=SDL_GetTicks();
+	
 	// skip to locations
-	fseek(f, header.locationOffset, SEEK_SET);
+	seekMapped(mf, header.locationOffset);
 	
 	// read amount of locations
-	int locationCount;
-	fread(&locationCount, sizeof(int), 1, f);
+	int locationCount=readInt(mf);
 	
 	// iterate over locations
 	for (int i=0; i<locationCount; i++) {
@@ -571,45 +699,43 @@ bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
 		location.state="default";
 		
 		// read id
-		location.id=readString(f);
+		location.id=readString(mf);
 		
 		// read name
-		location.name=readString(f);
+		location.name=readString(mf);
 		
 		// read amount of hotspots
-		int hcount;
-		fread(&hcount, sizeof(int), 1, f);
+		int hcount=readInt(mf);
 		
 		// iterate over hotspots
 		for (int i=0; i<hcount; i++) {
 			Case::Hotspot hspot;
 			
 			// read area
-			int x, y, w, h;
-			fread(&x, sizeof(int), 1, f);
-			fread(&y, sizeof(int), 1, f);
-			fread(&w, sizeof(int), 1, f);
-			fread(&h, sizeof(int), 1, f);
+			int x=readInt(mf);
+			int y=readInt(mf);
+			int w=readInt(mf);
+			int h=readInt(mf);
 			hspot.rect=Rect(Point(x, y), w, h+197);
 			
 			// read target block
-			hspot.block=readString(f);
+			hspot.block=readString(mf);
+			hspot.blockHandle=Case::NULL_BLOCK;
 			
 			// add this hotspot
 			location.hotspots.push_back(hspot);
 		}
 		
 		// read amount of states
-		int scount;
-		fread(&scount, sizeof(int), 1, f);
+		int scount=readInt(mf);
 		
 		// iterate over states
 		for (int i=0; i<scount; i++) {
 			// read the state id
-			ustring state=readString(f);
+			ustring state=readString(mf);
 			
 			// and then the background id
-			ustring id=readString(f);
+			ustring id=readString(mf);
 			
 			location.states[state]=id;
 		}
@@ -627,79 +753,83 @@ bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
 		pcase.addLocation(location);
 	}
 	
+	timings.push_back(std::make_pair("locations", SDL_GetTicks()-sectionStart));
+	sectionStart=SDL_GetTicks();
+	
 	// skip to audio
-	fseek(f, header.audioOffset, SEEK_SET);
+	seekMapped(mf, header.audioOffset);
 	
 	// read amount of audio samples
-	int audioCount;
-	fread(&audioCount, sizeof(int), 1, f);
+	int audioCount=readInt(mf);
 	
 	// iterate over audio
 	for (int i=0; i<audioCount; i++) {
 		Audio::Sample audio;
 		
 		// read id
-		audio.id=readString(f);
+		audio.id=readString(mf);
 		
 		// read filename
-		ustring afile=readString(f);
+		ustring afile=readString(mf);
 		
 		// form full string and load the audio sample
 		if (Audio::loadSample(root+"audio/"+afile, audio))
 			Audio::pushAudio(audio.id, audio);
 	}
 	
+	timings.push_back(std::make_pair("audio", SDL_GetTicks()-sectionStart));
+	sectionStart=SDL_GetTicks();
+	
 	// skip to testimonies
-	fseek(f, header.testimonyOffset, SEEK_SET);
+	seekMapped(mf, header.testimonyOffset);
 	
 	// read count of testimonies
-	int testimonyCount;
-	fread(&testimonyCount, sizeof(int), 1, f);
+	int testimonyCount=readInt(mf);
 	
 	// iterate over testimonies
 	for (int i=0; i<testimonyCount; i++) {
 		Case::Testimony testimony;
 		
 		// read testimony id
-		testimony.id=readString(f);
+		testimony.id=readString(mf);
 		
 		// read title
-		testimony.title=readString(f);
+		testimony.title=readString(mf);
 		
 		// read speaker
-		testimony.speaker=readString(f);
+		testimony.speaker=readString(mf);
 		
 		// read next block
-		testimony.nextBlock=readString(f);
+		testimony.nextBlock=readString(mf);
 		
 		// read follow up location
-		testimony.followLocation=readString(f);
+		testimony.followLocation=readString(mf);
 		
 		// read cross examination follow block
-		testimony.xExamineEndBlock=readString(f);
+		testimony.xExamineEndBlock=readString(mf);
+		testimony.xExamineEndHandle=Case::NULL_BLOCK;
 		
 		// read amount of pieces
-		int tpieceCount;
-		fread(&tpieceCount, sizeof(int), 1, f);
+		int tpieceCount=readInt(mf);
 		
 		// iterate over pieces
 		for (int j=0; j<tpieceCount; j++) {
 			Case::TestimonyPiece piece;
 			
 			// read contents
-			piece.text=readString(f);
+			piece.text=Script::compile(readStringUTF32(mf));
 			
 			// read present evidence id
-			piece.presentId=readString(f);
+			piece.presentId=readString(mf);
 			
 			// read present target
-			piece.presentBlock=readString(f);
+			piece.presentBlock=readString(mf);
 			
 			// read press target
-			piece.pressBlock=readString(f);
+			piece.pressBlock=readString(mf);
 			
 			// read hidden value
-			fread(&piece.hidden, sizeof(bool), 1, f);
+			piece.hidden=readBool(mf);
 			
 			// add this piece
 			testimony.pieces.push_back(piece);
@@ -709,56 +839,82 @@ bool IO::loadCaseFromFile(const ustring &path, Case::Case &pcase) {
 		pcase.addTestimony(testimony);
 	}
 	
+	timings.push_back(std::make_pair("testimonies", SDL_GetTicks()-sectionStart));
+	sectionStart=SDL_GetTicks();
+	
 	// skip to blocks
-	fseek(f, header.blockOffset, SEEK_SET);
+	seekMapped(mf, header.blockOffset);
 	
 	// read amount of text blocks
-	int bufferCount;
-	fread(&bufferCount, sizeof(int), 1, f);
+	int bufferCount=readInt(mf);
 	
 	// iterate over text blocks
 	for (int i=0; i<bufferCount; i++) {
 		// read id
-		ustring bufferId=readString(f);
+		ustring bufferId=readString(mf);
 		
-		// read text contents
-		ustring contents=readString(f);
+		// read text contents, already decoded for the parser
+		UTF32String contents=readStringUTF32(mf);
 		
 		// append this text buffer to the map
 		pcase.addBuffer(bufferId, contents);
 	}
 	
-	// wrap up
-	fclose(f);
-	std::cout << "Done loading case.\n";
+	// now that all blocks are known, resolve references to them
+	pcase.linkBlocks();
+	
+	timings.push_back(std::make_pair("blocks", SDL_GetTicks()-sectionStart));
+	
+	// see if we ran past the end of the file at some point
+	bool truncated=mf.overrun;
+	
+	// wait for the images, and upload them; this also releases the mapping,
+	// unless the images are to be loaded later on
+	sectionStart=SDL_GetTicks();
+	if (lazy)
+		Assets::keepMapped(mf);
+	else
+		queue.adopt(mf);
+	queue.flush();
+	timings.push_back(std::make_pair("textures", SDL_GetTicks()-sectionStart));
+	
+	if (truncated) {
+		Utils::alert("Case file '"+path+"' is truncated or corrupt.");
+		return false;
+	}
+	
+	// print the load time breakdown
+	std::cout << "Done loading case in " << SDL_GetTicks()-caseStart << "ms:\n";
+	for (int i=0; i<timings.size(); i++)
+		std::cout << "  " << std::setw(12) << std::left << timings[i].first << timings[i].second << "ms\n";
+	
 	return true;
 }
 
 // load a sprite from file
-bool IO::loadSpriteFromFile(const ustring &path, Sprite &sprite) {
-	// open the requested file
-	FILE *f=fopen(path.c_str(), "rb");
-	if (!f)
+bool IO::loadSpriteFromFile(const ustring &path, Sprite &sprite, DecodeQueue *queue, bool lazy) {
+	// map the requested file
+	MappedFile mf;
+	if (!mapFile(path, mf))
 		return false;
 	
 	// read file header 
-	if (fgetc(f)!=(char) 'P' || fgetc(f)!=(char) 'W' || fgetc(f)!=(char) 'S') {
-		fclose(f);
+	if (mf.size<3 || mf.data[0]!='P' || mf.data[1]!='W' || mf.data[2]!='S') {
+		unmapFile(mf);
 		Utils::alert("Error loading sprite file: '"+path+"'\nReason: Unrecognized file format.");
 		return false;
 	}
+	seekMapped(mf, 3);
 	
-	int version;
-	fread(&version, sizeof(int), 1, f);
+	int version=readInt(mf);
 	if (version!=10) {
-		fclose(f);
+		unmapFile(mf);
 		Utils::alert("Error loading sprite file: '"+path+"'\nReason: Unsupported file version: "+Utils::itoa(version)+".");
 		return false;
 	}
 	
 	// read count of animations
-	int count;
-	fread(&count, sizeof(int), 1, f);
+	int count=readInt(mf);
 	
 	if (Utils::g_IDebugOn)
 		Utils::message("Loading sprite: ");
@@ -768,27 +924,26 @@ bool IO::loadSpriteFromFile(const ustring &path, Sprite &sprite) {
 		Animation anim;
 		
 		// read id
-		anim.id=readString(f);
+		anim.id=readString(mf);
 		
 		// read looping value
-		fread(&anim.loop, sizeof(bool), 1, f);
+		anim.loop=readBool(mf);
 		
 		// read amount of frames
-		int fcount;
-		fread(&fcount, sizeof(int), 1, f);
+		int fcount=readInt(mf);
 		
 		// load over frames
 		for (int j=0; j<fcount; j++) {
 			Frame fr;
 			
 			// read time
-			fread(&fr.time, sizeof(int), 1, f);
+			fr.time=readInt(mf);
 			
 			// read sound effect
-			fr.sfx=readString(f);
+			fr.sfx=readString(mf);
 			
 			// read image
-			fr.image=Textures::createTexture(STR_NULL, readImage(f));
+			fr.image=loadImage(mf, STR_NULL, 255, queue, lazy, Textures::CATEGORY_SPRITES);
 			
 			// add this frame
 			anim.frames.push_back(fr);
@@ -804,33 +959,45 @@ bool IO::loadSpriteFromFile(const ustring &path, Sprite &sprite) {
 	if (Utils::g_IDebugOn)
 		Utils::message("[done]\n");
 	
-	// wrap up
-	fclose(f);
+	// wrap up; when decoding on a queue, the file stays mapped until it is flushed,
+	// and when loading lazily, until the images are no longer needed
+	bool truncated=mf.overrun;
+	if (lazy)
+		Assets::keepMapped(mf);
+	else if (queue)
+		queue->adopt(mf);
+	else
+		unmapFile(mf);
+	
+	if (truncated) {
+		Utils::alert("Error loading sprite file: '"+path+"'\nReason: File is truncated.");
+		return false;
+	}
+	
 	return true;
 }
 
 // load stock assets config file
 bool IO::loadStockFile(const ustring &path, Case::Case *pcase) {
-	// open the path
-	FILE *f=fopen(path.c_str(), "rb");
-	if (!f) {
+	// the config file is part of the resource pack
+	const VFS::File *cfg=VFS::getFile(path);
+	if (!cfg) {
 		Utils::alert("Unable to open stock assets file: '"+path+"'.");
 		return false;
 	}
 	
 	// read the lines in the file
-	char line[256];
-	while(!feof(f)) {
-		// get this line
-		fgets(line, 256, f);
-		
+	std::istringstream ss(std::string(cfg->data, cfg->size));
+	std::string line;
+	while(std::getline(ss, line)) {
 		// ignore useless lines
-		if (line[0]=='#')
+		if (line.empty() || line[0]=='#')
 			continue;
 		
 		// extract id and path
 		char id[256], file[256];
-		sscanf(line, "%s %s", id, file);
+		if (sscanf(line.c_str(), "%255s %255s", id, file)!=2)
+			continue;
 		
 		// form a string objects
 		ustring sId(id);
@@ -843,7 +1010,7 @@ bool IO::loadStockFile(const ustring &path, Case::Case *pcase) {
 			
 			// try to load this sample
 			Audio::Sample sample;
-			if (!Audio::loadSample(ustring(".temp/")+sFile, sample))
+			if (!Audio::loadSample(sFile, sample))
 				return false;
 			
 			// add this sample
@@ -857,8 +1024,8 @@ bool IO::loadStockFile(const ustring &path, Case::Case *pcase) {
 			
 			// try to load the sprite
 			Sprite sprite;
-			if (!IO::loadSpriteFromFile(ustring(".temp/")+sFile, sprite)) {
-				Utils::alert("Unable to load stock sprite: '.temp/"+sFile+"'");
+			if (!IO::loadSpriteFromFile(sFile, sprite)) {
+				Utils::alert("Unable to load stock sprite: '"+sFile+"'");
 				return false;
 			}
 			
@@ -875,7 +1042,8 @@ bool IO::loadStockFile(const ustring &path, Case::Case *pcase) {
 			// see if a text box tag is present
 			if (vec[4]!=STR_NULL) {
 				// load the tag
-				GLuint tag=Textures::createTexture(STR_NULL, ".temp/data/stock/"+vec[4], 165);
+				GLuint tag=Textures::createTexture(STR_NULL, "data/stock/"+vec[4], 165);
+				Textures::setCategory(tag, Textures::CATEGORY_GUI);
 				
 				// set this tag
 				character.setHasTextBoxTag(true);
@@ -926,9 +1094,10 @@ bool IO::loadStockFile(const ustring &path, Case::Case *pcase) {
 			}
 			
 			// create a surface
-			GLuint tex=Textures::createTexture(sId, ustring(".temp/")+rFile, alpha);
+			GLuint tex=Textures::createTexture(sId, rFile, alpha);
 			if (Textures::isNull(tex) && sId!="no_texture")
 				Utils::alert("Unable to create stock texture: "+sId);
+			Textures::setCategory(tex, Textures::CATEGORY_GUI);
 			
 			// add a background if needed
 			if (bg) {
@@ -945,25 +1114,20 @@ bool IO::loadStockFile(const ustring &path, Case::Case *pcase) {
 		}
 	}
 	
-	// close the file
-	fclose(f);
 	return true;
 }
 
 // load a translation file
 bool IO::loadTranslationFile(const ustring &path, std::map<ustring, ustring> &map) {
-	// open the file
-	FILE *f=fopen(path.c_str(), "r");
-	if (!f)
+	// the translation is part of the resource pack
+	const VFS::File *file=VFS::getFile(path);
+	if (!file)
 		return false;
 	
-	// iterate that many times and read all translations
-	while(1) {
-		// read a line of text
-		char str[512];
-		if (fgets(str, 512, f)==NULL)
-			break;
-		
+	// iterate over lines and read all translations
+	std::istringstream ss(std::string(file->data, file->size));
+	std::string str;
+	while(std::getline(ss, str)) {
 		ustring gstr=str;
 		
 		// make sure that there is a translation on this line
@@ -982,13 +1146,14 @@ bool IO::loadTranslationFile(const ustring &path, std::map<ustring, ustring> &ma
 		map[key]=trs;
 	}
 	
-	fclose(f);
 	return true;
 }
 
 // load theme from xml
 bool IO::loadThemeXML(const ustring &path, Theme::ColorMap &map) {
-	xmlDocPtr doc=xmlParseFile(path.c_str());
+	// parse from memory if the file is part of the resource pack
+	const VFS::File *file=VFS::getFile(path);
+	xmlDocPtr doc=(file ? xmlParseMemory(file->data, file->size) : xmlParseFile(path.c_str()));
 	if (!doc) {
 		Utils::alert("Unable to load theme XML file: '"+path+"'");
 		return false;
@@ -1093,3 +1258,219 @@ ustring IO::readString(FILE *f) {
 	
 	return str;
 }
+
+// map an entire file into memory
+bool IO::mapFile(const ustring &path, MappedFile &mf) {
+	mf.data=NULL;
+	mf.size=0;
+	mf.pos=0;
+	mf.overrun=false;
+	mf.owned=false;
+	
+	// files from the resource pack are already in memory
+	const VFS::File *file=VFS::getFile(path);
+	if (file) {
+		mf.data=file->data;
+		mf.size=file->size;
+		return true;
+	}
+	
+#ifndef __WIN32__
+	int fd=open(path.c_str(), O_RDONLY);
+	if (fd==-1)
+		return false;
+	
+	// get the size of the file
+	struct stat st;
+	if (fstat(fd, &st)==-1 || st.st_size==0) {
+		close(fd);
+		return false;
+	}
+	
+	// map the file; the descriptor is no longer needed once the mapping exists
+	void *addr=mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr==MAP_FAILED)
+		return false;
+	
+	mf.size=st.st_size;
+#else
+	HANDLE file=CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 
+			       FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file==INVALID_HANDLE_VALUE)
+		return false;
+	
+	DWORD size=GetFileSize(file, NULL);
+	if (size==INVALID_FILE_SIZE || size==0) {
+		CloseHandle(file);
+		return false;
+	}
+	
+	// create a mapping and view it; the view keeps both handles alive
+	HANDLE mapping=CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+	
+	void *addr=MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!addr)
+		return false;
+	
+	mf.size=size;
+#endif
+	
+	mf.data=(const char*) addr;
+	mf.owned=true;
+	return true;
+}
+
+// unmap a previously mapped file
+void IO::unmapFile(MappedFile &mf) {
+	if (!mf.data)
+		return;
+	
+	// memory belonging to the VFS namespace is left alone
+	if (mf.owned) {
+#ifndef __WIN32__
+		munmap((void*) mf.data, mf.size);
+#else
+		UnmapViewOfFile(mf.data);
+#endif
+	}
+	
+	mf.data=NULL;
+	mf.size=0;
+	mf.pos=0;
+}
+
+// move the read position of a mapped file
+void IO::seekMapped(MappedFile &mf, int offset) {
+	if (offset<0 || offset>mf.size) {
+		mf.overrun=true;
+		mf.pos=mf.size;
+	}
+	
+	else
+		mf.pos=offset;
+}
+
+// read an integer from a mapped file
+int IO::readInt(MappedFile &mf) {
+	int value=0;
+	if ((int) sizeof(int)>mf.size-mf.pos) {
+		mf.overrun=true;
+		mf.pos=mf.size;
+		return value;
+	}
+	
+	// the data is not guaranteed to be aligned
+	memcpy(&value, mf.data+mf.pos, sizeof(int));
+	mf.pos+=sizeof(int);
+	
+	return value;
+}
+
+// read a boolean from a mapped file
+bool IO::readBool(MappedFile &mf) {
+	bool value=false;
+	if ((int) sizeof(bool)>mf.size-mf.pos) {
+		mf.overrun=true;
+		mf.pos=mf.size;
+		return value;
+	}
+	
+	memcpy(&value, mf.data+mf.pos, sizeof(bool));
+	mf.pos+=sizeof(bool);
+	
+	return value;
+}
+
+// get the location of image data in a mapped file
+const char* IO::readImageData(MappedFile &mf, int &size) {
+	// read buffer size
+	size=readInt(mf);
+	if (size<=0 || size>mf.size-mf.pos) {
+		mf.overrun=true;
+		mf.pos=mf.size;
+		size=0;
+		Utils::alert("Error reading internal image: image data extends past end of file");
+		return NULL;
+	}
+	
+	const char *data=mf.data+mf.pos;
+	mf.pos+=size;
+	
+	return data;
+}
+
+// read image data from a mapped file
+SDL_Surface* IO::readImage(MappedFile &mf) {
+	int size;
+	const char *data=readImageData(mf, size);
+	if (!data)
+		return NULL;
+	
+	// point SDL directly at the mapped bytes
+	SDL_RWops *rw=SDL_RWFromConstMem(data, size);
+	if (!rw) {
+		Utils::alert("Error reading internal image: '"+ustring(SDL_GetError())+"'");
+		return NULL;
+	}
+	
+	// load our image from raw data, and free the RWops structure
+	SDL_Surface *srf=IMG_Load_RW(rw, 1);
+	if (!srf) {
+		Utils::alert("Error loading internal image: '"+ustring(SDL_GetError())+"'");
+		return NULL;
+	}
+	
+	return srf;
+}
+
+// read a string from a mapped file
+ustring IO::readString(MappedFile &mf) {
+	// read string length
+	int len=readInt(mf);
+	if (len<0 || len>(mf.size-mf.pos)/(int) sizeof(gunichar)) {
+		mf.overrun=true;
+		mf.pos=mf.size;
+		return "";
+	}
+	
+	// convert the stored 4 byte characters straight into utf-8, without
+	// going through the slower ustring append
+	std::string utf8;
+	utf8.reserve(len);
+	
+	const char *p=mf.data+mf.pos;
+	for (int i=0; i<len; i++) {
+		gunichar ch;
+		memcpy(&ch, p+i*sizeof(gunichar), sizeof(gunichar));
+		
+		char buf[6];
+		utf8.append(buf, g_unichar_to_utf8(ch, buf));
+	}
+	mf.pos+=len*sizeof(gunichar);
+	
+	return ustring(utf8);
+}
+
+// read a string of characters from the mapped file
+UTF32String IO::readStringUTF32(MappedFile &mf) {
+	// read string length
+	int len=readInt(mf);
+	if (len<0 || len>(mf.size-mf.pos)/(int) sizeof(gunichar)) {
+		mf.overrun=true;
+		mf.pos=mf.size;
+		return UTF32String();
+	}
+	
+	// the file already stores 4 byte characters
+	UTF32String str(len, 0);
+	if (len>0)
+		memcpy(&str[0], mf.data+mf.pos, len*sizeof(gunichar));
+	mf.pos+=len*sizeof(gunichar);
+	
+	return str;
+}
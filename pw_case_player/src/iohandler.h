@@ -26,10 +26,13 @@
 
 #include "case.h"
 #include "game.h"
+#include "input.h"
 #include "sprite.h"
 #include "texture.h"
 #include "theme.h"
 
+class DecodeQueue;
+
 /// Namespace for file loading and parsing functions
 namespace IO {
 
@@ -52,6 +55,16 @@ struct _PWTHeader {
 };
 typedef struct _PWTHeader PWTHeader;
 
+/// A read-only view of an entire file mapped into memory
+struct _MappedFile {
+	const char *data; // start of mapped bytes
+	int size; // size of the mapping in bytes
+	int pos; // current read position
+	bool overrun; // set if a read went past the end of the mapping
+	bool owned; // whether the mapping needs to be released, or belongs to the VFS
+};
+typedef struct _MappedFile MappedFile;
+
 /// Magic number for PWT case file
 const int FILE_MAGIC_NUM=(('T' << 16) + ('W' << 8) + 'P');
 
@@ -64,17 +77,24 @@ const int FILE_VERSION=10;
 /// Supported version of the SV save file
 const int SV_VERSION=10;
 
+/// Magic number for input recordings
+const int REC_FILE_MAGIC_NUM=(('C' << 16) + ('E' << 8) + 'R');
+
+/// Supported version of input recordings
+const int REC_VERSION=10;
+
 /// Magic number for the sprite file
 const ustring SPR_MAGIC_NUM="SPR";
 
 /// Supported sprite file version
 const int SPR_VERSION=10;
 
-/** Unpack and extract the resource file
+/** Read the contents of the resource file into memory
+  * Each file in the archive is added to the VFS namespace.
   * \param path Path to the resource file
   * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
 */
-bool unpackResourceFile(const ustring &path);
+bool loadResourceFile(const ustring &path);
 
 /** Save a game state to file
   * \param gstate The GameState struct to save
@@ -90,19 +110,36 @@ bool saveGameState(const GameState &gstate, int number);
 */
 bool loadGameState(GameState &gstate, int number);
 
+/** Save recorded input to file
+  * \param path Path to the file
+  * \param log The recorded session
+  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
+*/
+bool saveInputLog(const ustring &path, const Input::Log &log);
+
+/** Load recorded input from file
+  * \param path Path to the file
+  * \param log The Input::Log struct to write values to
+  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
+*/
+bool loadInputLog(const ustring &path, Input::Log &log);
+
 /** Load a case from file
   * \param path The path to the file
   * \param pcase Case::Case object to load the data into
+  * \param lazy <b>true</b> to decode images only when they are first used
   * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
 */
-bool loadCaseFromFile(const ustring &path, Case::Case &pcase);
+bool loadCaseFromFile(const ustring &path, Case::Case &pcase, bool lazy=false);
 
 /** Load a sprite from file
   * \param path Path to the sprite file
   * \param sprite Sprite object to load the dat into
+  * \param queue Optional DecodeQueue to decode frame images on; the file stays mapped until it is flushed
+  * \param lazy <b>true</b> to decode frame images only when they are first used
   * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
 */
-bool loadSpriteFromFile(const ustring &path, Sprite &sprite);
+bool loadSpriteFromFile(const ustring &path, Sprite &sprite, DecodeQueue *queue=NULL, bool lazy=false);
 
 /** Load the stock assets config file
   * \param path Path to the config file
@@ -143,6 +180,64 @@ void writeString(const ustring &str, FILE *f);
 */
 ustring readString(FILE *f);
 
+/** Map an entire file into memory for reading
+  * Files from the resource pack are read from memory instead.
+  * \param path Path to the file
+  * \param mf MappedFile struct to fill in
+  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
+*/
+bool mapFile(const ustring &path, MappedFile &mf);
+
+/** Release a file previously mapped with mapFile()
+  * \param mf The mapped file
+*/
+void unmapFile(MappedFile &mf);
+
+/** Move the read position of a mapped file
+  * \param mf The mapped file
+  * \param offset Byte offset relative to start of file
+*/
+void seekMapped(MappedFile &mf, int offset);
+
+/** Read an integer from a mapped file
+  * \param mf The mapped file with read position set to the integer
+  * \return The read value, or 0 if past the end of the file
+*/
+int readInt(MappedFile &mf);
+
+/** Read a boolean from a mapped file
+  * \param mf The mapped file with read position set to the boolean
+  * \return The read value, or <b>false</b> if past the end of the file
+*/
+bool readBool(MappedFile &mf);
+
+/** Get the location of compressed image data in a mapped file
+  * \param mf The mapped file with read position set to image
+  * \param size Set to the size of the image data in bytes
+  * \return Pointer to the image data inside the mapping, NULL on error
+*/
+const char* readImageData(MappedFile &mf, int &size);
+
+/** Read image data from a mapped file
+  * The image is decoded directly from the mapped bytes.
+  * \param mf The mapped file with read position set to image
+  * \return An allocated SDL_Surface on success, NULL otherwise
+*/
+SDL_Surface* readImage(MappedFile &mf);
+
+/** Read a string from a mapped file
+  * \param mf The mapped file with read position set to string
+  * \return The read string
+*/
+ustring readString(MappedFile &mf);
+
+/** Read a string from a mapped file as decoded Unicode characters
+  * The characters are copied as they are stored, without converting to UTF-8.
+  * \param mf The mapped file with read position set to string
+  * \return The read string
+*/
+UTF32String readStringUTF32(MappedFile &mf);
+
 }; // namespace IO
 
 #endif
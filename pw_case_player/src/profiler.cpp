@@ -0,0 +1,298 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// profiler.cpp: implementation of Profiler namespace
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <GL/gl.h>
+
+#ifdef __WIN32__
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "font.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "texture.h"
+#include "utilities.h"
+
+namespace Profiler {
+	bool g_Overlay=false;
+	bool g_Tracing=false;
+	FrameRecord g_History[HISTORY_SIZE];
+	int g_Current=0;
+	std::vector<TraceEvent> g_Trace;
+	
+	// when the trace, the current frame, and each running phase started
+	Uint64 g_TraceStart=0;
+	Uint64 g_FrameStart=0;
+	Uint64 g_PhaseStart[PHASE_COUNT];
+}
+
+// colors used for each phase in the overlay
+static const Color g_PhaseColors[Profiler::PHASE_COUNT]={
+	Color(80, 160, 255), Color(80, 220, 120), Color(230, 120, 230), Color(255, 210, 80), 
+	Color(255, 130, 60), Color(200, 80, 80), Color(110, 110, 110)
+};
+
+// get a high resolution time
+Uint64 Profiler::microseconds() {
+#ifdef __WIN32__
+	static LARGE_INTEGER freq={ 0 };
+	if (freq.QuadPart==0)
+		QueryPerformanceFrequency(&freq);
+	
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return (Uint64) (now.QuadPart*1000000/freq.QuadPart);
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (Uint64) tv.tv_sec*1000000+tv.tv_usec;
+#endif
+}
+
+// start recording a trace
+void Profiler::startTrace() {
+	g_Trace.clear();
+	g_TraceStart=microseconds();
+	g_Tracing=true;
+}
+
+// stop recording, and save the trace
+bool Profiler::saveTrace(const ustring &path) {
+	g_Tracing=false;
+	
+	std::ofstream file(path.c_str());
+	if (!file)
+		return false;
+	
+	// every event belongs to the same process and thread
+	file << "{\"traceEvents\":[\n";
+	for (int i=0; i<g_Trace.size(); i++) {
+		const TraceEvent &e=g_Trace[i];
+		file << "{\"name\":\"" << e.name << "\",\"cat\":\"player\",\"ph\":\"" << e.type << "\",\"ts\":" << e.time 
+		     << ",\"pid\":1,\"tid\":1}" << (i+1<g_Trace.size() ? ",\n" : "\n");
+	}
+	file << "],\"displayTimeUnit\":\"ms\"}\n";
+	
+	g_Trace.clear();
+	return file.good();
+}
+
+// add an event to the trace
+static void addTraceEvent(const char *name, char type) {
+	if (!Profiler::g_Tracing)
+		return;
+	
+	// stop recording rather than growing without bounds
+	if (Profiler::g_Trace.size()>=Profiler::MAX_TRACE_EVENTS) {
+		Utils::debugMessage("Profiler: trace is full, no longer recording");
+		Profiler::g_Tracing=false;
+		return;
+	}
+	
+	Profiler::TraceEvent e;
+	e.name=name;
+	e.type=type;
+	e.time=Profiler::microseconds()-Profiler::g_TraceStart;
+	Profiler::g_Trace.push_back(e);
+}
+
+// begin a named section
+void Profiler::begin(const char *name) {
+	addTraceEvent(name, 'B');
+}
+
+// end a named section
+void Profiler::end(const char *name) {
+	addTraceEvent(name, 'E');
+}
+
+// start timing a new frame
+void Profiler::beginFrame() {
+	g_Current=(g_Current+1)%HISTORY_SIZE;
+	memset(&g_History[g_Current], 0, sizeof(FrameRecord));
+	
+	g_FrameStart=microseconds();
+	begin("frame");
+}
+
+// finish timing the current frame
+void Profiler::endFrame() {
+	end("frame");
+	g_History[g_Current].total=(Uint32) (microseconds()-g_FrameStart);
+}
+
+// start timing a phase
+void Profiler::beginPhase(Phase phase) {
+	g_PhaseStart[phase]=microseconds();
+	begin(phaseName(phase));
+}
+
+// stop timing a phase
+void Profiler::endPhase(Phase phase) {
+	end(phaseName(phase));
+	g_History[g_Current].phases[phase]+=(Uint32) (microseconds()-g_PhaseStart[phase]);
+}
+
+// add to a counter
+void Profiler::count(Counter counter, int amount) {
+	g_History[g_Current].counters[counter]+=amount;
+}
+
+// get the name of a phase
+const char* Profiler::phaseName(Phase phase) {
+	switch(phase) {
+		case PHASE_TOP_VIEW: return "top view";
+		case PHASE_MENU_VIEW: return "menu view";
+		case PHASE_EFFECTS: return "effects";
+		case PHASE_PARSE: return "parse";
+		case PHASE_INPUT: return "input";
+		case PHASE_SWAP: return "swap";
+		case PHASE_WAIT: return "wait";
+		default: return "unknown";
+	}
+}
+
+// format microseconds as milliseconds
+static ustring formatMs(double us) {
+	std::stringstream ss;
+	ss.setf(std::ios::fixed);
+	ss.precision(1);
+	ss << us/1000.0;
+	
+	return ss.str();
+}
+
+// draw the overlay
+void Profiler::drawOverlay() {
+	if (!g_Overlay || !Renderer::g_Output)
+		return;
+	
+	// the overlay goes over everything, regardless of depth
+	Renderer::flush();
+	glClear(GL_DEPTH_BUFFER_BIT);
+	
+	Renderer::drawRect(Rect(Point(0, 0, 0.0f), 256, 192), Color(0, 0, 0, 192));
+	
+	// gather averages over every completed frame in the history
+	double avgTotal=0.0, avgPhases[PHASE_COUNT];
+	Uint32 maxTotal=0;
+	int histogram[HISTOGRAM_BUCKETS];
+	memset(avgPhases, 0, sizeof(avgPhases));
+	memset(histogram, 0, sizeof(histogram));
+	
+	int frames=0;
+	for (int i=1; i<HISTORY_SIZE; i++) {
+		const FrameRecord &r=g_History[(g_Current+i)%HISTORY_SIZE];
+		if (r.total==0)
+			continue;
+		
+		frames++;
+		avgTotal+=r.total;
+		maxTotal=std::max(maxTotal, r.total);
+		for (int p=0; p<PHASE_COUNT; p++)
+			avgPhases[p]+=r.phases[p];
+		
+		histogram[std::min((int) (r.total/1000/HISTOGRAM_BUCKET), HISTOGRAM_BUCKETS-1)]++;
+	}
+	
+	if (frames>0) {
+		avgTotal/=frames;
+		for (int p=0; p<PHASE_COUNT; p++)
+			avgPhases[p]/=frames;
+	}
+	
+	int lineHeight=Fonts::getHeight(Fonts::FONT_INFO_PAGE);
+	int y=2;
+	
+	// overall frame time
+	Fonts::drawString(Point(4, y), "frame "+formatMs(avgTotal)+" ms avg, "+formatMs(maxTotal)+" ms max", 
+			  Fonts::FONT_INFO_PAGE, Color(255, 255, 255));
+	y+=lineHeight;
+	
+	// average time of each phase, in the color used for it in the graph
+	for (int p=0; p<PHASE_COUNT; p++) {
+		ustring text=ustring(phaseName((Phase) p))+" "+formatMs(avgPhases[p]);
+		Fonts::drawString(Point(4+(p%4)*63, y+(p/4)*lineHeight), text, Fonts::FONT_INFO_PAGE, g_PhaseColors[p]);
+	}
+	y+=lineHeight*2;
+	
+	// counters of the last completed frame
+	const FrameRecord &last=g_History[(g_Current+HISTORY_SIZE-1)%HISTORY_SIZE];
+	std::stringstream ss;
+	ss << last.counters[COUNTER_DRAW_CALLS] << " draws, " << last.counters[COUNTER_TEXTURE_BINDS] << " binds, "
+	   << last.counters[COUNTER_GLYPHS] << " glyphs, " << last.counters[COUNTER_UPLOADS] << " uploads";
+	Fonts::drawString(Point(4, y), ss.str(), Fonts::FONT_INFO_PAGE, Color(255, 255, 255));
+	y+=lineHeight;
+	
+	// texture memory in use
+	std::stringstream ts;
+	ts << "textures " << Textures::g_Resident/1024 << "KB";
+	if (Textures::g_Budget>0)
+		ts << " of " << Textures::g_Budget/1024 << "KB";
+	ts << ", " << Textures::g_Evictions << " evicted, " << Textures::g_Reloads << " reloaded";
+	Fonts::drawString(Point(4, y), ts.str(), Fonts::FONT_INFO_PAGE, Color(255, 255, 255));
+	y+=lineHeight+2;
+	
+	// recent frames, each split into its phases; the graph shows up to 32ms,
+	// with a line marking a 60fps frame
+	const int graphHeight=64, graphMs=32;
+	int base=y+graphHeight;
+	for (int i=1; i<HISTORY_SIZE; i++) {
+		const FrameRecord &r=g_History[(g_Current+i)%HISTORY_SIZE];
+		int x=(i-1)*2, top=base;
+		
+		for (int p=0; p<PHASE_COUNT; p++) {
+			int h=std::min((int) (r.phases[p]*graphHeight/(graphMs*1000)), top-y);
+			if (h<=0)
+				continue;
+			
+			top-=h;
+			Renderer::drawRect(Rect(Point(x, top, 1.0f), 2, h), g_PhaseColors[p]);
+		}
+		
+		// whatever isn't covered by a phase
+		int h=std::min((int) (r.total*graphHeight/(graphMs*1000)), graphHeight)-(base-top);
+		if (h>0)
+			Renderer::drawRect(Rect(Point(x, top-h, 1.0f), 2, h), Color(255, 255, 255, 96));
+	}
+	Renderer::drawRect(Rect(Point(0, base-(1000/60)*graphHeight/graphMs, 2.0f), 256, 1), Color(255, 0, 0, 160));
+	y=base+4;
+	
+	// histogram of frame times
+	int tallest=1;
+	for (int i=0; i<HISTOGRAM_BUCKETS; i++)
+		tallest=std::max(tallest, histogram[i]);
+	
+	int histHeight=188-y;
+	for (int i=0; i<HISTOGRAM_BUCKETS; i++) {
+		int h=histogram[i]*histHeight/tallest;
+		if (h>0)
+			Renderer::drawRect(Rect(Point(8+i*12, 188-h, 1.0f), 10, h), Color(160, 200, 255));
+	}
+	
+	Renderer::flush();
+}
@@ -0,0 +1,161 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// profiler.h: frame timing, counters and trace recording
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+#include "SDL.h"
+
+#include "common.h"
+
+/** Namespace for measuring where time goes while playing a case.
+  * Each frame is split into phases, whose durations are kept for the last 
+  * HISTORY_SIZE frames along with a few per frame counters. These can be shown 
+  * in an overlay drawn over the game. Named sections can also be recorded into 
+  * a trace, which is saved in the Chrome trace event format so that it can be 
+  * opened in chrome://tracing or a compatible viewer.
+*/
+namespace Profiler {
+
+/// Parts of a frame that are timed separately
+enum Phase { PHASE_TOP_VIEW=0, PHASE_MENU_VIEW, PHASE_EFFECTS, PHASE_PARSE, PHASE_INPUT, PHASE_SWAP, PHASE_WAIT, PHASE_COUNT };
+
+/// Events counted in each frame
+enum Counter { COUNTER_DRAW_CALLS=0, COUNTER_TEXTURE_BINDS, COUNTER_GLYPHS, COUNTER_UPLOADS, COUNTER_COUNT };
+
+/// Amount of frames kept for the overlay
+const int HISTORY_SIZE=128;
+
+/// Width of a bucket in the frame time histogram, in milliseconds
+const int HISTOGRAM_BUCKET=2;
+
+/// Amount of buckets in the frame time histogram; the last one holds everything longer
+const int HISTOGRAM_BUCKETS=20;
+
+/// Most events kept in a trace, so that long sessions don't use up memory
+const int MAX_TRACE_EVENTS=1000000;
+
+/// Timings and counters of a single frame
+struct _FrameRecord {
+	Uint32 total;			///< Length of the whole frame, in microseconds
+	Uint32 phases[PHASE_COUNT];	///< Time spent in each phase, in microseconds
+	int counters[COUNTER_COUNT];	///< Value of each counter
+};
+typedef struct _FrameRecord FrameRecord;
+
+/// An entry in the trace
+struct _TraceEvent {
+	const char *name;	///< Name of the section
+	char type;		///< 'B' when the section begins, 'E' when it ends
+	Uint64 time;		///< Time of the event, in microseconds since the trace started
+};
+typedef struct _TraceEvent TraceEvent;
+
+/// Flag whether or not the overlay is drawn
+extern bool g_Overlay;
+
+/// Flag whether or not a trace is being recorded
+extern bool g_Tracing;
+
+/// Records of the last frames, used as a ring buffer
+extern FrameRecord g_History[HISTORY_SIZE];
+
+/// Index of the record for the current frame in the history
+extern int g_Current;
+
+/// Events recorded in the trace
+extern std::vector<TraceEvent> g_Trace;
+
+/** Get a high resolution time
+  * \return Microseconds since an arbitrary point in time
+*/
+Uint64 microseconds();
+
+/// Start recording a trace
+void startTrace();
+
+/** Stop recording, and save the trace to a file
+  * \param path Path to the file to save to
+  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
+*/
+bool saveTrace(const ustring &path);
+
+/** Begin a named section in the trace
+  * \param name Name of the section; this must be a string literal
+*/
+void begin(const char *name);
+
+/** End a named section in the trace
+  * \param name Name of the section, as passed to begin()
+*/
+void end(const char *name);
+
+/// Start timing a new frame
+void beginFrame();
+
+/// Finish timing the current frame
+void endFrame();
+
+/** Start timing a phase of the current frame
+  * \param phase The phase to time
+*/
+void beginPhase(Phase phase);
+
+/** Stop timing a phase of the current frame
+  * \param phase The phase that was being timed
+*/
+void endPhase(Phase phase);
+
+/** Add to a counter for the current frame
+  * \param counter The counter to add to
+  * \param amount The amount to add
+*/
+void count(Counter counter, int amount=1);
+
+/** Get a displayable name for a phase
+  * \param phase The phase
+  * \return Name of the phase
+*/
+const char* phaseName(Phase phase);
+
+/// Draw the overlay with the timings of the last frames
+void drawOverlay();
+
+/// Times a named section of the trace for as long as it's in scope
+class Scope {
+	public:
+		/** Constructor
+		  * \param name Name of the section; this must be a string literal
+		*/
+		Scope(const char *name): m_Name(name) { begin(m_Name); }
+		
+		/// Destructor
+		~Scope() { end(m_Name); }
+		
+	private:
+		/// Name of the section
+		const char *m_Name;
+};
+
+}; // namespace Profiler
+
+#endif
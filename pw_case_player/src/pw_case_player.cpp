@@ -41,6 +41,16 @@ int main(int argc, char *argv[]) {
 		std::cout << "  -ns,  --no-sound  \tDisables audio output\n";
 		std::cout << "  -d,   --debug     \tEnables debug messages\n";
 		std::cout << "  -fs,  --fullscreen\tStarts the player in fullscreen mode\n";
+		std::cout << "  -la,  --lazy-assets\tLoads case images only when they are needed\n";
+		std::cout << "       --vsync     \tSynchronizes frames with the display\n";
+		std::cout << "       --headless  \tRuns the game logic without output, and reports throughput\n";
+		std::cout << "       --input=FILE\tInput script to play back in headless mode\n";
+		std::cout << "       --frames=N  \tAmount of frames to run in headless mode\n";
+		std::cout << "       --frame-time=MS\tGame time that passes each headless frame\n";
+		std::cout << "       --record=FILE\tRecords input to a file for later playback\n";
+		std::cout << "       --replay=FILE\tPlays back recorded input\n";
+		std::cout << "       --trace=FILE\tSaves a Chrome trace of loading and playing the case\n";
+		std::cout << "       --texture-budget=MB\tLimits texture memory, loading evicted images again when needed\n";
 		std::cout << "\n";
 		std::cout << "Official website: http://pw-case-editor.sourceforge.net\n";
 		return 0;
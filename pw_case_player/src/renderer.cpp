@@ -19,53 +19,342 @@
  ***************************************************************************/
 // renderer.cpp: implementations of Renderer namespace
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <GL/gl.h>
 #include <sstream>
 #include "SDL_gfxPrimitives.h"
 
+#include "clock.h"
 #include "font.h"
+#include "profiler.h"
 #include "renderer.h"
 #include "sdlcontext.h"
+#include "symbols.h"
 #include "texture.h"
 #include "theme.h"
 #include "utilities.h"
 
+namespace Renderer {
+	bool g_Output=true;
+	std::vector<Quad> g_Quads;
+	FrameStats g_FrameStats={ 0, 0, 0, 0 };
+	FrameStats g_LastFrameStats={ 0, 0, 0, 0 };
+	RegionCache g_Regions[REGION_COUNT];
+	
+	// the region currently being drawn, and where its quads start
+	int g_OpenRegion=-1;
+	int g_RegionStart=0;
+	
+	// whether the open region was interrupted by a flush
+	bool g_RegionBroken=false;
+}
+
 // reset an opengl matrix
 void Renderer::resetGLMatrix(GLenum matrix) {
+	if (!g_Output)
+		return;
+	
 	glMatrixMode(matrix);
 	glLoadIdentity();
 	glMatrixMode(GL_MODELVIEW);
 }
 
-// draw a colored rectangle
-void Renderer::drawRect(const Rect &rect, const Color &color) {
-	glDisable(GL_TEXTURE_2D);
+// queue a quad for the next flush
+void Renderer::drawQuad(const Point &p, int w, int h, GLuint texture, float u1, float v1, float u2, float v2, const Color &color) {
+	GLfloat x1=p.x(), y1=p.y(), x2=p.x()+w, y2=p.y()+h, z=p.z();
+	GLfloat vertices[12]={ x1, y1, z, x2, y1, z, x2, y2, z, x1, y2, z };
+	GLfloat texCoords[8]={ u1, v1, u2, v1, u2, v2, u1, v2 };
+	
+	Quad quad;
+	quad.texture=texture;
+	quad.z=z;
+	quad.order=g_Quads.size();
+	memcpy(quad.vertices, vertices, sizeof(vertices));
+	memcpy(quad.texCoords, texCoords, sizeof(texCoords));
+	
+	// every vertex shares the same color
+	for (int i=0; i<4; i++) {
+		quad.colors[i*4]=(GLubyte) color.r();
+		quad.colors[i*4+1]=(GLubyte) color.g();
+		quad.colors[i*4+2]=(GLubyte) color.b();
+		quad.colors[i*4+3]=(GLubyte) color.a();
+	}
 	
-	// save our current color and whatnot
-	glPushAttrib(GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT);
+	g_Quads.push_back(quad);
+	g_FrameStats.quads++;
 	
-	// we need to enable blending in this case
-	if (color.a()<(char) 255) {
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// keep this texture from being evicted while it's in use
+	if (texture)
+		Textures::touch(texture);
+}
+
+// order quads back to front; quads at the same depth keep the order they were
+// submitted in, since that decides which one ends up on top
+static bool compareQuads(const Renderer::Quad &a, const Renderer::Quad &b) {
+	if (a.z!=b.z)
+		return a.z<b.z;
+	
+	return a.order<b.order;
+}
+
+// draw all queued quads
+void Renderer::flush() {
+	if (g_Quads.empty())
+		return;
+	
+	// quads drawn so far in an open region may have used another matrix
+	if (g_OpenRegion!=-1)
+		g_RegionBroken=true;
+	
+	// without output, there is nothing to draw to
+	if (!g_Output) {
+		g_Quads.clear();
+		return;
 	}
 	
-	// translate according to z
-	glTranslatef(0.0f, 0.0f, rect.getPoint().z());
+	std::sort(g_Quads.begin(), g_Quads.end(), compareQuads);
+	
+	// copy the quads into contiguous arrays; these are kept around to avoid
+	// reallocating them every frame
+	static std::vector<GLfloat> vertices, texCoords;
+	static std::vector<GLubyte> colors;
+	
+	int count=g_Quads.size();
+	vertices.resize(count*12);
+	texCoords.resize(count*8);
+	colors.resize(count*16);
+	for (int i=0; i<count; i++) {
+		memcpy(&vertices[i*12], g_Quads[i].vertices, sizeof(g_Quads[i].vertices));
+		memcpy(&texCoords[i*8], g_Quads[i].texCoords, sizeof(g_Quads[i].texCoords));
+		memcpy(&colors[i*16], g_Quads[i].colors, sizeof(g_Quads[i].colors));
+	}
 	
-	// draw the rectangle with the specified color
-	glColor4ub(color.r(), color.g(), color.b(), color.a());
+	glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_TEXTURE_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
 	
-	Point p=rect.getPoint();
-	glRecti(p.x(), p.y(), p.x()+rect.getWidth(), p.y()+rect.getHeight());
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	
-	// return to previous z
-	glTranslatef(0.0f, 0.0f, -rect.getPoint().z());
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+	glTexCoordPointer(2, GL_FLOAT, 0, &texCoords[0]);
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colors[0]);
+	
+	// we don't know what state we were left in, so force the first toggle
+	bool textured=false;
+	GLuint bound=0;
+	bool first=true;
+	
+	// draw each run of adjacent quads that share a texture in one call
+	int start=0;
+	while(start<count) {
+		GLuint texture=g_Quads[start].texture;
+		int end=start+1;
+		while(end<count && g_Quads[end].texture==texture)
+			end++;
+		
+		if (texture==0) {
+			if (textured || first) {
+				glDisable(GL_TEXTURE_2D);
+				textured=false;
+				g_FrameStats.stateChanges++;
+			}
+		}
+		
+		else {
+			if (!textured || first) {
+				glEnable(GL_TEXTURE_2D);
+				textured=true;
+				g_FrameStats.stateChanges++;
+			}
+			
+			if (bound!=texture) {
+				glBindTexture(GL_TEXTURE_2D, texture);
+				bound=texture;
+				g_FrameStats.stateChanges++;
+				Profiler::count(Profiler::COUNTER_TEXTURE_BINDS);
+			}
+		}
+		
+		first=false;
+		
+		glDrawArrays(GL_QUADS, start*4, (end-start)*4);
+		g_FrameStats.drawCalls++;
+		Profiler::count(Profiler::COUNTER_DRAW_CALLS);
+		
+		start=end;
+	}
 	
+	glPopClientAttrib();
 	glPopAttrib();
 	
-	glEnable(GL_TEXTURE_2D);
+	g_Quads.clear();
+}
+
+// finish drawing the current frame
+void Renderer::endFrame() {
+	flush();
+	
+	g_LastFrameStats=g_FrameStats;
+	g_FrameStats.quads=0;
+	g_FrameStats.drawCalls=0;
+	g_FrameStats.stateChanges=0;
+	g_FrameStats.regionHits=0;
+}
+
+// compute a signature for a range of queued quads
+static Uint32 signQuads(int start, int end) {
+	// fnv-1a over everything that affects the output of the quads
+	Uint32 hash=2166136261u;
+	for (int i=start; i<end; i++) {
+		const Renderer::Quad &q=Renderer::g_Quads[i];
+		const Uint8 *fields[]={ (const Uint8*) &q.texture, (const Uint8*) q.vertices, 
+					(const Uint8*) q.texCoords, (const Uint8*) q.colors };
+		const int sizes[]={ sizeof(q.texture), sizeof(q.vertices), sizeof(q.texCoords), sizeof(q.colors) };
+		
+		for (int f=0; f<4; f++) {
+			for (int b=0; b<sizes[f]; b++) {
+				hash^=fields[f][b];
+				hash*=16777619u;
+			}
+		}
+	}
+	
+	return hash;
+}
+
+// copy the contents of a region from the framebuffer
+static bool retainRegion(Renderer::RegionCache &cache) {
+	Point p;
+	int w, h;
+	cache.rect.getGeometry(p, w, h);
+	
+	// allocate a texture large enough for the region
+	if (!cache.texture) {
+		cache.texW=cache.texH=1;
+		while(cache.texW<w)
+			cache.texW*=2;
+		while(cache.texH<h)
+			cache.texH*=2;
+		
+		cache.texture=Textures::generateName();
+		glBindTexture(GL_TEXTURE_2D, cache.texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, cache.texW, cache.texH, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		Textures::account(cache.texture, w*h*3, cache.texW*cache.texH*3);
+	}
+	
+	// the framebuffer's origin is at the bottom left
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	
+	glBindTexture(GL_TEXTURE_2D, cache.texture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, p.x(), viewport[3]-(p.y()+h), w, h);
+	
+	return (glGetError()==GL_NO_ERROR);
+}
+
+// start drawing a screen region
+void Renderer::beginRegion(Region region, const Rect &rect) {
+	if (!g_Output)
+		return;
+	
+	// anything queued before belongs to another part of the screen
+	flush();
+	
+	// the area covered by this region changed, so the copy is useless
+	RegionCache &cache=g_Regions[region];
+	Point p=rect.getPoint(), old=cache.rect.getPoint();
+	if (p.x()!=old.x() || p.y()!=old.y() || rect.getWidth()!=cache.rect.getWidth() || 
+	    rect.getHeight()!=cache.rect.getHeight()) {
+		cache.rect=rect;
+		cache.valid=false;
+		cache.count=0;
+	}
+	
+	g_OpenRegion=region;
+	g_RegionStart=g_Quads.size();
+	g_RegionBroken=false;
+}
+
+// finish drawing a screen region
+void Renderer::endRegion(Region region) {
+	if (!g_Output || g_OpenRegion!=region)
+		return;
+	
+	g_OpenRegion=-1;
+	RegionCache &cache=g_Regions[region];
+	
+	// a region drawn across several flushes can't be compared
+	if (g_RegionBroken) {
+		cache.valid=false;
+		cache.count=0;
+		flush();
+		return;
+	}
+	
+	int count=g_Quads.size()-g_RegionStart;
+	Uint32 signature=signQuads(g_RegionStart, g_Quads.size());
+	bool same=(count>0 && count==cache.count && signature==cache.signature);
+	
+	// nothing changed since the copy was made, so draw the copy instead
+	if (same && cache.valid) {
+		g_Quads.erase(g_Quads.begin()+g_RegionStart, g_Quads.end());
+		
+		Point p=cache.rect.getPoint();
+		drawQuad(Point(p.x(), p.y(), cache.z), cache.rect.getWidth(), cache.rect.getHeight(), cache.texture,
+			 0.0f, (float) cache.rect.getHeight()/cache.texH, (float) cache.rect.getWidth()/cache.texW, 0.0f, 
+			 Color(255, 255, 255));
+		g_FrameStats.regionHits++;
+		
+		flush();
+		return;
+	}
+	
+	// remember the lowest depth, so that the copy doesn't cover anything
+	// drawn over the region later on
+	float z=0.0f;
+	for (int i=g_RegionStart; i<g_Quads.size(); i++) {
+		if (i==g_RegionStart || g_Quads[i].z<z)
+			z=g_Quads[i].z;
+	}
+	
+	flush();
+	
+	// only copy regions that stayed the same for two frames; regions that
+	// keep changing would pay for the copy without ever using it
+	if (same)
+		cache.valid=retainRegion(cache);
+	else
+		cache.valid=false;
+	
+	cache.signature=signature;
+	cache.count=count;
+	cache.z=z;
+}
+
+// keep the open region from being retained
+void Renderer::touchRegion() {
+	if (g_OpenRegion!=-1)
+		g_RegionBroken=true;
+}
+
+// discard retained region copies
+void Renderer::invalidateRegions() {
+	for (int i=0; i<REGION_COUNT; i++) {
+		g_Regions[i].valid=false;
+		g_Regions[i].count=0;
+	}
+}
+
+// draw a colored rectangle
+void Renderer::drawRect(const Rect &rect, const Color &color) {
+	drawQuad(rect.getPoint(), rect.getWidth(), rect.getHeight(), 0, 0, 0, 0, 0, color);
 }
 
 // draw a full image at a point
@@ -77,6 +366,11 @@ void Renderer::drawImage(const Point &p, const ustring &texId) {
 	drawImage(p, tex);
 }
 
+// draw a full image at a point
+void Renderer::drawImage(const Point &p, Symbols::Symbol sym) {
+	drawImage(p, Textures::queryTexture(sym));
+}
+
 // draw a full image at a point
 void Renderer::drawImage(const Point &p, const GLuint &id) {
 	// perform a query based on the GL ID instead of string id
@@ -87,22 +381,8 @@ void Renderer::drawImage(const Point &p, const GLuint &id) {
 }
 
 // draw a full image at a point
-void Renderer::drawImage(const Point &p, const Textures::Texture &tex) {
-	glEnable(GL_TEXTURE_2D);
-	
-	glBindTexture(GL_TEXTURE_2D, tex.id);
-	
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	
-	// draw the textured quad
-	glBegin(GL_QUADS); {
-		glTexCoord2f(0, 0); glVertex3f(p.x(), p.y(), p.z());
-		glTexCoord2f(tex.u, 0); glVertex3f(p.x()+tex.w, p.y(), p.z());
-		glTexCoord2f(tex.u, tex.v); glVertex3f(p.x()+tex.w, p.y()+tex.h, p.z());
-		glTexCoord2f(0, tex.v); glVertex3f(p.x(), p.y()+tex.h, p.z());
-	}
-	glEnd();
+void Renderer::drawImage(const Point &p, const Textures::Texture &tex, const Color &color) {
+	drawQuad(p, tex.w, tex.h, tex.id, 0, 0, tex.u, tex.v, color);
 }
 
 // draw a textured quad
@@ -127,23 +407,13 @@ void Renderer::drawButton(const Point &p1, int w, const ustring &text) {
 	}
 	
 	// first, draw the border at the left
-	Renderer::drawImage(p1, "tc_choice_btn_left");
-	Renderer::drawImage(Point(p1.x()+w-2, p1.y(), p1.z()), "tc_choice_btn_right");
+	Renderer::drawImage(p1, Symbols::SYM_TC_CHOICE_BTN_LEFT);
+	Renderer::drawImage(Point(p1.x()+w-2, p1.y(), p1.z()), Symbols::SYM_TC_CHOICE_BTN_RIGHT);
 	
 	// draw only as much of the button body as we need
-	Textures::Texture tex=Textures::queryTexture("tc_choice_btn_body");
-	
-	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, tex.id);
-	glBegin(GL_QUADS); {
-		glTexCoord2f(0, 0); glVertex3f(p1.x()+2, p1.y(), p1.z());
-		glTexCoord2f(tex.u, 0); glVertex3f(p1.x()+w, p1.y(), p1.z());
-		glTexCoord2f(tex.u, tex.v); glVertex3f(p1.x()+w, p1.y()+tex.h, p1.z());
-		glTexCoord2f(0, tex.v); glVertex3f(p1.x()+2, p1.y()+tex.h, p1.z());
-	}
-	glEnd();
+	Textures::Texture tex=Textures::queryTexture(Symbols::SYM_TC_CHOICE_BTN_BODY);
 	
-	glDisable(GL_TEXTURE_2D);
+	drawQuad(Point(p1.x()+2, p1.y(), p1.z()), w-2, tex.h, tex.id, 0, 0, tex.u, tex.v, Color(255, 255, 255));
 	
 	// now draw the text
 	int centerX=(p1.x()+(w/2)-(fw/2));
@@ -154,14 +424,14 @@ void Renderer::drawButton(const Point &p1, int w, const ustring &text) {
 // draw the initial game screen
 void Renderer::drawInitialScreen() {
 	// first, draw the background
-	Renderer::drawImage(Point(0, 197), "court_overview_g");
+	Renderer::drawImage(Point(0, 197), Symbols::SYM_COURT_OVERVIEW_G);
 	
 	// draw two buttons, one for New Game, and one for Continue
-	UI::Manager::instance()->drawButton("an_new_game_btn");
-	UI::Manager::instance()->drawButton("an_continue_btn");
+	UI::Manager::instance()->drawButton(Symbols::SYM_AN_NEW_GAME_BTN);
+	UI::Manager::instance()->drawButton(Symbols::SYM_AN_CONTINUE_BTN);
 	
 	// draw scanlines to top it off
-	Renderer::drawImage(Point(0, 197), "scanlines_overlay");
+	Renderer::drawImage(Point(0, 197), Symbols::SYM_SCANLINES_OVERLAY);
 }
 
 // draw the evidence page
@@ -177,13 +447,13 @@ void Renderer::drawEvidencePage(const std::vector<Case::Evidence*> &evidence, in
 	drawRect(Rect(Point(26, 235, 1.3f), 204, 16), Theme::lookup("info_bar_bg"));
 	
 	// draw buttons
-	drawImage(Point(1, 253, 2.0f), "tc_large_btn_left");
-	drawImage(Point(256-16-1, 253, 2.0f), "tc_large_btn_right");
+	drawImage(Point(1, 253, 2.0f), Symbols::SYM_TC_LARGE_BTN_LEFT);
+	drawImage(Point(256-16-1, 253, 2.0f), Symbols::SYM_TC_LARGE_BTN_RIGHT);
 	
 	// draw arrows on buttons if there is more than one page
 	if (evidence.size()>8) {
-		drawImage(Point(4, 297, 2.1f), "tc_button_arrow_left");
-		drawImage(Point(256-12, 297, 2.1f), "tc_button_arrow_right");
+		drawImage(Point(4, 297, 2.1f), Symbols::SYM_TC_BUTTON_ARROW_LEFT);
+		drawImage(Point(256-12, 297, 2.1f), Symbols::SYM_TC_BUTTON_ARROW_RIGHT);
 	}
 	
 	// get the starting index for the vector
@@ -246,12 +516,12 @@ void Renderer::drawEvidenceInfoPage(const Case::Evidence *e) {
 	Point n=drawInfoStrip(p, Textures::queryTexture(e->texture), e->name, e->caption, e->description, true);
 	
 	// draw button on left
-	drawImage(Point(0, n.y()+4, 1.2f), "tc_small_btn_left");
-	UI::Manager::instance()->drawAnimation("an_info_page_button_left");
+	drawImage(Point(0, n.y()+4, 1.2f), Symbols::SYM_TC_SMALL_BTN_LEFT);
+	UI::Manager::instance()->drawAnimation(Symbols::SYM_AN_INFO_PAGE_BUTTON_LEFT);
 	
 	// draw button with arrow on right
-	drawImage(Point(n.x()+3, n.y()+4, 1.2f), "tc_small_btn_right");
-	UI::Manager::instance()->drawAnimation("an_info_page_button_right");
+	drawImage(Point(n.x()+3, n.y()+4, 1.2f), Symbols::SYM_TC_SMALL_BTN_RIGHT);
+	UI::Manager::instance()->drawAnimation(Symbols::SYM_AN_INFO_PAGE_BUTTON_RIGHT);
 }
 
 // draw the profiles page
@@ -267,13 +537,13 @@ void Renderer::drawProfilesPage(const std::vector<Character*> &uchars, int page,
 	drawRect(Rect(Point(26, 235, 1.3f), 204, 16), Theme::lookup("info_bar_bg"));
 	
 	// draw buttons
-	drawImage(Point(1, 253, 2.0f), "tc_large_btn_left");
-	drawImage(Point(239, 253, 2.0f), "tc_large_btn_right");
+	drawImage(Point(1, 253, 2.0f), Symbols::SYM_TC_LARGE_BTN_LEFT);
+	drawImage(Point(239, 253, 2.0f), Symbols::SYM_TC_LARGE_BTN_RIGHT);
 	
 	// draw arrows on buttons if there is more than one page
 	if (uchars.size()>8) {
-		drawImage(Point(4, 297, 2.1f), "tc_button_arrow_left");
-		drawImage(Point(244, 297, 2.1f), "tc_button_arrow_right");
+		drawImage(Point(4, 297, 2.1f), Symbols::SYM_TC_BUTTON_ARROW_LEFT);
+		drawImage(Point(244, 297, 2.1f), Symbols::SYM_TC_BUTTON_ARROW_RIGHT);
 	}
 	
 	// get the starting index for the vector
@@ -337,12 +607,12 @@ void Renderer::drawProfileInfoPage(const Character *c) {
 			      c->getName(), c->getCaption(), c->getDescription(), true);
 	
 	// draw button on left
-	drawImage(Point(0, n.y()+4, 1.2f), "tc_small_btn_left");
-	UI::Manager::instance()->drawAnimation("an_info_page_button_left");
+	drawImage(Point(0, n.y()+4, 1.2f), Symbols::SYM_TC_SMALL_BTN_LEFT);
+	UI::Manager::instance()->drawAnimation(Symbols::SYM_AN_INFO_PAGE_BUTTON_LEFT);
 	
 	// draw button with arrow on right
-	drawImage(Point(n.x()+3, n.y()+4, 1.2f), "tc_small_btn_right");
-	UI::Manager::instance()->drawAnimation("an_info_page_button_right");
+	drawImage(Point(n.x()+3, n.y()+4, 1.2f), Symbols::SYM_TC_SMALL_BTN_RIGHT);
+	UI::Manager::instance()->drawAnimation(Symbols::SYM_AN_INFO_PAGE_BUTTON_RIGHT);
 }
 
 // draw the strip containing evidence or profile
@@ -403,24 +673,27 @@ void Renderer::drawExamineScene(const Textures::Texture &bg, const Point &cursor
 	// slide the background
 	UI::Manager::instance()->slideBG("an_bg_slide", bg.id);
 	
+	// the crosshair is drawn directly with opengl
+	if (!g_Output)
+		return;
+	
+	// the crosshair isn't queued, so it can't be compared between frames
+	touchRegion();
+	
 	// save our current state attributes
 	glPushAttrib(GL_CURRENT_BIT | GL_ENABLE_BIT);
 	
 	// disable textures
 	glDisable(GL_TEXTURE_2D);
 	
-	// and set a pulsing blue color
-	static int red=255, green=255, v=-1;
+	// and set a pulsing blue color, which changes every frame
+	Clock::busy();
 	
-	// red and green are our only variables
-	red+=v*3;
-	green+=v*3;
-	
-	// max of 255, min of 110
-	if (red>=255)
-		v=-1;
-	else if (red<=110)
-		v=1;
+	// red and green go from 255 down to 110 and back, by 3 every FRAME_TIME
+	const int half=((255-110)/3)*Clock::FRAME_TIME;
+	int t=Clock::frame()%(2*half);
+	int red=255-(t<half ? t : 2*half-t)*(255-110)/half;
+	int green=red;
 	
 	glColor3ub(256-red, 256-green, 255);
 	
@@ -454,10 +727,14 @@ void Renderer::drawExamineScene(const Textures::Texture &bg, const Point &cursor
 }
 
 // draw the movement scene
-void Renderer::drawMoveScene(const std::vector<ustring> &locations, LocationMap lmap, int selected) {
+void Renderer::drawMoveScene(const std::vector<ustring> &locations, const LocationMap &lmap, int selected) {
 	// go over locations
 	for (int i=0; i<locations.size(); i++) {
-		Case::Location location=lmap[locations[i]];
+		LocationMap::const_iterator it=lmap.find(locations[i]);
+		if (it==lmap.end())
+			continue;
+		
+		const Case::Location &location=(*it).second;
 		
 		std::stringstream ss;
 		ss << "an_move_loc" << i+1 << "_btn";
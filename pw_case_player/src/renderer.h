@@ -23,6 +23,7 @@
 #define RENDERER_H
 
 #include <iostream>
+#include <vector>
 #include <GL/gl.h>
 #include "SDL.h"
 
@@ -34,6 +35,110 @@
 /// Namespace for all higher level drawing functions
 namespace Renderer {
 
+/// A quad waiting to be drawn in the current batch
+struct _Quad {
+	GLuint texture;		///< The GL texture to draw with, 0 for a flat colored quad
+	float z;		///< Depth of the quad
+	int order;		///< Submission order, used to keep sorting stable
+	GLfloat vertices[12];	///< Four vertices, counter-clockwise from the top left
+	GLfloat texCoords[8];	///< Texture coordinates for each vertex
+	GLubyte colors[16];	///< RGBA color for each vertex
+};
+typedef struct _Quad Quad;
+
+/// Counters collected while drawing a frame
+struct _FrameStats {
+	int quads;		///< Number of quads submitted
+	int drawCalls;		///< Number of glDrawArrays calls issued
+	int stateChanges;	///< Number of texture binds and enable/disable toggles
+	int regionHits;		///< Number of regions redrawn from their retained copy
+};
+typedef struct _FrameStats FrameStats;
+
+/// Areas of the screen whose output can be retained between frames
+enum Region { REGION_TOP_SCREEN=0, REGION_LOWER_SCREEN, REGION_COUNT };
+
+/// The retained output of a screen region
+struct _RegionCache {
+	Rect rect;		///< Area of the screen covered by the region
+	GLuint texture;		///< Texture holding a copy of the region, 0 if not yet allocated
+	int texW;		///< Width of the texture
+	int texH;		///< Height of the texture
+	bool valid;		///< Whether the texture matches the last drawn contents
+	Uint32 signature;	///< Signature of the quads last drawn in the region
+	int count;		///< Number of quads last drawn in the region
+	float z;		///< Lowest depth of the quads last drawn in the region
+};
+typedef struct _RegionCache RegionCache;
+
+/** Flag whether or not to output anything to OpenGL.
+  * When disabled, quads are still queued and counted, but are discarded when 
+  * flushed, and no other GL calls are made. This allows the game to run without 
+  * a GL context, such as in headless mode.
+*/
+extern bool g_Output;
+
+/// Quads queued since the last flush
+extern std::vector<Quad> g_Quads;
+
+/// Counters for the frame currently being drawn
+extern FrameStats g_FrameStats;
+
+/// Counters for the last completed frame
+extern FrameStats g_LastFrameStats;
+
+/// Retained copies of each screen region
+extern RegionCache g_Regions[REGION_COUNT];
+
+/** Queue a quad to be drawn with the next flush
+  * \param p The top left corner of the quad
+  * \param w The width of the quad
+  * \param h The height of the quad
+  * \param texture The GL texture to use, or 0 for a flat colored quad
+  * \param u1 Left texture coordinate
+  * \param v1 Top texture coordinate
+  * \param u2 Right texture coordinate
+  * \param v2 Bottom texture coordinate
+  * \param color The color to modulate the quad with
+*/
+void drawQuad(const Point &p, int w, int h, GLuint texture, float u1, float v1, float u2, float v2, const Color &color);
+
+/** Draw all queued quads, sorted by depth and then by submission order.
+  * Adjacent quads that share a texture are drawn with a single call.
+  * This must be called before changing the modelview matrix, since queued
+  * quads are only transformed once they are flushed.
+*/
+void flush();
+
+/// Flush remaining quads and record the counters for this frame
+void endFrame();
+
+/** Start drawing the contents of a screen region.
+  * Quads queued until the matching endRegion() call are compared against
+  * those drawn in the region last frame. Regions should not overlap, and
+  * only one region can be open at a time.
+  * \param region The region about to be drawn
+  * \param rect The area of the screen the region covers
+*/
+void beginRegion(Region region, const Rect &rect);
+
+/** Finish drawing the contents of a screen region.
+  * If the region was drawn exactly as in the previous frame, its queued quads 
+  * are replaced by a single quad showing the retained copy. Once a region 
+  * stays the same for two frames in a row, its output is copied for reuse.
+  * \param region The region that was drawn
+*/
+void endRegion(Region region);
+
+/// Prevent the open region from being retained this frame, for drawing done directly with OpenGL
+void touchRegion();
+
+/** Discard the retained copies of all regions.
+  * This should be called whenever the contents of a texture change without
+  * its name changing, since such changes can't be detected otherwise.
+*/
+void invalidateRegions();
+
 /** Resets an OpenGL matrix back to its identity, 
   * then returns to modelview matrix
   * \param matrix Enum for the matrix to reset
@@ -52,6 +157,12 @@ void drawRect(const Rect &rect, const Color &color);
 */
 void drawImage(const Point &p, const ustring &texId);
 
+/** Draw a full image from the stack at a point
+  * \param p The point to draw the image at
+  * \param sym The interned ID of the image to draw
+*/
+void drawImage(const Point &p, Symbols::Symbol sym);
+
 /** Draw a full image from the stack at a point
   * \param p THe point to draw the image at
   * \param id The GL ID of the texture
@@ -61,8 +172,9 @@ void drawImage(const Point &p, const GLuint &id);
 /** Draw a full image at a point
   * \param p The point to draw the image at
   * \param texture The texture to draw
+  * \param color The color to tint the image with
 */
-void drawImage(const Point &p, const Textures::Texture &texture);
+void drawImage(const Point &p, const Textures::Texture &texture, const Color &color=Color(255, 255, 255));
 
 /** Draw part of an image to a specific point onto the screen
   * \param rect The part of the region to draw
@@ -128,7 +240,7 @@ void drawExamineScene(const Textures::Texture &bg, const Point &cursor, bool sli
   * \param lmap Map of all locations
   * \param selected 0 based index of selected location
 */
-void drawMoveScene(const std::vector<ustring> &locations, LocationMap lmap, int selected);
+void drawMoveScene(const std::vector<ustring> &locations, const LocationMap &lmap, int selected);
 
 /** Draw the talk scene
   * \param options String vector of talk options
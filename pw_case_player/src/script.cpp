@@ -0,0 +1,162 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// script.cpp: implementation of Script namespace
+
+#include <cstdlib>
+
+#include "script.h"
+#include "triggers.h"
+#include "utilities.h"
+
+// append an instruction without text to a program
+static void emit(Script::Program &program, Script::Opcode op, int source, int value=0) {
+	Script::Instruction ins;
+	ins.op=op;
+	ins.source=source;
+	ins.value=value;
+	ins.length=0;
+	ins.target=-1;
+	
+	program.code.push_back(ins);
+}
+
+// compile a text block
+Script::Program Script::compile(const UTF32String &block, bool tagOpen) {
+	Program program;
+	program.source=block;
+	
+	int pos=0;
+	int size=block.size();
+	while(pos<size) {
+		uchar ch=block[pos];
+		uchar next=(pos+1<size ? block[pos+1] : 0);
+		
+		// tag delimiter
+		if (ch=='<') {
+			UTF32String::size_type end=block.find('>', pos);
+			if (end==UTF32String::npos)
+				break;
+			
+			// if a tag is already open, this one must close it
+			if (tagOpen)
+				emit(program, OP_TAG_CLOSE, pos);
+			
+			else {
+				emit(program, OP_TAG_OPEN, pos);
+				program.code.back().name=Utils::fromUTF32(block.substr(pos+1, end-pos-1));
+			}
+			
+			tagOpen=!tagOpen;
+			pos=end+1;
+		}
+		
+		// trigger, in the form of {*op:args;*}
+		else if (ch=='{') {
+			UTF32String::size_type colon=block.find(':', pos);
+			if (colon==UTF32String::npos)
+				break;
+			
+			UTF32String::size_type semicolon=block.find(';', colon);
+			UTF32String::size_type end=block.find('}', colon);
+			
+			ustring name=Utils::fromUTF32(block.substr(pos+2, colon-pos-2));
+			ustring args=Utils::fromUTF32(block.substr(colon+1, (semicolon==UTF32String::npos ? UTF32String::npos : semicolon-colon-1)));
+			
+			// resolve the trigger now, so it doesn't need to be looked up when executed
+			Triggers::ID id=Triggers::lookup(name);
+			if (id==Triggers::TRIGGER_UNKNOWN)
+				Utils::debugMessage("Unknown trigger: "+name);
+			
+			else if (!Triggers::checkArguments(id, args))
+				Utils::debugMessage("Trigger "+name+" has too few arguments: "+args);
+			
+			else {
+				emit(program, OP_TRIGGER, pos, id);
+				program.code.back().name=name;
+				program.code.back().args=args;
+			}
+			
+			pos=(end==UTF32String::npos ? size : end+1);
+		}
+		
+		// dialogue control, except for literal new lines
+		else if (ch=='\\' && next!='n') {
+			uchar arg=(pos+2<size ? block[pos+2] : 0);
+			int length=2;
+			
+			switch(next) {
+				case 'c':
+				case 'g':
+				case 'o':
+				case 'w': emit(program, OP_COLOR, pos, next); break;
+				
+				case 'b': emit(program, OP_BREAK, pos); break;
+				case 'd': emit(program, OP_BLOCK_DIAG, pos); break;
+				case '=': emit(program, OP_SPEED_NORM, pos); break;
+				case '*': emit(program, OP_SHAKE, pos); break;
+				
+				// speed changes are followed by a single digit multiplier
+				case '+':
+				case '-': {
+					int multiplier=atoi(Utils::ucharToStr(arg).c_str());
+					emit(program, (next=='+' ? OP_SPEED_INCR : OP_SPEED_DECR), pos, multiplier);
+					length=3;
+				}; break;
+				
+				// pauses are followed by a two digit duration, which is kept in the text pool
+				case 'p': {
+					emit(program, OP_PAUSE, pos, program.text.size());
+					program.text+=arg;
+					program.text+=(pos+3<size ? block[pos+3] : 0);
+					length=4;
+				}; break;
+			}
+			
+			pos+=length;
+		}
+		
+		// new lines in the source are not part of the dialogue
+		else if (ch=='\n')
+			pos++;
+		
+		// normal character, which either extends the current text run or starts a new one
+		else {
+			if (program.code.empty() || program.code.back().op!=OP_TEXT ||
+			    program.code.back().source+program.code.back().length!=pos) {
+				emit(program, OP_TEXT, pos, program.text.size());
+			}
+			
+			program.code.back().length++;
+			program.text+=ch;
+			pos++;
+		}
+	}
+	
+	return program;
+}
+
+// get the source that remains to be executed
+UTF32String Script::remainingSource(const Program &program, int pc, int offset) {
+	if (pc>=program.code.size())
+		return UTF32String();
+	
+	const Instruction &ins=program.code[pc];
+	return program.source.substr(ins.source+(ins.op==OP_TEXT ? offset : 0));
+}
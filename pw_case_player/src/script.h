@@ -0,0 +1,85 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// script.h: compilation of text blocks into instructions
+
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <vector>
+
+#include "common.h"
+
+/// Namespace for compiling text blocks into instructions for the TextParser
+namespace Script {
+
+/// Operations in a compiled text block
+enum Opcode {
+	OP_TEXT=0,		///< Append a run of characters to the dialogue
+	OP_TAG_OPEN,		///< Open a styling tag
+	OP_TAG_CLOSE,		///< Close the open styling tag
+	OP_TRIGGER,		///< Execute or queue a trigger
+	OP_COLOR,		///< Start a new text color
+	OP_BREAK,		///< Pause the block until the player continues
+	OP_BLOCK_DIAG,		///< Prevent the dialogue from being skipped
+	OP_SPEED_INCR,		///< Increase the text speed
+	OP_SPEED_DECR,		///< Decrease the text speed
+	OP_SPEED_NORM,		///< Normalize the text speed
+	OP_SHAKE,		///< Shake the screen
+	OP_PAUSE		///< Pause the dialogue for some time
+};
+
+/// A single instruction
+struct _Instruction {
+	Opcode op;		///< The operation
+	int source;		///< Position in the source block where this instruction starts
+	int value;		///< Offset into the text pool, color key, repeat count, or trigger ID
+	int length;		///< Length of a text run
+	int target;		///< Handle of the block a goto trigger jumps to, or -1 if unresolved
+	ustring name;		///< Tag name or trigger operator
+	ustring args;		///< Trigger arguments
+};
+typedef struct _Instruction Instruction;
+
+/// A compiled text block
+struct _Program {
+	UTF32String source;			///< The source block
+	UTF32String text;			///< Characters referenced by text runs and pauses
+	std::vector<Instruction> code;		///< The instructions, in order
+};
+typedef struct _Program Program;
+
+/** Compile a text block into instructions
+  * \param block The source block
+  * \param tagOpen Whether or not a styling tag is already open at the start of the block
+  * \return The compiled block
+*/
+Program compile(const UTF32String &block, bool tagOpen=false);
+
+/** Get the source that remains to be executed in a compiled block
+  * \param program The compiled block
+  * \param pc Index of the next instruction
+  * \param offset Amount of characters of a text run that were already executed
+  * \return The remaining source
+*/
+UTF32String remainingSource(const Program &program, int pc, int offset);
+
+}; // namespace Script
+
+#endif
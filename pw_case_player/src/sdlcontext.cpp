@@ -20,16 +20,20 @@
 // sdlcontext.cpp: implementation of SDLContext class
 
 #include <sstream>
+#include "SDL_image.h"
 #include "SDL_ttf.h"
 #include "SDL_mixer.h"
 
 #include "audio.h"
+#include "clock.h"
 #include "font.h"
 #include "sdlcontext.h"
 #include "iohandler.h"
+#include "profiler.h"
 #include "renderer.h"
 #include "theme.h"
 #include "utilities.h"
+#include "vfs.h"
 
 std::auto_ptr<SDLContext> g_Context;
 
@@ -52,6 +56,9 @@ SDLContext::~SDLContext() {
 	// delete the game engine
 	delete m_Game;
 	
+	// free the resource pack
+	VFS::clear();
+	
 	// close audio channel
 	if (Audio::g_Output)
 		Mix_CloseAudio();
@@ -61,22 +68,32 @@ SDLContext::~SDLContext() {
 }
 
 // initialize basic functionality
-bool SDLContext::init() {
+bool SDLContext::init(bool headless) {
+	// without a display, use a video driver that doesn't need one
+	if (headless)
+		SDL_putenv((char*) "SDL_VIDEODRIVER=dummy");
+	
 	// initialize SDL
-	if (SDL_Init(SDL_INIT_AUDIO | SDL_INIT_VIDEO | SDL_INIT_TIMER)<0) {
+	if (SDL_Init((headless ? 0 : SDL_INIT_AUDIO) | SDL_INIT_VIDEO | SDL_INIT_TIMER)<0) {
 		Utils::alert("Unable to intialize video: '"+ustring(SDL_GetError())+"'");
 		return false;
 	}
 	atexit(SDL_Quit);
 	
-	// seed the random number sequence
-	srand(time(NULL));
+#if SDL_VERSIONNUM(SDL_IMAGE_MAJOR_VERSION, SDL_IMAGE_MINOR_VERSION, SDL_IMAGE_PATCHLEVEL)>=SDL_VERSIONNUM(1, 2, 8)
+	// load the image libraries up front, since images are later decoded from
+	// several threads at once and SDL_image loads them lazily otherwise
+	IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG);
+#endif
+	
+	// seed the random number sequence; headless runs should be repeatable
+	Utils::seedRandom(headless ? 0 : time(NULL));
 	
 	return true;
 }
 
 // initialize video output
-bool SDLContext::initVideo(int width, int height, bool fullscreen) {
+bool SDLContext::initVideo(int width, int height, bool fullscreen, bool vsync) {
 	m_VFlags=SDL_HWPALETTE;
 	m_VFlags |= SDL_OPENGL;
 	
@@ -102,6 +119,9 @@ bool SDLContext::initVideo(int width, int height, bool fullscreen) {
 	// we want double buffering
 	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 	
+	// and optionally wait for the display when swapping buffers
+	SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, (vsync ? 1 : 0));
+	
 	// try to initialize video
 	m_Screen=SDL_SetVideoMode(width, height, 32, m_VFlags);
 	if (!m_Screen) {
@@ -113,6 +133,12 @@ bool SDLContext::initVideo(int width, int height, bool fullscreen) {
 	SDLContext::m_Width=width;
 	SDLContext::m_Height=height;
 	
+	// the driver might not support synchronized swaps
+	int swapControl=0;
+	m_VSync=(vsync && SDL_GL_GetAttribute(SDL_GL_SWAP_CONTROL, &swapControl)==0 && swapControl==1);
+	if (vsync && !m_VSync)
+		Utils::debugMessage("Video: vsync is not supported by the driver");
+	
 	// set up opengl rendering
 	glClearColor(0.0, 0.0, 0.0, 0.0);
 	glClearDepth(1.0f);
@@ -139,6 +165,26 @@ bool SDLContext::initVideo(int width, int height, bool fullscreen) {
 	return true;
 }
 
+// initialize a screen surface without opengl
+bool SDLContext::initNullVideo(int width, int height) {
+	m_VFlags=SDL_SWSURFACE;
+	
+	m_Screen=SDL_SetVideoMode(width, height, 32, m_VFlags);
+	if (!m_Screen) {
+		Utils::alert("Unable to set "+Utils::itoa(width)+"x"+Utils::itoa(height)+" video mode: '"+SDL_GetError()+"'");
+		return false;
+	}
+	
+	// copy values to static variables
+	SDLContext::m_Width=width;
+	SDLContext::m_Height=height;
+	
+	// there is no gl context to draw with
+	Renderer::g_Output=false;
+	
+	return true;
+}
+
 // initialize audio output
 bool SDLContext::initAudio() {
 	// open an audio channel
@@ -150,16 +196,24 @@ bool SDLContext::initAudio() {
 		return false;
 	}
 	
+	// prepare music caching and timing
+	Audio::initMusic();
+	
 	return true;
 }
 
 // initialize the game
-bool SDLContext::initGame(const ustring &pathToCase) {
+bool SDLContext::initGame(const ustring &pathToCase, bool lazyAssets) {
+	Profiler::Scope scope("init game");
+	
 	// allocate new case
 	Case::Case *pcase=new Case::Case;
 	
 	// load the case
-	if (!IO::loadCaseFromFile(pathToCase, *pcase)) {
+	Profiler::begin("load case");
+	bool loaded=IO::loadCaseFromFile(pathToCase, *pcase, lazyAssets);
+	Profiler::end("load case");
+	if (!loaded) {
 		Utils::alert("An unrecoverable error has occurred while loading your case file.");
 		return false;
 	}
@@ -177,7 +231,10 @@ bool SDLContext::initGame(const ustring &pathToCase) {
 	m_Game=new Game(rootPath, pcase);
 	
 	// load stock textures
-	if (!m_Game->loadStockTextures())
+	Profiler::begin("load stock textures");
+	bool stock=m_Game->loadStockTextures();
+	Profiler::end("load stock textures");
+	if (!stock)
 		return false;
 	
 	// add sizes to use
@@ -187,13 +244,15 @@ bool SDLContext::initGame(const ustring &pathToCase) {
 	sizes.push_back(Fonts::FONT_BUTTON_TEXT);
 	
 	// load default ttf fonts
+	Profiler::begin("load fonts");
 	for (int i=0; i<sizes.size(); i++) {
 		if (!Fonts::loadFont("arial.ttf", sizes[i]))
 			Utils::alert("Unable to load font size '"+Utils::itoa(sizes[i])+"'!");
 	}
+	Profiler::end("load fonts");
 	
 	// load our theme
-	if (!IO::loadThemeXML(".temp/data/theme.xml", Theme::g_Theme))
+	if (!IO::loadThemeXML("data/theme.xml", Theme::g_Theme))
 		return false;
 	
 	return true;
@@ -201,17 +260,32 @@ bool SDLContext::initGame(const ustring &pathToCase) {
 
 // render the scene
 void SDLContext::render() {
-	// reset the modelview matrix
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	glLoadIdentity();
+	// everything in this frame is drawn at the same time
+	Clock::beginFrame();
 	
-	glTranslatef(0.0f, 0.0f, -1.0f);
+	// reset the modelview matrix
+	if (Renderer::g_Output) {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glLoadIdentity();
+		
+		glTranslatef(0.0f, 0.0f, -1.0f);
+	}
 	
 	// render the current scene
 	m_Game->render();
 	
+	// show where the time went, on top of everything else
+	Profiler::drawOverlay();
+	
+	// draw whatever is left in the batch
+	Renderer::endFrame();
+	
 	// swap buffers and draw our scene
-	SDL_GL_SwapBuffers();
+	if (Renderer::g_Output) {
+		Profiler::beginPhase(Profiler::PHASE_SWAP);
+		SDL_GL_SwapBuffers();
+		Profiler::endPhase(Profiler::PHASE_SWAP);
+	}
 }
 
 // handle keyboard event
@@ -226,6 +300,9 @@ void SDLContext::onKeyboardEvent(SDL_KeyboardEvent *e) {
 		
 		// set full screen mode
 		m_Screen=SDL_SetVideoMode(m_Width, m_Height, 32, m_VFlags);
+		
+		// the framebuffer was recreated, so retained regions are stale
+		Renderer::invalidateRegions();
 	}
 	
 	// toggle audio mute
@@ -259,6 +336,10 @@ void SDLContext::onKeyboardEvent(SDL_KeyboardEvent *e) {
 		SDL_SaveBMP(m_Screen, ss.str().c_str());
 	}
 	
+	// toggle the profiler overlay
+	else if (e->keysym.sym==SDLK_F6)
+		Profiler::g_Overlay=!Profiler::g_Overlay;
+	
 	/*******************************************************************/
 	// TODO: these two functions are just for debug purposes!
 	//       replace them later with actual save/load screens
@@ -291,4 +372,5 @@ void SDLContext::onMouseEvent(SDL_MouseButtonEvent *e) {
 // constructor
 SDLContext::SDLContext() {
 	m_Screen=NULL;
+	m_VSync=false;
 }
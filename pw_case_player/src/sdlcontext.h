@@ -59,17 +59,32 @@ class SDLContext {
 		int getHeight() const { return m_Height; }
 		
 		/** Initialize basic functionality
+		  * \param headless <b>true</b> to use SDL's dummy video driver and a fixed random seed
 		  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
 		*/
-		bool init();
+		bool init(bool headless=false);
 		
 		/** Initialize video output
 		  * \param width The width of the video context
 		  * \param height The height of the video context
 		  * \param fullscreen Whether or not to enable fullscreen by default
+		  * \param vsync Whether or not to synchronize buffer swaps with the display
 		  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
 		*/
-		bool initVideo(int width, int height, bool fullscreen);
+		bool initVideo(int width, int height, bool fullscreen, bool vsync=false);
+		
+		/** See if buffer swaps are synchronized with the display
+		  * \return <b>true</b> if they are, <b>false</b> otherwise
+		*/
+		bool hasVSync() const { return m_VSync; }
+		
+		/** Initialize a software screen surface without OpenGL.
+		  * Renderer output is disabled, so nothing is drawn to the screen.
+		  * \param width The width of the video context
+		  * \param height The height of the video context
+		  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
+		*/
+		bool initNullVideo(int width, int height);
 		
 		/** Initialize audio output
 		  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
@@ -78,9 +93,10 @@ class SDLContext {
 		
 		/** Initialize the game
 		  * \param pathToCase Path to the case file
+		  * \param lazyAssets <b>true</b> to load case images only when they are needed
 		  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
 		*/
-		bool initGame(const ustring &pathToCase);
+		bool initGame(const ustring &pathToCase, bool lazyAssets=false);
 		
 		/// Render the scene
 		void render();
@@ -107,6 +123,9 @@ class SDLContext {
 		/// Flags passed to set the video mode
 		int m_VFlags;
 		
+		/// Whether buffer swaps wait for the display
+		bool m_VSync;
+		
 		/// The Game engine
 		Game *m_Game;
 		
@@ -20,6 +20,7 @@
 // sprite.cpp: implementation of Sprite class
 
 #include "audio.h"
+#include "clock.h"
 #include "common.h"
 #include "renderer.h"
 #include "sprite.h"
@@ -86,7 +87,7 @@ void Sprite::animate(const Point &p) {
 		return;
 	
 	// get the last frame time and compare it with now
-	int now=SDL_GetTicks();
+	int now=Clock::frame();
 	if (now-m_LastFrame>=frame->time) {
 		// save this time
 		m_LastFrame=now;
@@ -107,6 +108,10 @@ void Sprite::animate(const Point &p) {
 			Audio::playEffect(frame->sfx, Audio::CHANNEL_SCRIPT);
 	}
 	
+	// the next frame is due once this one was shown long enough, unless the animation ended
+	if (anim->loop || m_CurFrame<anim->frames.size()-1)
+		Clock::schedule(m_LastFrame+getCurrentFrame()->time);
+	
 	// draw the current frame
 	Renderer::drawImage(p, Textures::queryTexture(frame->image));
 }
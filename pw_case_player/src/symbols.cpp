@@ -0,0 +1,139 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// symbols.cpp: implementation of Symbols namespace
+
+#include "symbols.h"
+
+namespace Symbols {
+
+std::vector<ustring> g_Names;
+SymbolIndex g_SymbolIndex;
+
+// stock ids, in the same order as the Symbol enum
+static const char *g_StockNames[STOCK_SYMBOL_COUNT]={
+	"an_add_evidence",
+	"an_button_arrow_next",
+	"an_check_btn",
+	"an_confirm_btn",
+	"an_continue_btn",
+	"an_evidence_btn",
+	"an_examine_btn_thin",
+	"an_info_page_button_left",
+	"an_info_page_button_right",
+	"an_new_game_btn",
+	"an_next_btn",
+	"an_present_item_btn",
+	"an_present_top_btn",
+	"an_press_btn",
+	"an_profiles_btn",
+	"an_x_examine_btn_left",
+	"an_x_examine_btn_right",
+	"blueline",
+	"court_overview_c",
+	"court_overview_g",
+	"court_panorama",
+	"defense_bench",
+	"overview_judge",
+	"prosecutor_bench",
+	"scanlines_overlay",
+	"stock_title",
+	"tc_answer_bar",
+	"tc_button_arrow_left",
+	"tc_button_arrow_right",
+	"tc_choice_btn_body",
+	"tc_choice_btn_left",
+	"tc_choice_btn_right",
+	"tc_court_bar_border",
+	"tc_evidence_bar",
+	"tc_examine_btn",
+	"tc_large_btn_left",
+	"tc_large_btn_right",
+	"tc_move_btn",
+	"tc_present_btn",
+	"tc_profiles_bar",
+	"tc_select_bl",
+	"tc_select_br",
+	"tc_select_tl",
+	"tc_select_tr",
+	"tc_small_btn_left",
+	"tc_small_btn_right",
+	"tc_talk_btn",
+	"tc_text_box",
+	"tc_text_box_border",
+	"witness_bench"
+};
+
+}
+
+// intern the stock ids, if that wasn't done yet
+static void registerStock() {
+	if (!Symbols::g_Names.empty())
+		return;
+	
+	for (int i=0; i<Symbols::STOCK_SYMBOL_COUNT; i++) {
+		Symbols::g_Names.push_back(Symbols::g_StockNames[i]);
+		Symbols::g_SymbolIndex[Symbols::g_StockNames[i]]=(Symbols::Symbol) i;
+	}
+}
+
+// intern an id
+Symbols::Symbol Symbols::intern(const ustring &id) {
+	registerStock();
+	
+	SymbolIndex::iterator it=g_SymbolIndex.find(id.raw());
+	if (it!=g_SymbolIndex.end())
+		return (*it).second;
+	
+	// add a new symbol
+	Symbol sym=(Symbol) g_Names.size();
+	g_Names.push_back(id);
+	g_SymbolIndex[id.raw()]=sym;
+	
+	return sym;
+}
+
+// find the symbol of an id
+Symbols::Symbol Symbols::find(const ustring &id) {
+	registerStock();
+	
+	SymbolIndex::iterator it=g_SymbolIndex.find(id.raw());
+	if (it==g_SymbolIndex.end())
+		return NULL_SYMBOL;
+	
+	return (*it).second;
+}
+
+// get the id of a symbol
+const ustring& Symbols::name(Symbol sym) {
+	registerStock();
+	
+	static const ustring empty;
+	if (sym<0 || sym>=g_Names.size())
+		return empty;
+	
+	return g_Names[sym];
+}
+
+// get the amount of symbols
+int Symbols::count() {
+	registerStock();
+	
+	return g_Names.size();
+}
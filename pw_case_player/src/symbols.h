@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// symbols.h: interning of asset, animation and block IDs
+
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <tr1/unordered_map>
+#include <vector>
+
+#include "common.h"
+
+/// Namespace for the table of interned IDs
+namespace Symbols {
+
+/** An interned ID.
+  * Each distinct ID is mapped to a small integer once, so that tables keyed by 
+  * symbol don't need to compare strings. The stock IDs used by the engine itself 
+  * are interned first, in this order, so they are known at compile time.
+*/
+enum Symbol {
+	NULL_SYMBOL=-1,
+	SYM_AN_ADD_EVIDENCE,
+	SYM_AN_BUTTON_ARROW_NEXT,
+	SYM_AN_CHECK_BTN,
+	SYM_AN_CONFIRM_BTN,
+	SYM_AN_CONTINUE_BTN,
+	SYM_AN_EVIDENCE_BTN,
+	SYM_AN_EXAMINE_BTN_THIN,
+	SYM_AN_INFO_PAGE_BUTTON_LEFT,
+	SYM_AN_INFO_PAGE_BUTTON_RIGHT,
+	SYM_AN_NEW_GAME_BTN,
+	SYM_AN_NEXT_BTN,
+	SYM_AN_PRESENT_ITEM_BTN,
+	SYM_AN_PRESENT_TOP_BTN,
+	SYM_AN_PRESS_BTN,
+	SYM_AN_PROFILES_BTN,
+	SYM_AN_X_EXAMINE_BTN_LEFT,
+	SYM_AN_X_EXAMINE_BTN_RIGHT,
+	SYM_BLUELINE,
+	SYM_COURT_OVERVIEW_C,
+	SYM_COURT_OVERVIEW_G,
+	SYM_COURT_PANORAMA,
+	SYM_DEFENSE_BENCH,
+	SYM_OVERVIEW_JUDGE,
+	SYM_PROSECUTOR_BENCH,
+	SYM_SCANLINES_OVERLAY,
+	SYM_STOCK_TITLE,
+	SYM_TC_ANSWER_BAR,
+	SYM_TC_BUTTON_ARROW_LEFT,
+	SYM_TC_BUTTON_ARROW_RIGHT,
+	SYM_TC_CHOICE_BTN_BODY,
+	SYM_TC_CHOICE_BTN_LEFT,
+	SYM_TC_CHOICE_BTN_RIGHT,
+	SYM_TC_COURT_BAR_BORDER,
+	SYM_TC_EVIDENCE_BAR,
+	SYM_TC_EXAMINE_BTN,
+	SYM_TC_LARGE_BTN_LEFT,
+	SYM_TC_LARGE_BTN_RIGHT,
+	SYM_TC_MOVE_BTN,
+	SYM_TC_PRESENT_BTN,
+	SYM_TC_PROFILES_BAR,
+	SYM_TC_SELECT_BL,
+	SYM_TC_SELECT_BR,
+	SYM_TC_SELECT_TL,
+	SYM_TC_SELECT_TR,
+	SYM_TC_SMALL_BTN_LEFT,
+	SYM_TC_SMALL_BTN_RIGHT,
+	SYM_TC_TALK_BTN,
+	SYM_TC_TEXT_BOX,
+	SYM_TC_TEXT_BOX_BORDER,
+	SYM_WITNESS_BENCH,
+	STOCK_SYMBOL_COUNT,
+	SYMBOL_MAX=0x7fffffff	///< Keeps the range of the enum wide enough for interned IDs
+};
+
+/// Hashed index of IDs to symbols
+typedef std::tr1::unordered_map<std::string, Symbol> SymbolIndex;
+
+/// Interned IDs, indexed by symbol
+extern std::vector<ustring> g_Names;
+
+/// Index of interned IDs
+extern SymbolIndex g_SymbolIndex;
+
+/** Intern an ID, adding it to the table if it's not there yet
+  * \param id The ID to intern
+  * \return The symbol for this ID
+*/
+Symbol intern(const ustring &id);
+
+/** Find the symbol of an ID without adding it
+  * \param id The ID to find
+  * \return The symbol for this ID, or NULL_SYMBOL if it was never interned
+*/
+Symbol find(const ustring &id);
+
+/** Get the ID that was interned as a symbol
+  * \param sym The symbol
+  * \return The interned ID
+*/
+const ustring& name(Symbol sym);
+
+/** Get the amount of interned symbols
+  * \return Amount of symbols; valid symbols range from 0 up to this value
+*/
+int count();
+
+}; // namespace Symbols
+
+#endif
@@ -0,0 +1,183 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// textlayout.cpp: implementation of the TextLayout class
+
+#include "textlayout.h"
+
+// constructor
+TextLayout::TextLayout(int size, int width, int maxLines) {
+	reset(size, width, maxLines);
+}
+
+// clear the layout and set new parameters
+void TextLayout::reset(int size, int width, int maxLines) {
+	m_Size=size;
+	m_Width=width;
+	m_MaxLines=maxLines;
+	m_Font=Fonts::queryFont(size);
+	
+	clear();
+}
+
+// remove all characters
+void TextLayout::clear() {
+	m_Glyphs.clear();
+	m_PenX=0;
+	m_Line=0;
+	m_Break=-1;
+	m_LineStart=0;
+	m_Skip=0;
+	m_Escape=false;
+}
+
+// place a character at the end of the layout
+bool TextLayout::append(uchar ch) {
+	// every character gets an entry, but most of them aren't drawn
+	LayoutGlyph glyph={ ch, m_PenX, m_Line*Fonts::SIZE_LINE_BREAK, false };
+	
+	// the two digits following a dialogue pause are its duration
+	if (m_Skip>0) {
+		m_Skip--;
+		m_Glyphs.push_back(glyph);
+		return true;
+	}
+	
+	// a backslash followed by 'n' is a literal line break
+	bool escaped=m_Escape;
+	m_Escape=false;
+	if (ch=='\n' || (escaped && ch=='n')) {
+		if (!newLine()) {
+			m_Escape=escaped;
+			return false;
+		}
+		
+		m_Glyphs.push_back(glyph);
+		return true;
+	}
+	
+	else if (ch=='\\') {
+		m_Escape=true;
+		m_Glyphs.push_back(glyph);
+		return true;
+	}
+	
+	// spaces are the only places where a line can be broken
+	else if (ch==' ') {
+		m_PenX+=Fonts::SIZE_WHITESPACE;
+		m_Glyphs.push_back(glyph);
+		m_Break=m_Glyphs.size();
+		return true;
+	}
+	
+	// dialogue pause control character
+	else if (ch==0x05)
+		m_Skip=2;
+	
+	// see if this glyph is drawn at all
+	const Fonts::GlyphMetrics *m=(m_Font ? Fonts::queryMetrics(m_Font, ch) : NULL);
+	if (!m || ch<=0x05 || Fonts::discardChar(ch)) {
+		m_Glyphs.push_back(glyph);
+		return true;
+	}
+	
+	// break the line if this glyph doesn't fit, unless the line is still empty
+	if (m_PenX>0 && m_PenX+m->width+Fonts::SIZE_CHAR_SPACE>=m_Width) {
+		if (m_Line+1>=m_MaxLines) {
+			m_Escape=escaped;
+			return false;
+		}
+		
+		// move the current word to the next line if it fits there
+		int wordX=(m_Break!=-1 && m_Break<m_Glyphs.size() ? m_Glyphs[m_Break].x : m_PenX);
+		if (wrapPoint()!=-1 && m_PenX-wordX+m->width+Fonts::SIZE_CHAR_SPACE<m_Width)
+			wrap();
+		
+		// otherwise the word is broken at this character
+		else
+			newLine();
+	}
+	
+	glyph.x=m_PenX;
+	glyph.y=m_Line*Fonts::SIZE_LINE_BREAK+m->baseOffset;
+	glyph.visible=true;
+	m_Glyphs.push_back(glyph);
+	
+	m_PenX+=m->width+Fonts::SIZE_CHAR_SPACE;
+	
+	return true;
+}
+
+// lay out an entire string
+int TextLayout::layout(const UTF32String &str) {
+	clear();
+	
+	for (int i=0; i<str.size(); i++) {
+		if (!append(str[i]))
+			return i;
+	}
+	
+	return -1;
+}
+
+// remove characters from the end
+void TextLayout::truncate(int length) {
+	if (length>=m_Glyphs.size())
+		return;
+	
+	// line state can't be unwound, so lay out the remaining characters again
+	std::vector<LayoutGlyph> glyphs(m_Glyphs.begin(), m_Glyphs.begin()+length);
+	clear();
+	
+	for (int i=0; i<glyphs.size(); i++)
+		append(glyphs[i].ch);
+}
+
+// get the last break opportunity on this line
+int TextLayout::wrapPoint() const {
+	return (m_Break>m_LineStart ? m_Break : -1);
+}
+
+// start a new line
+bool TextLayout::newLine() {
+	if (m_Line+1>=m_MaxLines)
+		return false;
+	
+	m_Line++;
+	m_PenX=0;
+	m_Break=-1;
+	m_LineStart=m_Glyphs.size();
+	
+	return true;
+}
+
+// move the last word to a new line
+void TextLayout::wrap() {
+	int shift=(m_Break<m_Glyphs.size() ? m_Glyphs[m_Break].x : m_PenX);
+	
+	for (int i=m_Break; i<m_Glyphs.size(); i++) {
+		m_Glyphs[i].x-=shift;
+		m_Glyphs[i].y+=Fonts::SIZE_LINE_BREAK;
+	}
+	
+	m_Line++;
+	m_PenX-=shift;
+	m_LineStart=m_Break;
+	m_Break=-1;
+}
@@ -0,0 +1,148 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// textlayout.h: the TextLayout class
+
+#ifndef TEXTLAYOUT_H
+#define TEXTLAYOUT_H
+
+#include <vector>
+
+#include "common.h"
+#include "font.h"
+
+/// A single character placed by a TextLayout
+struct _LayoutGlyph {
+	uchar ch;	///< The character
+	int x;		///< X-coordinate relative to the start of the layout
+	int y;		///< Y-coordinate of the glyph's top edge, relative to the start of the layout
+	bool visible;	///< Whether or not the character is drawn
+};
+typedef struct _LayoutGlyph LayoutGlyph;
+
+/** Incremental layout of a page of text.
+  * Characters are appended one at a time, and each is placed using the running 
+  * pen position of the current line, so a page is laid out in linear time. Lines 
+  * are broken after the last space that fits; a word that is wider than a whole 
+  * line is broken at the character that doesn't fit. Every appended character 
+  * gets an entry, including control characters, so indices into the layout are 
+  * the same as indices into the source string.
+*/
+class TextLayout {
+	public:
+		/** Constructor
+		  * \param size The size of the source font
+		  * \param width Pixel width available to each line
+		  * \param maxLines Maximum amount of lines on a page
+		*/
+		TextLayout(int size=Fonts::FONT_STANDARD, int width=0, int maxLines=3);
+		
+		/** Clear the layout and change its parameters
+		  * \param size The size of the source font
+		  * \param width Pixel width available to each line
+		  * \param maxLines Maximum amount of lines on a page
+		*/
+		void reset(int size, int width, int maxLines=3);
+		
+		/// Remove all characters from the layout
+		void clear();
+		
+		/** Place a character at the end of the layout
+		  * If the character doesn't fit on the page, the layout is left unchanged.
+		  * \param ch The character to append
+		  * \return <b>true</b> if the character fit, <b>false</b> if the page is full
+		*/
+		bool append(uchar ch);
+		
+		/** Lay out an entire string, replacing the current contents
+		  * \param str The string to lay out
+		  * \return Index into the string of the first character that didn't fit, or -1 if all did
+		*/
+		int layout(const UTF32String &str);
+		
+		/** Remove characters from the end of the layout
+		  * \param length The amount of characters to keep
+		*/
+		void truncate(int length);
+		
+		/** Get the index of the first character after the last break opportunity on the current line
+		  * \return The index, or -1 if the current line has no break opportunity
+		*/
+		int wrapPoint() const;
+		
+		/** Get the amount of characters in the layout
+		  * \return The amount of characters
+		*/
+		int size() const { return m_Glyphs.size(); }
+		
+		/** Get a laid out character
+		  * \param index Index of the character
+		  * \return The placed character
+		*/
+		const LayoutGlyph& glyph(int index) const { return m_Glyphs[index]; }
+		
+		/** Get the size of the source font
+		  * \return The font size
+		*/
+		int fontSize() const { return m_Size; }
+		
+	private:
+		/** Start a new line
+		  * \return <b>true</b> if there was room for another line, <b>false</b> otherwise
+		*/
+		bool newLine();
+		
+		/// Move the characters after the last break opportunity to a new line
+		void wrap();
+		
+		/// The placed characters
+		std::vector<LayoutGlyph> m_Glyphs;
+		
+		/// The source font
+		Fonts::Font *m_Font;
+		
+		/// Size of the source font
+		int m_Size;
+		
+		/// Width available to each line
+		int m_Width;
+		
+		/// Maximum amount of lines
+		int m_MaxLines;
+		
+		/// Current pen position
+		int m_PenX;
+		
+		/// Current 0 based line
+		int m_Line;
+		
+		/// Index of the first character after the last space on this line, -1 if none
+		int m_Break;
+		
+		/// Index of the first character on this line
+		int m_LineStart;
+		
+		/// Amount of following characters that are arguments of a control character
+		int m_Skip;
+		
+		/// Whether or not the last character was a backslash
+		bool m_Escape;
+};
+
+#endif
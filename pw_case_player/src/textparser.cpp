@@ -22,10 +22,13 @@
 #include <cmath>
 
 #include "audio.h"
+#include "clock.h"
 #include "font.h"
 #include "game.h"
 #include "iohandler.h"
+#include "script.h"
 #include "textparser.h"
+#include "triggers.h"
 #include "utilities.h"
 
 TextParser *g_TextParser=NULL;
@@ -33,12 +36,16 @@ TextParser *g_TextParser=NULL;
 // constructor
 TextParser::TextParser(Game *game): m_Game(game) {
 	// reset and prepare the parser
+	m_Program=&m_OwnedProgram;
 	reset();
 	clearFormatting();
 	
 	// reset variables
 	m_SpeakerGender=Character::GENDER_MALE;
-	m_Dialogue="";
+	m_PC=0;
+	m_TextPos=0;
+	m_ExecutedBlocks=0;
+	m_Dialogue.clear();
 	m_QueuedFade=STR_NULL;
 	m_QueuedTestimony=STR_NULL;
 	m_QueuedExamination=STR_NULL;
@@ -61,13 +68,25 @@ TextParser* TextParser::instance() {
 
 // set the text block
 void TextParser::setBlock(const ustring &block) {
+	m_OwnedProgram=Script::compile(Utils::toUTF32(block));
+	setBlock(m_OwnedProgram);
+}
+
+// set a compiled text block
+void TextParser::setBlock(const Script::Program &block) {
 	reset();
 	
 	// set this block
-	m_Block=block;
+	m_Program=&block;
+	m_PC=0;
+	m_TextPos=0;
+	m_ExecutedBlocks++;
 	m_Pause=true;
 	m_Done=false;
 	
+	// start loading what the next few blocks will show
+	m_Game->prefetchScript(block);
+	
 	// proceed directly to the next block if requested
 	if (m_Direct) {
 		m_Pause=false;
@@ -84,10 +103,20 @@ void TextParser::reset() {
 	m_TalkLocked=false;
 	m_CurTag="";
 	m_NextBlock=STR_NULL;
+	m_NextHandle=Case::NULL_BLOCK;
 	
 	m_LastChar=0;
 }
 
+// append a character to the dialogue
+bool TextParser::appendDialogue(uchar ch) {
+	if (!m_Layout.append(ch))
+		return false;
+	
+	m_Dialogue+=ch;
+	return true;
+}
+
 // parse the given control block
 ustring TextParser::parse(bool drawDialogue) {
 	// if we are done parsing, return here
@@ -95,23 +124,25 @@ ustring TextParser::parse(bool drawDialogue) {
 		return STR_NULL;
 	
 	// if there is a timed paused, wait it out
-	if (m_TimedGoto!=0) {
-		m_TimedGoto-=1;
+	if (m_TimedGoto>0) {
+		m_TimedGoto-=Clock::delta();
 		
 		// once we have timed out, proceed to next block
-		if (m_TimedGoto==0)
+		if (m_TimedGoto<=0) {
+			m_TimedGoto=0;
 			nextStep();
+		}
+		else
+			Clock::schedule(Clock::frame()+m_TimedGoto);
 		
 		return STR_NULL;
 	}
 	
 	// if the parser is not paused, start parsing the set block
 	if (!m_Pause) {
-		// erase up to this point
-		m_Block.erase(0, m_BreakPoint);
-		
 		// reset variables
-		m_Dialogue="";
+		m_Dialogue.clear();
+		m_Layout.reset(Fonts::FONT_STANDARD, SDL_GetVideoSurface()->w-16);
 		m_BlockDiag=false;
 		m_StrPos=1;
 		m_FontStyle.colors.clear();
@@ -119,205 +150,176 @@ ustring TextParser::parse(bool drawDialogue) {
 		// the current color and its starting point
 		static std::pair<char, int> color=std::pair<char, int>('\0', -1);
 		
-		// start going over block
+		// whether everything since the last space on the page was plain text, and
+		// the instruction and text run offset where that text starts
+		bool plainWord=false;
+		int wordPC=0, wordOffset=0;
+		
+		// whether the page filled up before the block was done
+		bool pageFull=false;
+		
+		// execute instructions until the page is full or the block is done
 		while(1) {
-			uchar ch=m_Block[0];
-			
-			// tag delimiter
-			if (ch=='<') {
-				// if a tag is already open, this one must close it
-				if (m_TagOpen) {
-					int npos=m_Block.find(">");
-					
-					// erase up to this point
-					m_Block.erase(0, npos+1);
-					
-					m_TagOpen=false;
-				}
-				
-				else {
-					// find the closing tag
-					int npos=m_Block.find(">");
-					m_TagOpen=true;
-					
-					// extract tag name and make it lowercase
-					m_CurTag=m_Block.substr(1, npos-1);
-					
-					// parse this tag
-					parseTag(m_CurTag);
+			// we have completely parsed this block
+			if (blockDone()) {
+				// since the block is done, make sure to close any open colors
+				if (color.second!=-1) {
+					m_FontStyle.colors.push_back(std::make_pair<ValueRange, Color> 
+							(ValueRange(color.second,m_Dialogue.size()-1), Utils::keyToColor(color.first)));
 					
-					// erase up to this point
-					m_Block.erase(0, npos+1);
+					color=std::pair<char, int>('\0', -1);
 				}
 				
-				continue;
+				m_Pause=true;
+				return m_NextBlock;
 			}
 			
-			// trigger
-			else if (ch=='{') {
-				// find trigger op end
-				int npos=m_Block.find(':');
-				
-				// get our trigger operator
-				ustring trigOp=m_Block.substr(2, npos-2);
-				m_Block.erase(0, npos+1);
-				
-				// get trigger command
-				npos=m_Block.find(';');
-				ustring trigComm=m_Block.substr(0, npos);
-				
-				// erase to the end of this trigger
-				int end=m_Block.find('}');
-				m_Block.erase(0, end);
-				
-				// if this trigger is to be preparsed, then do so now
-				if (!preparseTrigger(trigOp)) {
-					// add a hook into the dialogue string
-					m_Dialogue+='^';
-					
-					// and append this trigger
-					m_QueuedTriggers.push_back(std::make_pair<ustring, ustring> (trigOp, trigComm));
-				}
-				
-				else {
-					// execute the trigger right away
-					doTrigger(trigOp, trigComm);
-				}
-				
-				continue;
-			}
+			const Script::Instruction &ins=m_Program->code[m_PC];
+			if (ins.op!=Script::OP_TEXT)
+				plainWord=false;
 			
-			// dialogue control
-			else if (ch=='\\' && m_Block[1]!='n') {
-				char nextChar=m_Block[1];
-				bool erase=true;
-				
-				// check the next character
-				switch(nextChar) {
-					// open a new text color
-					case 'c':
-					case 'g':
-					case 'o':
-					case 'w': {
-						// make sure to close any open colors thus far
-						if (color.second!=-1) {
-							// add this range to the color vector
-							m_FontStyle.colors.push_back(std::make_pair<ValueRange, Color> 
-									(ValueRange(color.second, m_Dialogue.size()-1),
-									 Utils::keyToColor(color.first)));
+			switch(ins.op) {
+				// run of normal characters
+				case Script::OP_TEXT: {
+					while(m_TextPos<ins.length) {
+						uchar ch=m_Program->text[ins.value+m_TextPos];
+						
+						// add this character to the draw string, unless the page is full
+						if (!appendDialogue(ch)) {
+							// rewind to the unfinished word, so it starts the next page
+							int wrap=m_Layout.wrapPoint();
+							if (plainWord && wrap!=-1) {
+								m_PC=wordPC;
+								m_TextPos=wordOffset;
+								m_Dialogue.erase(wrap);
+								m_Layout.truncate(wrap);
+							}
 							
-							color=std::pair<char, int>('\0', -1);
+							m_Pause=true;
+							pageFull=true;
+							break;
 						}
 						
-						// mark where the color itself, and where it first starts
-						color.first=nextChar;
-						color.second=m_Dialogue.size();
-					}; break;
-					
-					// dialogue break
-					case 'b': {
-						m_Pause=true;
-						m_Block.erase(0, 2);
-						return STR_NULL;
-					}; break;
+						m_TextPos++;
+						
+						// words can be moved to the next page if they follow a space
+						if (ch==' ') {
+							plainWord=true;
+							wordPC=m_PC;
+							wordOffset=m_TextPos;
+						}
+					}
 					
-					// set blocking flag
-					case 'd': {
-						m_BlockDiag=true;
-					}; break;
+					// resume from the current position on the next page
+					if (pageFull)
+						break;
 					
-					// increase speed
-					case '+': {
-						int multiplier=atoi(Utils::ucharToStr(m_Block[2]).c_str());
-						
-						for (int i=0; i<multiplier; i++)
-							m_Dialogue+=(uchar) CHAR_TEXT_SPEED_INCR;
+					m_TextPos=0;
+				}; break;
+				
+				// styling tags
+				case Script::OP_TAG_OPEN: {
+					m_TagOpen=true;
+					m_CurTag=ins.name;
+					parseTag(m_CurTag);
+				}; break;
+				
+				case Script::OP_TAG_CLOSE: m_TagOpen=false; break;
+				
+				// trigger
+				case Script::OP_TRIGGER: {
+					// if this trigger is to be preparsed, then do so now
+					Triggers::ID id=(Triggers::ID) ins.value;
+					if (!preparseTrigger(id)) {
+						// add a hook into the dialogue string
+						appendDialogue('^');
 						
-						m_Block.erase(0, 3);
-						erase=false;
-					}; break;
+						// and append this trigger
+						QueuedTrigger trigger;
+						trigger.id=id;
+						trigger.args=ins.args;
+						trigger.target=ins.target;
+						m_QueuedTriggers.push_back(trigger);
+					}
 					
-					// decrease speed
-					case '-': {
-						int multiplier=atoi(Utils::ucharToStr(m_Block[2]).c_str());
-						
-						for (int i=0; i<multiplier; i++)
-							m_Dialogue+=(uchar) CHAR_TEXT_SPEED_DECR;
+					else {
+						// execute the trigger right away
+						doTrigger(id, ins.args, ins.target);
+					}
+				}; break;
+				
+				// open a new text color
+				case Script::OP_COLOR: {
+					// make sure to close any open colors thus far
+					if (color.second!=-1) {
+						// add this range to the color vector
+						m_FontStyle.colors.push_back(std::make_pair<ValueRange, Color> 
+								(ValueRange(color.second, m_Dialogue.size()-1),
+								 Utils::keyToColor(color.first)));
 						
-						m_Block.erase(0, 3);
-						erase=false;
-					}; break;
-					
-					// normalized speed
-					case '=': {
-						m_Dialogue+=(uchar) CHAR_TEXT_SPEED_NORM;
-					}; break;
-					
-					// shake the screen
-					case '*': {
-						m_Dialogue+=(uchar) CHAR_SHAKE_SCREEN;
-					}; break;
+						color=std::pair<char, int>('\0', -1);
+					}
 					
-					// pause the dialogue
-					case 'p': {
-						// set a pause control char along with time (2 bytes)
-						m_Dialogue+=(uchar) CHAR_PAUSE_DIALOGUE;
-						m_Dialogue+=m_Block[2];
-						m_Dialogue+=m_Block[3];
-						
-						m_Block.erase(0, 4);
-						
-						erase=false;
-					}; break;
-				}
+					// mark where the color itself, and where it first starts
+					color.first=(char) ins.value;
+					color.second=m_Dialogue.size();
+				}; break;
 				
-				// erase this sequence of characters
-				if (erase)
-					m_Block.erase(0, 2);
-			}
-			
-			// normal character
-			else {
-				// make sure useless characters aren't dealt with
-				if (ch!='\n') {
-					// add this character to the draw string
-					m_Dialogue+=(uchar) ch;
-					
-					// see if we are over the text limit and need to break
-					if (Fonts::lineWillBreak(Point(8, 134), SDL_GetVideoSurface()->w-8, m_Dialogue, Fonts::FONT_STANDARD)) {
-						m_Pause=true;
-						break;
-					}
-				}
+				// dialogue break
+				case Script::OP_BREAK: {
+					m_Pause=true;
+					m_PC++;
+					return STR_NULL;
+				}; break;
+				
+				// set blocking flag
+				case Script::OP_BLOCK_DIAG: m_BlockDiag=true; break;
+				
+				// increase speed
+				case Script::OP_SPEED_INCR: {
+					for (int i=0; i<ins.value; i++)
+						appendDialogue((uchar) CHAR_TEXT_SPEED_INCR);
+				}; break;
+				
+				// decrease speed
+				case Script::OP_SPEED_DECR: {
+					for (int i=0; i<ins.value; i++)
+						appendDialogue((uchar) CHAR_TEXT_SPEED_DECR);
+				}; break;
+				
+				// normalized speed
+				case Script::OP_SPEED_NORM: appendDialogue((uchar) CHAR_TEXT_SPEED_NORM); break;
 				
-				// erase up to this point
-				m_Block.erase(0, 1);
+				// shake the screen
+				case Script::OP_SHAKE: appendDialogue((uchar) CHAR_SHAKE_SCREEN); break;
+				
+				// pause the dialogue
+				case Script::OP_PAUSE: {
+					// set a pause control char along with time (2 bytes)
+					appendDialogue((uchar) CHAR_PAUSE_DIALOGUE);
+					appendDialogue(m_Program->text[ins.value]);
+					appendDialogue(m_Program->text[ins.value+1]);
+				}; break;
 			}
 			
+			// the rest of the page is drawn below
+			if (pageFull)
+				break;
+			
+			// move on to the next instruction
+			m_PC++;
+			
 			// if we are done parsing, end this loop
 			if (m_Done) {
 				m_Pause=true;
 				
 				return STR_NULL;
 			}
-			
-			// we have completely parsed this block
-			if (m_Block.empty()) {
-				// since the block is done, make sure to close any open colors
-				if (color.second!=-1) {
-					m_FontStyle.colors.push_back(std::make_pair<ValueRange, Color> 
-							(ValueRange(color.second,m_Dialogue.size()-1), Utils::keyToColor(color.first)));
-					
-					color=std::pair<char, int>('\0', -1);
-				}
-				
-				m_Pause=true;
-				return m_NextBlock;
-			}
 		}
 	}
 	
-	else {
+	// draw the page, which may have just been filled
+	if (m_Pause) {
 		// shift the drawing of the string based on state
 		int shift=0;
 		if (m_Game->m_State.requestingEvidence || m_Game->m_State.requestingAnswer)
@@ -325,15 +327,19 @@ ustring TextParser::parse(bool drawDialogue) {
 		
 		// if a pause has occurred, wait it out
 		if (m_PauseDiag!=0) {
-			m_PauseDiag-=1;
+			m_PauseDiag-=Clock::delta();
 			
 			// shouldn't happen, but just in case
 			if (m_PauseDiag<0)
 				m_PauseDiag=0;
 		}
 		
+		// let the main loop know when the next character is due
+		if (m_StrPos<m_Dialogue.size())
+			Clock::schedule(m_PauseDiag>0 ? Clock::frame()+m_PauseDiag : m_LastChar+m_FontStyle.speed+1);
+		
 		// see if we should draw the next character in the string
-		int now=SDL_GetTicks();
+		int now=Clock::frame();
 		if (now-m_LastChar>m_FontStyle.speed && m_StrPos<m_Dialogue.size() && m_PauseDiag==0) {
 			// set the last draw time, and increment string position
 			m_LastChar=now;
@@ -346,7 +352,7 @@ ustring TextParser::parse(bool drawDialogue) {
 				bool b=true;
 				// don't execute certain triggers during cross examination
 				if (m_Game->m_State.curExamination && !m_Game->m_State.curExaminationPaused) {
-					b=!filterTrigger(m_QueuedTriggers.front().first, FILTER_CROSS_EXAMINE);
+					b=!filterTrigger(m_QueuedTriggers.front().id, FILTER_CROSS_EXAMINE);
 					m_QueuedTriggers.pop_front();
 				}
 				
@@ -385,7 +391,7 @@ ustring TextParser::parse(bool drawDialogue) {
 			
 			// shake the screen
 			else if (curChar==(uchar) CHAR_SHAKE_SCREEN)
-				m_Game->m_State.shake=10;
+				m_Game->m_State.shake=SHAKE_TIME;
 			
 			// pause the dialogue
 			else if (curChar==(uchar) CHAR_PAUSE_DIALOGUE) {
@@ -393,10 +399,11 @@ ustring TextParser::parse(bool drawDialogue) {
 				t+=nextChar;
 				t+=m_Dialogue[m_StrPos+1];
 				
-				m_PauseDiag=atoi(t.c_str());
+				// the pause is given in frames
+				m_PauseDiag=atoi(t.c_str())*Clock::FRAME_TIME;
 				
 				// replace the next two bytes with null characters
-				m_Dialogue.replace(m_StrPos, 2, "\0\0");
+				m_Dialogue.replace(m_StrPos, 2, 2, (uchar) 0);
 			}
 			
 			// date string
@@ -431,10 +438,9 @@ ustring TextParser::parse(bool drawDialogue) {
 			if (m_Game->m_State.curExamination && !m_Game->m_State.curExaminationPaused)
 				m_FontStyle.color=Fonts::COLOR_GREEN;
 			
-			// draw the string
+			// draw the string from its layout
 			if (drawDialogue)
-				Fonts::drawStringMulticolor(Point(8, 134+shift, Z_TEXT), m_StrPos, SDL_GetVideoSurface()->w-8, 
-						  m_Dialogue, Fonts::FONT_STANDARD, m_FontStyle.colors);
+				Fonts::drawLayout(Point(8, 134+shift, Z_TEXT), m_Layout, m_StrPos, m_FontStyle.colors);
 			
 			// since the dialog is done, execute queued events
 			if (m_QueuedEvent!=STR_NULL && dialogueDone()) {
@@ -522,7 +528,7 @@ ustring TextParser::parse(bool drawDialogue) {
 void TextParser::nextStep() {
 	// if this block is empty and we didn't find the next one,
 	// then we flag that we're done
-	if (m_Block.empty() && m_NextBlock==STR_NULL && m_StrPos==m_Dialogue.size()) {
+	if (blockDone() && m_NextBlock==STR_NULL && m_StrPos==m_Dialogue.size()) {
 		// draw the previous screen
 		if (m_Game->m_State.prevScreen==SCREEN_EXAMINE)
 			m_Game->toggle(STATE_EXAMINE | STATE_COURT_REC_BTN | STATE_BACK_BTN);
@@ -536,7 +542,8 @@ void TextParser::nextStep() {
 		
 		// also, make sure to end any talk animations
 		m_StrPos=m_Dialogue.size();
-		m_Dialogue="";
+		m_Dialogue.clear();
+		m_Layout.clear();
 		m_Speaker="none";
 		
 		return;
@@ -608,7 +615,7 @@ void TextParser::nextStep() {
 
 // serialize pertinent data to file
 void TextParser::serializeToFile(FILE *f) {
-	IO::writeString(m_Block, f);
+	IO::writeString(Utils::fromUTF32(Script::remainingSource(*m_Program, m_PC, m_TextPos)), f);
 	IO::writeString(m_NextBlock, f);
 	IO::writeString(m_Speaker, f);
 	fwrite(&m_SpeakerGender, sizeof(Character::Gender), 1, f);
@@ -618,7 +625,7 @@ void TextParser::serializeToFile(FILE *f) {
 	fwrite(&m_Direct, sizeof(bool), 1, f);
 	fwrite(&m_BlockDiag, sizeof(bool), 1, f);
 	fwrite(&m_TalkLocked, sizeof(bool), 1, f);
-	IO::writeString(m_Dialogue, f);
+	IO::writeString(Utils::fromUTF32(m_Dialogue), f);
 	fwrite(&m_StrPos, sizeof(int), 1, f);
 	fwrite(&m_LastChar, sizeof(int), 1, f);
 	fwrite(&m_Speed, sizeof(int), 1, f);
@@ -627,8 +634,8 @@ void TextParser::serializeToFile(FILE *f) {
 	
 	int amount=m_QueuedTriggers.size();
 	for (int i=0; i<amount; i++) {
-		IO::writeString(m_QueuedTriggers[i].first, f);
-		IO::writeString(m_QueuedTriggers[i].second, f);
+		IO::writeString(Triggers::info(m_QueuedTriggers[i].id).name, f);
+		IO::writeString(m_QueuedTriggers[i].args, f);
 	}
 	
 	IO::writeString(m_QueuedFade, f);
@@ -644,8 +651,9 @@ void TextParser::serializeToFile(FILE *f) {
 
 // read data from file to text parser
 void TextParser::serializeFromFile(FILE *f) {
-	m_Block=IO::readString(f);
+	UTF32String block=Utils::toUTF32(IO::readString(f));
 	m_NextBlock=IO::readString(f);
+	m_NextHandle=Case::NULL_BLOCK;
 	m_Speaker=IO::readString(f);
 	fread(&m_SpeakerGender, sizeof(Character::Gender), 1, f);
 	fread(&m_BreakPoint, sizeof(int), 1, f);
@@ -654,17 +662,23 @@ void TextParser::serializeFromFile(FILE *f) {
 	fread(&m_Direct, sizeof(bool), 1, f);
 	fread(&m_BlockDiag, sizeof(bool), 1, f);
 	fread(&m_TalkLocked, sizeof(bool), 1, f);
-	m_Dialogue=IO::readString(f);
+	m_Dialogue=Utils::toUTF32(IO::readString(f));
 	fread(&m_StrPos, sizeof(int), 1, f);
 	fread(&m_LastChar, sizeof(int), 1, f);
 	fread(&m_Speed, sizeof(int), 1, f);
 	fread(&m_PauseDiag, sizeof(int), 1, f);
 	fread(&m_TagOpen, sizeof(bool), 1, f);
 	
+	// compile what was left of the block, with the tag state it was left in
+	m_OwnedProgram=Script::compile(block, m_TagOpen);
+	m_Program=&m_OwnedProgram;
+	m_PC=0;
+	m_TextPos=0;
+	
 	int amount=m_QueuedTriggers.size();
 	for (int i=0; i<amount; i++) {
-		IO::writeString(m_QueuedTriggers[i].first, f);
-		IO::writeString(m_QueuedTriggers[i].second, f);
+		IO::writeString(Triggers::info(m_QueuedTriggers[i].id).name, f);
+		IO::writeString(m_QueuedTriggers[i].args, f);
 	}
 	
 	m_QueuedFade=IO::readString(f);
@@ -676,6 +690,10 @@ void TextParser::serializeFromFile(FILE *f) {
 	m_QueuedEventArgs=IO::readString(f);
 	
 	fread(&m_TimedGoto, sizeof(int), 1, f);
+	
+	// the layout isn't saved, so build it again
+	m_Layout.reset(Fonts::FONT_STANDARD, SDL_GetVideoSurface()->w-16);
+	m_Layout.layout(m_Dialogue);
 }
 
 // see if a dialogue sound effect should be played for a given character
@@ -700,23 +718,19 @@ bool TextParser::shouldPlayDialogueEffect(uchar prev, uchar ch, uchar next) {
 }
 
 // see if a trigger should be executed right away
-bool TextParser::preparseTrigger(const ustring &trigger) {
+bool TextParser::preparseTrigger(Triggers::ID trigger) {
 	// in order to keep the script flowing nicely, certain triggers
 	// need to be executed before the script it set in motion
-	if (trigger=="speaker")
-		return true;
-	
-	else
-		return false;
+	return Triggers::info(trigger).preparse;
 }
 
 // see if a trigger matches a filter
-bool TextParser::filterTrigger(const ustring &id, const Filter &filter) {
+bool TextParser::filterTrigger(Triggers::ID trigger, const Filter &filter) {
 	switch(filter) {
 		default:
 		case FILTER_NONE: return false;
 		
-		case FILTER_CROSS_EXAMINE: return true;
+		case FILTER_CROSS_EXAMINE: return Triggers::info(trigger).filterable;
 	}
 }
 
@@ -762,74 +776,71 @@ void TextParser::executeNextTrigger() {
 		return;
 	
 	// get the next queued trigger
-	StringPair trigger=m_QueuedTriggers.front();
+	QueuedTrigger trigger=m_QueuedTriggers.front();
 	
 	// and execute it
-	doTrigger(trigger.first, trigger.second);
+	doTrigger(trigger.id, trigger.args, trigger.target);
 	
 	// get rid of it
 	m_QueuedTriggers.pop_front();
 }
 
 // execute a trigger
-ustring TextParser::doTrigger(const ustring &trigger, const ustring &command) {
+void TextParser::doTrigger(Triggers::ID trigger, const ustring &command, Case::BlockHandle target) {
 	Case::Case *pcase=m_Game->m_Case;
 	
-	// go to another text block
-	if (trigger=="goto")
-		m_NextBlock=command;
-	
-	// go to another text block without pausing
-	else if (trigger=="direct_goto") {
-		m_NextBlock=command;
-		m_Direct=true;
-	}
-	
-	// go to another block following a pause
-	else if (trigger=="timed_goto") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring nextBlock=params[0];
-		int pause=atoi(params[1].c_str());
-		
-		// set the timing
-		m_TimedGoto=pause;
-		m_NextBlock=nextBlock;
-		
-		m_Direct=true;
-	}
-	
-	// hide the text box for a duration
-	else if (trigger=="hide_text_box")
-		m_Game->m_State.hideTextBox=true;
-	
-	// show the text box once more
-	else if (trigger=="show_text_box")
-		m_Game->m_State.hideTextBox=false;
-	
-	// add evidence to court record
-	else if (trigger.find("add_evidence")!=-1) {// make sure this evidence exists at all
-		if (pcase->getEvidence(command)) {
-			// no need to add the same evidence multiple times
-			for (int i=0; i<m_Game->m_State.visibleEvidence.size(); i++) {
-				if (m_Game->m_State.visibleEvidence[i]==command) {
-					Utils::debugMessage("Trigger "+trigger+" has no effect; evidence already in Court Record.");
-					return STR_NULL;
-				}
-			}
+	switch(trigger) {
+		// go to another text block
+		case Triggers::TRIGGER_GOTO: {
+			m_NextBlock=command;
+			m_NextHandle=target;
+		}; break;
+		
+		// go to another text block without pausing
+		case Triggers::TRIGGER_DIRECT_GOTO: {
+			m_NextBlock=command;
+			m_NextHandle=target;
+			m_Direct=true;
+		}; break;
+		
+		// go to another block following a pause
+		case Triggers::TRIGGER_TIMED_GOTO: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring nextBlock=params[0];
+			int pause=atoi(params[1].c_str());
 			
-			// get the type of trigger command
-			int npos=trigger.rfind("_");
-			if (npos==-1)
-				Utils::debugMessage("Trigger add_evidence_* is missing last segment (either silent or animated)");
+			// set the timing, which is given in frames
+			m_TimedGoto=pause*Clock::FRAME_TIME;
+			m_NextBlock=nextBlock;
+			m_NextHandle=target;
 			
-			else {
-				// determine the type of trigger
-				ustring type=trigger.substr(npos+1, trigger.size()-npos-1);
+			m_Direct=true;
+		}; break;
+		
+		// hide the text box for a duration
+		case Triggers::TRIGGER_HIDE_TEXT_BOX: m_Game->m_State.hideTextBox=true; break;
+		
+		// show the text box once more
+		case Triggers::TRIGGER_SHOW_TEXT_BOX: m_Game->m_State.hideTextBox=false; break;
+		
+		// add evidence to court record
+		case Triggers::TRIGGER_ADD_EVIDENCE_SILENT:
+		case Triggers::TRIGGER_ADD_EVIDENCE_ANIMATED: {
+			// make sure this evidence exists at all
+			if (pcase->getEvidence(command)) {
+				// no need to add the same evidence multiple times
+				for (int i=0; i<m_Game->m_State.visibleEvidence.size(); i++) {
+					if (m_Game->m_State.visibleEvidence[i]==command) {
+						Utils::debugMessage(ustring("Trigger ")+Triggers::info(trigger).name+" has no effect; evidence already in Court Record.");
+						return;
+					}
+				}
+				
 				m_Game->m_State.visibleEvidence.push_back(command);
 				
 				// if the type is silent, then don't schedule an animation
-				if (type=="animated") {
+				if (trigger==Triggers::TRIGGER_ADD_EVIDENCE_ANIMATED) {
 					// find the page where the evidence is now in the court record
 					int amount=m_Game->m_State.visibleEvidence.size();
 					if (amount>8)
@@ -844,492 +855,490 @@ ustring TextParser::doTrigger(const ustring &trigger, const ustring &command) {
 					m_Game->m_State.addEvidence=command;
 				}
 			}
-		}
+			
+			else
+				Utils::debugMessage("Unable to add unknown evidence: "+command);
+		}; break;
 		
-		else
-			Utils::debugMessage("Unable to add unknown evidence: "+command);
-	}
-	
-	// add a profile to court record
-	else if (trigger=="add_profile") {
-		// make sure this character exists
-		if (pcase->getCharacter(command))
-			m_Game->m_State.visibleProfiles.push_back(command);
-		else
-			Utils::debugMessage("Unable to add profile for nonexistent character: "+command);
-	}
-	
-	// show evidence on screen
-	else if (trigger=="show_evidence") {
-		StringVector params=Utils::explodeString(',', command);
-		ustring item=params[0];
-		ustring pos=params[1];
-		
-		// given the id, get the actual evidence struct
-		if (pcase->getEvidence(item)) {
-			if (pos=="right")
-				m_Game->setShownEvidence(item, POSITION_RIGHT);
+		// add a profile to court record
+		case Triggers::TRIGGER_ADD_PROFILE: {
+			// make sure this character exists
+			if (pcase->getCharacter(command))
+				m_Game->m_State.visibleProfiles.push_back(command);
 			else
-				m_Game->setShownEvidence(item, POSITION_LEFT);
-		}
+				Utils::debugMessage("Unable to add profile for nonexistent character: "+command);
+		}; break;
 		
-		else
-			Utils::debugMessage("Unable to show nonexistent evidence: "+item);
-	}
-	
-	// hide shown evidence
-	else if (trigger=="hide_evidence")
-		m_Game->setShownEvidence(STR_NULL, POSITION_LEFT);
-	
-	// set a location
-	else if (trigger=="set_location")
-		m_Game->setLocation(command);
-	
-	// make a location accessible
-	else if (trigger=="add_location") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring target=params[0];
-		ustring location=params[1];
-		
-		// add the target to the location, if the location exists
-		if (pcase->getLocation(location)) {
-			Case::Location *tloc=pcase->getLocation(location);
+		// show evidence on screen
+		case Triggers::TRIGGER_SHOW_EVIDENCE: {
+			StringVector params=Utils::explodeString(',', command);
+			ustring item=params[0];
+			ustring pos=params[1];
 			
-			// add the target as an id
-			tloc->moveLocations.push_back(target);
-		}
+			// given the id, get the actual evidence struct
+			if (pcase->getEvidence(item)) {
+				if (pos=="right")
+					m_Game->setShownEvidence(item, POSITION_RIGHT);
+				else
+					m_Game->setShownEvidence(item, POSITION_LEFT);
+			}
+			
+			else
+				Utils::debugMessage("Unable to show nonexistent evidence: "+item);
+		}; break;
 		
-		else
-			Utils::debugMessage("Unable to add location '"+target+"' to non existant '"+location+"' target");
-	}
-	
-	// set a trigger block at a location
-	else if (trigger=="set_location_trigger") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring target=params[0];
-		ustring block=params[1];
-		
-		// get the target location
-		if (pcase->getLocation(target)) {
-			Case::Location *location=pcase->getLocation(target);
+		// hide shown evidence
+		case Triggers::TRIGGER_HIDE_EVIDENCE: m_Game->setShownEvidence(STR_NULL, POSITION_LEFT); break;
+		
+		// set a location
+		case Triggers::TRIGGER_SET_LOCATION: m_Game->setLocation(command); break;
+		
+		// make a location accessible
+		case Triggers::TRIGGER_ADD_LOCATION: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring target=params[0];
+			ustring location=params[1];
 			
-			// set the trigger here
-			location->triggerBlock=block;
-		}
+			// add the target to the location, if the location exists
+			if (pcase->getLocation(location)) {
+				Case::Location *tloc=pcase->getLocation(location);
+				
+				// add the target as an id
+				tloc->moveLocations.push_back(target);
+			}
+			
+			else
+				Utils::debugMessage("Unable to add location '"+target+"' to non existant '"+location+"' target");
+		}; break;
 		
-		else
-			Utils::debugMessage("Unable to set trigger in nonexistent location: "+target);
-	}
-	
-	// set a character's animation
-	else if (trigger=="set_animation") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring ucharName=params[0];
-		ustring anim=params[1];
-		
-		// get the character
-		Character *character=pcase->getCharacter(ucharName);
-		if (character)
-			character->setRootAnimation(anim);
-		else
-			Utils::debugMessage("Trying to clear presentables for nonexistent character: "+command);
-	}
-	
-	// put a character at a location
-	else if (trigger=="put_character") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring character=params[0];
-		ustring target=params[1];
-		
-		// get the target location
-		if (pcase->getLocation(target))
-			pcase->getLocation(target)->character=character;
-		else
-			Utils::debugMessage("Unable to put character '"+character+"' at nonexistant location: "+target);
-	}
-	
-	// add a talk option to a character
-	else if (trigger=="add_talk_option") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring ucharName=params[0];
-		ustring viewString=params[1];
-		ustring blockId=params[2];
-		
-		// get the target character
-		Character *character=pcase->getCharacter(ucharName);
-		if (character)
-			character->addTalkOption(viewString, blockId);
-		else
-			Utils::debugMessage("Unable to add talk option '"+viewString+"' for nonexistent character: "+ucharName);
-	}
-	
-	// remove a talk option
-	else if (trigger=="remove_talk_option") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring ucharName=params[0];
-		ustring viewString=params[1];
-		
-		// get the target character
-		Character *character=pcase->getCharacter(ucharName);
-		if (character)
-			character->removeTalkOption(viewString);
-		else
-			Utils::debugMessage("Unable to remove talk option '"+viewString+"' for nonexistent character: "+ucharName);
-	}
-	
-	// clear talk options
-	else if (trigger=="clear_talk_options") {
-		// get character
-		Character *character=pcase->getCharacter(command);
-		if (character)
-			character->clearTalkOptions();
-		else
-			Utils::debugMessage("Unable to clear talk options for nonexistent character: "+command);
-	}
-	
-	// add a presentable piece of evidence/profile to a character
-	else if (trigger=="add_presentable") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring ucharName=params[0];
-		ustring itemId=params[1];
-		ustring targetBlock=params[2];
-		
-		// get the character
-		Character *character=pcase->getCharacter(ucharName);
-		if (character)
-			character->addPresentable(itemId, targetBlock);
-		else
-			Utils::debugMessage("Unable to add presentable '"+itemId+"' for nonexistent character: "+ucharName);
-	}
-	
-	// remove a piece of presentable evidence/profile
-	else if (trigger=="remove_presentable") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring ucharName=params[0];
-		ustring itemId=params[1];
-		
-		// get the character and remove presentable item
-		Character *character=pcase->getCharacter(ucharName);
-		if (character)
-			character->removePresentable(itemId);
-		else
-			Utils::debugMessage("Unable to remove presentables for nonexistent character: "+ucharName);
-	}
-	
-	// clear character's presentable items
-	else if (trigger=="clear_presentables") {
-		// get the character requested
-		Character *character=pcase->getCharacter(command);
-		if (character)
-			character->clearPresentableItems();
-		else
-			Utils::debugMessage("Unable to clear presentables for nonexistent character: "+command);
-	}
-	
-	// set the block to use when a useless item was presented
-	else if (trigger=="set_bad_presentable_block") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring ucharName=params[0];
-		ustring target=params[1];
-		
-		// get the character
-		Character *character=pcase->getCharacter(ucharName);
-		if (character)
-			character->setBadPresentableBlock(target);
-		else
-			Utils::debugMessage("Unable to set bad presentable block for nonexistent character: "+ucharName);
-	}
-	
-	// set music to be played a location
-	else if (trigger=="set_location_music") {
-		// split this command string
-		std::vector<ustring> params=Utils::explodeString(',', command);
-		ustring musicId=params[0];
-		ustring target=params[1];
-		
-		// if the court was requested, set all court locations to play the same music
-		if (target=="court" || target=="prosecutor_stand" || target=="defense_stand" ||
-		    target=="defense_helper_stand" || target=="witness_stand" || target=="courtroom" ||
-		    target=="judge_stand") {
-			m_Game->m_State.continueMusic=true;
-			pcase->getLocation("prosecutor_stand")->music=musicId;
-			pcase->getLocation("defense_stand")->music=musicId;
-			pcase->getLocation("defense_helper_stand")->music=musicId;
-			pcase->getLocation("witness_stand")->music=musicId;
-			pcase->getLocation("courtroom")->music=musicId;
-			pcase->getLocation("judge_stand")->music=musicId;
-		}
+		// set a trigger block at a location
+		case Triggers::TRIGGER_SET_LOCATION_TRIGGER: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring target=params[0];
+			ustring block=params[1];
+			
+			// get the target location
+			if (pcase->getLocation(target)) {
+				Case::Location *location=pcase->getLocation(target);
+				
+				// set the trigger here
+				location->triggerBlock=block;
+			}
+			
+			else
+				Utils::debugMessage("Unable to set trigger in nonexistent location: "+target);
+		}; break;
 		
-		// get the target location
-		else if (pcase->getLocation(target))
-			pcase->getLocation(target)->music=musicId;
+		// set a character's animation
+		case Triggers::TRIGGER_SET_ANIMATION: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring ucharName=params[0];
+			ustring anim=params[1];
+			
+			// get the character
+			Character *character=pcase->getCharacter(ucharName);
+			if (character)
+				character->setRootAnimation(anim);
+			else
+				Utils::debugMessage("Trying to clear presentables for nonexistent character: "+command);
+		}; break;
 		
-		else
-			Utils::debugMessage("Unable to set music "+musicId+" at unknown location: "+target);
-	}
-	
-	// clear any music set at a location
-	else if (trigger=="clear_location_music") {
-		// get the target location
-		if (pcase->getLocation(command))
-			pcase->getLocation(command)->music=STR_NULL;
-	}
-	
-	// flag that requires player to present evidence or answer
-	else if (trigger=="request_evidence" || trigger=="request_answer" || trigger=="request_image_contradiction") {
-		m_QueuedEvent=trigger;
-		m_QueuedEventArgs=command;
-	}
-	
-	// play a sample of music
-	else if (trigger=="play_music")
-		Audio::playMusic(command);
-	
-	// halt the current music
-	else if (trigger=="halt_music")
-		Audio::haltMusic();
-	
-	// play a sound effect
-	else if (trigger=="sfx") {
-		// always play sound effects on their own channel
-		Audio::playEffect(command, Audio::CHANNEL_SCRIPT);
-	}
-	
-	// schedule a fade effect with given speed
-	else if (trigger=="fade_out") {
-		// queue this fade effect
-		m_QueuedFade=command;
-	}
-	
-	// schedule a flash effect
-	else if (trigger=="flash")
-		m_Game->m_State.flash="top";
-	
-	// schedule a special effect
-	else if (trigger=="special_effect") {
-		StringVector params=Utils::explodeString(',', command);
-		
-		// a gavel sprite (one hit)
-		if (params[0]=="gavel") {
-			// make sure to reset the animation
-			pcase->getCharacter("gavel")->getSprite()->reset();
-			pcase->getCharacter("gavel")->getSprite()->setAnimation("normal_idle");
+		// put a character at a location
+		case Triggers::TRIGGER_PUT_CHARACTER: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring character=params[0];
+			ustring target=params[1];
 			
-			// and schedule the event
-			m_Game->m_State.gavel="1";
-		}
+			// get the target location
+			if (pcase->getLocation(target))
+				pcase->getLocation(target)->character=character;
+			else
+				Utils::debugMessage("Unable to put character '"+character+"' at nonexistant location: "+target);
+		}; break;
 		
-		// zoom up to character's face, with animated, blue background
-		else if (params[0].find("zoom")!=-1) {
-			pcase->getLocation(params[0]+"_"+params[1])->character=params[2];
-			m_Game->setLocation(params[0]+"_"+params[1]);
-		}
-	}
-	
-	// schedule a court camera event
-	else if (trigger=="move_court_camera")
-		m_Game->m_State.courtCamera=command;
-	
-	// set the current speaker
-	else if (trigger=="speaker") {
-		// copy speaker id
-		m_Speaker=command;
-		
-		// get character gender
-		if (pcase->getCharacter(m_Speaker))
-			m_SpeakerGender=pcase->getCharacter(m_Speaker)->getGender();
-	}
-	
-	// set images for courtroom overview
-	else if (trigger=="set_court_overview_image") {
-		// split the command string
-		StringVector params=Utils::explodeString(',', command);
-		ustring area=params[0];
-		ustring image=params[1];
-		
-		// depending on area, set image
-		if (area=="defense")
-			m_Game->m_State.crOverviewDefense=image;
-		else if (area=="prosecutor")
-			m_Game->m_State.crOverviewProsecutor=image;
-		else if (area=="witness")
-			m_Game->m_State.crOverviewWitness=image;
-		else
-			Utils::debugMessage("No such area in courtroom overview: '"+area);
-	}
-	
-	// set an image to be displayed over location background
-	else if (trigger=="set_temp_image")
-		m_Game->m_State.tempImage=command;
-	
-	// hide a set temporary image
-	else if (trigger=="hide_temp_image")
-		m_Game->m_State.tempImage=STR_NULL;
-	
-	// display a testimony
-	else if (trigger=="display_testimony") {
-		m_QueuedTestimony=command;
+		// add a talk option to a character
+		case Triggers::TRIGGER_ADD_TALK_OPTION: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring ucharName=params[0];
+			ustring viewString=params[1];
+			ustring blockId=params[2];
+			
+			// get the target character
+			Character *character=pcase->getCharacter(ucharName);
+			if (character)
+				character->addTalkOption(viewString, blockId);
+			else
+				Utils::debugMessage("Unable to add talk option '"+viewString+"' for nonexistent character: "+ucharName);
+		}; break;
 		
-		// preset a new block and start testimony directly after this block
-		m_NextBlock="INTERNAL_testimony";
-		m_Direct=true;
-	}
-	
-	// begin cross examining a witness
-	else if (trigger=="cross_examine") {
-		m_QueuedExamination=command;
+		// remove a talk option
+		case Triggers::TRIGGER_REMOVE_TALK_OPTION: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring ucharName=params[0];
+			ustring viewString=params[1];
+			
+			// get the target character
+			Character *character=pcase->getCharacter(ucharName);
+			if (character)
+				character->removeTalkOption(viewString);
+			else
+				Utils::debugMessage("Unable to remove talk option '"+viewString+"' for nonexistent character: "+ucharName);
+		}; break;
 		
-		// present a new block, and start cross examination afterwards
-		m_NextBlock="INTERNAL_cross_examination";
-		m_Direct=true;
-	}
-	
-	// resume a cross examination
-	else if (trigger=="resume_cross_examination") {
-		m_QueuedResume=command;
+		// clear talk options
+		case Triggers::TRIGGER_CLEAR_TALK_OPTIONS: {
+			// get character
+			Character *character=pcase->getCharacter(command);
+			if (character)
+				character->clearTalkOptions();
+			else
+				Utils::debugMessage("Unable to clear talk options for nonexistent character: "+command);
+		}; break;
 		
-		// go to a blank block to resume
-		doTrigger("goto", "INTERNAL_blank");
-	}
-	
-	// change the gender of a character
-	else if (trigger=="change_character_gender") {
-		StringVector params=Utils::explodeString(',', command);
-		
-		// first, validate the character
-		Character *c=pcase->getCharacter(params[0]);
-		if (c) {
-			// check gender string
-			if (params[1]=="male")
-				c->setGender(Character::GENDER_MALE);
-			else if (params[1]=="female")
-				c->setGender(Character::GENDER_FEMALE);
-			else if (params[1]=="unknown")
-				c->setGender(Character::GENDER_UNKNOWN);
+		// add a presentable piece of evidence/profile to a character
+		case Triggers::TRIGGER_ADD_PRESENTABLE: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring ucharName=params[0];
+			ustring itemId=params[1];
+			ustring targetBlock=params[2];
+			
+			// get the character
+			Character *character=pcase->getCharacter(ucharName);
+			if (character)
+				character->addPresentable(itemId, targetBlock);
 			else
-				Utils::debugMessage("Unrecognized character gender: "+params[1]);
-		}
+				Utils::debugMessage("Unable to add presentable '"+itemId+"' for nonexistent character: "+ucharName);
+		}; break;
 		
-		else
-			Utils::debugMessage("Unknown character: "+params[0]);
-	}
-	
-	// change the profile of a character
-	else if (trigger=="change_character_name" || trigger=="change_character_caption" || trigger=="change_character_desc") {
-		StringVector params=Utils::explodeString(',', command);
-		
-		// get the character
-		Character *c=pcase->getCharacter(params[0]);
-		if (c) {
-			// verify that the string is padded by quote marks
-			ustring str=params[1];
-			if (str[0]!='"' || str[str.size()-1]!='"') {
-				Utils::debugMessage("Character profile string needs to be in between quotation marks: "+str);
-				return STR_NULL;
+		// remove a piece of presentable evidence/profile
+		case Triggers::TRIGGER_REMOVE_PRESENTABLE: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring ucharName=params[0];
+			ustring itemId=params[1];
+			
+			// get the character and remove presentable item
+			Character *character=pcase->getCharacter(ucharName);
+			if (character)
+				character->removePresentable(itemId);
+			else
+				Utils::debugMessage("Unable to remove presentables for nonexistent character: "+ucharName);
+		}; break;
+		
+		// clear character's presentable items
+		case Triggers::TRIGGER_CLEAR_PRESENTABLES: {
+			// get the character requested
+			Character *character=pcase->getCharacter(command);
+			if (character)
+				character->clearPresentableItems();
+			else
+				Utils::debugMessage("Unable to clear presentables for nonexistent character: "+command);
+		}; break;
+		
+		// set the block to use when a useless item was presented
+		case Triggers::TRIGGER_SET_BAD_PRESENTABLE_BLOCK: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring ucharName=params[0];
+			ustring target=params[1];
+			
+			// get the character
+			Character *character=pcase->getCharacter(ucharName);
+			if (character)
+				character->setBadPresentableBlock(target);
+			else
+				Utils::debugMessage("Unable to set bad presentable block for nonexistent character: "+ucharName);
+		}; break;
+		
+		// set music to be played a location
+		case Triggers::TRIGGER_SET_LOCATION_MUSIC: {
+			// split this command string
+			std::vector<ustring> params=Utils::explodeString(',', command);
+			ustring musicId=params[0];
+			ustring target=params[1];
+			
+			// if the court was requested, set all court locations to play the same music
+			if (target=="court" || target=="prosecutor_stand" || target=="defense_stand" ||
+			    target=="defense_helper_stand" || target=="witness_stand" || target=="courtroom" ||
+			    target=="judge_stand") {
+				m_Game->m_State.continueMusic=true;
+				pcase->getLocation("prosecutor_stand")->music=musicId;
+				pcase->getLocation("defense_stand")->music=musicId;
+				pcase->getLocation("defense_helper_stand")->music=musicId;
+				pcase->getLocation("witness_stand")->music=musicId;
+				pcase->getLocation("courtroom")->music=musicId;
+				pcase->getLocation("judge_stand")->music=musicId;
 			}
 			
-			// remove padding quote marks
-			str.erase(0, 1);
-			str.erase(str.size()-1, 1);
+			// get the target location
+			else if (pcase->getLocation(target))
+				pcase->getLocation(target)->music=musicId;
 			
-			// and set the new string
-			if (trigger.rfind("_name")!=-1)
-				c->setName(str);
-			else if (trigger.rfind("_caption")!=-1)
-				c->setCaption(str);
-			else if (trigger.rfind("_desc")!=-1)
-				c->setDescription(str);
-		}
+			else
+				Utils::debugMessage("Unable to set music "+musicId+" at unknown location: "+target);
+		}; break;
 		
-		else
-			Utils::debugMessage("Unknown character: "+params[0]);
-	}
-	
-	// change evidence data
-	else if (trigger=="change_evidence_name" || trigger=="change_evidence_caption" || trigger=="change_evidence_desc") {
-		StringVector params=Utils::explodeString(',', command);
-		
-		// get the evidence
-		Case::Evidence *e=pcase->getEvidence(params[0]);
-		if (e) {
-			// verify that the string is padded by quote marks
-			ustring str=params[1];
-			if (str[0]!='"' || str[str.size()-1]!='"') {
-				Utils::debugMessage("Evidence data string needs to be in between quotation marks: "+str);
-				return STR_NULL;
+		// clear any music set at a location
+		case Triggers::TRIGGER_CLEAR_LOCATION_MUSIC: {
+			// get the target location
+			if (pcase->getLocation(command))
+				pcase->getLocation(command)->music=STR_NULL;
+		}; break;
+		
+		// flag that requires player to present evidence or answer
+		case Triggers::TRIGGER_REQUEST_EVIDENCE:
+		case Triggers::TRIGGER_REQUEST_ANSWER:
+		case Triggers::TRIGGER_REQUEST_IMAGE_CONTRADICTION: {
+			m_QueuedEvent=Triggers::info(trigger).name;
+			m_QueuedEventArgs=command;
+		}; break;
+		
+		// play a sample of music
+		case Triggers::TRIGGER_PLAY_MUSIC: Audio::playMusic(command); break;
+		
+		// halt the current music
+		case Triggers::TRIGGER_HALT_MUSIC: Audio::haltMusic(); break;
+		
+		// play a sound effect
+		case Triggers::TRIGGER_SFX: {
+			// always play sound effects on their own channel
+			Audio::playEffect(command, Audio::CHANNEL_SCRIPT);
+		}; break;
+		
+		// schedule a fade effect with given speed
+		case Triggers::TRIGGER_FADE_OUT: {
+			// queue this fade effect
+			m_QueuedFade=command;
+		}; break;
+		
+		// schedule a flash effect
+		case Triggers::TRIGGER_FLASH: m_Game->m_State.flash="top"; break;
+		
+		// schedule a special effect
+		case Triggers::TRIGGER_SPECIAL_EFFECT: {
+			StringVector params=Utils::explodeString(',', command);
+			
+			// a gavel sprite (one hit)
+			if (params[0]=="gavel") {
+				// make sure to reset the animation
+				pcase->getCharacter("gavel")->getSprite()->reset();
+				pcase->getCharacter("gavel")->getSprite()->setAnimation("normal_idle");
+				
+				// and schedule the event
+				m_Game->m_State.gavel="1";
 			}
 			
-			// remove padding quote marks
-			str.erase(0, 1);
-			str.erase(str.size()-1, 1);
+			// zoom up to character's face, with animated, blue background
+			else if (params[0].find("zoom")!=-1) {
+				pcase->getLocation(params[0]+"_"+params[1])->character=params[2];
+				m_Game->setLocation(params[0]+"_"+params[1]);
+			}
+		}; break;
+		
+		// schedule a court camera event
+		case Triggers::TRIGGER_MOVE_COURT_CAMERA: m_Game->m_State.courtCamera=command; break;
+		
+		// set the current speaker
+		case Triggers::TRIGGER_SPEAKER: {
+			// copy speaker id
+			m_Speaker=command;
 			
-			// and set the new string
-			if (trigger.rfind("_name")!=-1)
-				e->name=str;
-			else if (trigger.rfind("_caption")!=-1)
-				e->caption=str;
-			else if (trigger.rfind("_desc")!=-1)
-				e->description=str;
-		}
+			// get character gender
+			if (pcase->getCharacter(m_Speaker))
+				m_SpeakerGender=pcase->getCharacter(m_Speaker)->getGender();
+		}; break;
 		
-		else
-			Utils::debugMessage("Unknown evidence: "+params[0]);
-	}
-	
-	// set the state of a location
-	else if (trigger=="set_location_state") {
-		StringVector params=Utils::explodeString(',', command);
-		
-		// check the location
-		Case::Location *location=pcase->getLocation(params[0]);
-		if (location) {
-			// verify state
-			if (location->states.find(params[1])==location->states.end())
-				Utils::debugMessage("State '"+params[1]+"' doesn't exist in location '"+params[0]+"'.");
+		// set images for courtroom overview
+		case Triggers::TRIGGER_SET_COURT_OVERVIEW_IMAGE: {
+			// split the command string
+			StringVector params=Utils::explodeString(',', command);
+			ustring area=params[0];
+			ustring image=params[1];
 			
+			// depending on area, set image
+			if (area=="defense")
+				m_Game->m_State.crOverviewDefense=image;
+			else if (area=="prosecutor")
+				m_Game->m_State.crOverviewProsecutor=image;
+			else if (area=="witness")
+				m_Game->m_State.crOverviewWitness=image;
 			else
-				location->state=params[1];
-		}
+				Utils::debugMessage("No such area in courtroom overview: '"+area);
+		}; break;
 		
-		else
-			Utils::debugMessage("Unknown location: "+params[0]);
-	}
-	
-	// fade out the background to black
-	else if (trigger=="fade_bg")
-		m_Game->m_State.alphaDecay="an_bg_alpha";
-	
-	// restore a faded out background
-	else if (trigger=="restore_bg")
-		m_Game->m_State.bgFade=255;
-	
-	// perform a flash back to image
-	else if (trigger=="flashback_image") {
-		// verify that this image exists
-		if (!pcase->getImage(command))
-			Utils::debugMessage("Image '"+command+"' for trigger flashback_image doesn't exist.");
+		// set an image to be displayed over location background
+		case Triggers::TRIGGER_SET_TEMP_IMAGE: m_Game->m_State.tempImage=command; break;
 		
-		else
-			m_Game->m_State.whiteFlash=command;
-	}
-	
-	// yell an exclamation
-	else if (trigger=="hold_it" || trigger=="objection" || trigger=="take_that") {
-		// check for existance of sound effect
-		if (command=="none" || (command!="none" && Audio::queryAudio(command)))
-			m_Game->m_State.exclamation="an_"+trigger+","+(command=="none" ? "null" : command);
-		else
-			Utils::debugMessage("Sound effect '"+command+"' for exclamation trigger "+trigger+" doesn't exist.");
+		// hide a set temporary image
+		case Triggers::TRIGGER_HIDE_TEMP_IMAGE: m_Game->m_State.tempImage=STR_NULL; break;
+		
+		// display a testimony
+		case Triggers::TRIGGER_DISPLAY_TESTIMONY: {
+			m_QueuedTestimony=command;
+			
+			// preset a new block and start testimony directly after this block
+			m_NextBlock="INTERNAL_testimony";
+			m_Direct=true;
+		}; break;
+		
+		// begin cross examining a witness
+		case Triggers::TRIGGER_CROSS_EXAMINE: {
+			m_QueuedExamination=command;
+			
+			// present a new block, and start cross examination afterwards
+			m_NextBlock="INTERNAL_cross_examination";
+			m_Direct=true;
+		}; break;
+		
+		// resume a cross examination
+		case Triggers::TRIGGER_RESUME_CROSS_EXAMINATION: {
+			m_QueuedResume=command;
+			
+			// go to a blank block to resume
+			doTrigger(Triggers::TRIGGER_GOTO, "INTERNAL_blank");
+		}; break;
+		
+		// change the gender of a character
+		case Triggers::TRIGGER_CHANGE_CHARACTER_GENDER: {
+			StringVector params=Utils::explodeString(',', command);
+			
+			// first, validate the character
+			Character *c=pcase->getCharacter(params[0]);
+			if (c) {
+				// check gender string
+				if (params[1]=="male")
+					c->setGender(Character::GENDER_MALE);
+				else if (params[1]=="female")
+					c->setGender(Character::GENDER_FEMALE);
+				else if (params[1]=="unknown")
+					c->setGender(Character::GENDER_UNKNOWN);
+				else
+					Utils::debugMessage("Unrecognized character gender: "+params[1]);
+			}
+			
+			else
+				Utils::debugMessage("Unknown character: "+params[0]);
+		}; break;
+		
+		// change the profile of a character
+		case Triggers::TRIGGER_CHANGE_CHARACTER_NAME:
+		case Triggers::TRIGGER_CHANGE_CHARACTER_CAPTION:
+		case Triggers::TRIGGER_CHANGE_CHARACTER_DESC: {
+			StringVector params=Utils::explodeString(',', command);
+			
+			// get the character
+			Character *c=pcase->getCharacter(params[0]);
+			if (c) {
+				// verify that the string is padded by quote marks
+				ustring str=params[1];
+				if (str[0]!='"' || str[str.size()-1]!='"') {
+					Utils::debugMessage("Character profile string needs to be in between quotation marks: "+str);
+					return;
+				}
+				
+				// remove padding quote marks
+				str.erase(0, 1);
+				str.erase(str.size()-1, 1);
+				
+				// and set the new string
+				if (trigger==Triggers::TRIGGER_CHANGE_CHARACTER_NAME)
+					c->setName(str);
+				else if (trigger==Triggers::TRIGGER_CHANGE_CHARACTER_CAPTION)
+					c->setCaption(str);
+				else
+					c->setDescription(str);
+			}
+			
+			else
+				Utils::debugMessage("Unknown character: "+params[0]);
+		}; break;
+		
+		// change evidence data
+		case Triggers::TRIGGER_CHANGE_EVIDENCE_NAME:
+		case Triggers::TRIGGER_CHANGE_EVIDENCE_CAPTION:
+		case Triggers::TRIGGER_CHANGE_EVIDENCE_DESC: {
+			StringVector params=Utils::explodeString(',', command);
+			
+			// get the evidence
+			Case::Evidence *e=pcase->getEvidence(params[0]);
+			if (e) {
+				// verify that the string is padded by quote marks
+				ustring str=params[1];
+				if (str[0]!='"' || str[str.size()-1]!='"') {
+					Utils::debugMessage("Evidence data string needs to be in between quotation marks: "+str);
+					return;
+				}
+				
+				// remove padding quote marks
+				str.erase(0, 1);
+				str.erase(str.size()-1, 1);
+				
+				// and set the new string
+				if (trigger==Triggers::TRIGGER_CHANGE_EVIDENCE_NAME)
+					e->name=str;
+				else if (trigger==Triggers::TRIGGER_CHANGE_EVIDENCE_CAPTION)
+					e->caption=str;
+				else
+					e->description=str;
+			}
+			
+			else
+				Utils::debugMessage("Unknown evidence: "+params[0]);
+		}; break;
+		
+		// set the state of a location
+		case Triggers::TRIGGER_SET_LOCATION_STATE: {
+			StringVector params=Utils::explodeString(',', command);
+			
+			// check the location
+			Case::Location *location=pcase->getLocation(params[0]);
+			if (location) {
+				// verify state
+				if (location->states.find(params[1])==location->states.end())
+					Utils::debugMessage("State '"+params[1]+"' doesn't exist in location '"+params[0]+"'.");
+				
+				else
+					location->state=params[1];
+			}
+			
+			else
+				Utils::debugMessage("Unknown location: "+params[0]);
+		}; break;
+		
+		// fade out the background to black
+		case Triggers::TRIGGER_FADE_BG: m_Game->m_State.alphaDecay="an_bg_alpha"; break;
+		
+		// restore a faded out background
+		case Triggers::TRIGGER_RESTORE_BG: m_Game->m_State.bgFade=255; break;
+		
+		// perform a flash back to image
+		case Triggers::TRIGGER_FLASHBACK_IMAGE: {
+			// verify that this image exists
+			if (!pcase->getImage(command))
+				Utils::debugMessage("Image '"+command+"' for trigger flashback_image doesn't exist.");
+			
+			else
+				m_Game->m_State.whiteFlash=command;
+		}; break;
+		
+		// yell an exclamation
+		case Triggers::TRIGGER_HOLD_IT:
+		case Triggers::TRIGGER_OBJECTION:
+		case Triggers::TRIGGER_TAKE_THAT: {
+			// check for existance of sound effect
+			if (command=="none" || (command!="none" && Audio::queryAudio(command)))
+				m_Game->m_State.exclamation=ustring("an_")+Triggers::info(trigger).name+","+(command=="none" ? "null" : command);
+			else
+				Utils::debugMessage("Sound effect '"+command+"' for exclamation trigger "+Triggers::info(trigger).name+" doesn't exist.");
+		}; break;
+		
+		default: break;
 	}
-	
-	return STR_NULL;
 }
@@ -26,7 +26,11 @@
 #include <deque>
 #include <map>
 
+#include "case.h"
 #include "common.h"
+#include "script.h"
+#include "textlayout.h"
+#include "triggers.h"
 
 class Game;
 class ValueRange;
@@ -40,6 +44,14 @@ struct _FontStyle {
 };
 typedef struct _FontStyle FontStyle;
 
+/// Struct that stores a trigger waiting to be executed
+struct _QueuedTrigger {
+	Triggers::ID id;	///< The resolved trigger
+	ustring args;		///< The trigger arguments
+	int target;		///< Handle of the block a goto jumps to, or -1 if unresolved
+};
+typedef struct _QueuedTrigger QueuedTrigger;
+
 /** The parser and trigger handler for the game script.
   * The TextParser class forms the foundation of the entire game engine. It 
   * handles text blocks, extracts and draws dialogue strings with correct timing, 
@@ -63,6 +75,7 @@ class TextParser {
 		
 		// constants
 		static const int NORMAL_FONT_SPEED=50;		///< Regular text speed
+		static const int SHAKE_TIME=160;		///< Time the screen shakes for, in milliseconds
 		
 		/** Constructor
 		  * \param game Pointer to the Game engine object
@@ -79,6 +92,12 @@ class TextParser {
 		*/
 		void setBlock(const ustring &block);
 		
+		/** Set a compiled text block to parse
+		  * The block is not copied, and must stay valid while it's being parsed.
+		  * \param block The block to parse
+		*/
+		void setBlock(const Script::Program &block);
+		
 		/// Reset the parser
 		void reset();
 		
@@ -123,6 +142,16 @@ class TextParser {
 		*/
 		ustring getSpeaker() const { return m_Speaker; }
 		
+		/** Get the resolved handle of the block the parser moves on to
+		  * \return Handle of the next block, or Case::NULL_BLOCK if it needs to be looked up by ID
+		*/
+		Case::BlockHandle getNextHandle() const { return m_NextHandle; }
+		
+		/** Get the amount of blocks that were set to be parsed so far
+		  * \return Number of executed blocks
+		*/
+		int getExecutedBlocks() const { return m_ExecutedBlocks; }
+		
 		/** Parse the given control block
 		  * \param drawDialogue Flag whether or not to draw the dialogue text
 		  * \return ID of next block to parse, STR_NULL if no other block is to follow
@@ -155,14 +184,25 @@ class TextParser {
 		  * \param trigger The trigger to test
 		  * \return <b>true</b> to execute immediately, <b>false</b> otherwise
 		*/
-		bool preparseTrigger(const ustring &trigger);
+		bool preparseTrigger(Triggers::ID trigger);
 		
 		/** See if a trigger matches a filter
 		  * \param trigger The trigger to test
 		  * \param filter The filter to test against
 		  * \return <b>true</b> if the trigger should be filtered, <b>false</b> otherwise
 		*/
-		bool filterTrigger(const ustring &trigger, const Filter &filter);
+		bool filterTrigger(Triggers::ID trigger, const Filter &filter);
+		
+		/** See if the entire block was executed
+		  * \return <b>true</b> if there are no instructions left, <b>false</b> otherwise
+		*/
+		bool blockDone() const { return m_PC>=m_Program->code.size(); }
+		
+		/** Append a character to the dialogue string and its layout
+		  * \param ch The character to append
+		  * \return <b>true</b> if the character fit on the page, <b>false</b> otherwise
+		*/
+		bool appendDialogue(uchar ch);
 		
 		/** Parse a tag and apply styling
 		  * \param tag The tag to handle
@@ -176,18 +216,33 @@ class TextParser {
 		void executeNextTrigger();
 		
 		/** Execute a trigger
-		  * \param trigger The trigger to execute
+		  * \param trigger The resolved trigger to execute
 		  * \param command The trigger parameters
-		  * \return The return value of a trigger
+		  * \param target Handle of the block a goto jumps to, if it was resolved
 		*/
-		ustring doTrigger(const ustring &trigger, const ustring &command);
+		void doTrigger(Triggers::ID trigger, const ustring &command, Case::BlockHandle target=Case::NULL_BLOCK);
+		
+		/// The current compiled block
+		const Script::Program *m_Program;
+		
+		/// Block compiled by the parser itself, rather than by the case
+		Script::Program m_OwnedProgram;
 		
-		/// The current block
-		ustring m_Block;
+		/// Index of the next instruction to execute
+		int m_PC;
+		
+		/// Amount of characters of the current text run that were already appended
+		int m_TextPos;
 		
 		/// The next block to parse
 		ustring m_NextBlock;
 		
+		/// Resolved handle of the next block to parse
+		Case::BlockHandle m_NextHandle;
+		
+		/// Amount of blocks executed since the parser was created
+		int m_ExecutedBlocks;
+		
 		/// Internal name of current speaking character
 		ustring m_Speaker;
 		
@@ -213,7 +268,10 @@ class TextParser {
 		bool m_TalkLocked;
 		
 		/// Current dialogue string data
-		ustring m_Dialogue;
+		UTF32String m_Dialogue;
+		
+		/// Layout of the current dialogue string
+		TextLayout m_Layout;
 		
 		/// Position in current dialogue
 		int m_StrPos;
@@ -224,7 +282,7 @@ class TextParser {
 		/// Speed of font drawing
 		int m_Speed;
 		
-		/// Pause time before going to next character in dialogue
+		/// Pause time before going to next character in dialogue, in milliseconds
 		int m_PauseDiag;
 		
 		/// Flag whether or not the a styling tag is open
@@ -237,7 +295,7 @@ class TextParser {
 		FontStyle m_FontStyle;
 		
 		/// Triggers to be executed in a linear manner
-		std::deque<StringPair> m_QueuedTriggers;
+		std::deque<QueuedTrigger> m_QueuedTriggers;
 		
 		/// Scheduled fade out
 		ustring m_QueuedFade;
@@ -257,7 +315,7 @@ class TextParser {
 		ustring m_QueuedEventArgs;
 		//@}
 		
-		/// Wait time before parsing block
+		/// Wait time before parsing block, in milliseconds
 		int m_TimedGoto;
 		
 		/// Pointer to Game engine object
@@ -19,19 +19,44 @@
  ***************************************************************************/
 // texture.cpp: implementation of Textures namespace
 
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include "SDL_image.h"
 
+#include "assets.h"
+#include "profiler.h"
+#include "renderer.h"
 #include "texture.h"
 #include "utilities.h"
+#include "vfs.h"
 
 namespace Textures {
 
-std::map<ustring, Texture> g_TextureMap;
+std::vector<Texture> g_Textures;
+std::vector<Symbols::Symbol> g_TextureIds;
+std::vector<Handle> g_FreeHandles;
+std::vector<Handle> g_GLHandles;
+std::vector<Handle> g_SymbolHandles;
 
 Texture g_NullTexture;
 
+// next name to hand out when there is no renderer output
+GLuint g_NextName=1;
+
+// suffix of the next automatic texture id; this never goes down, so an id is
+// never handed out again while the texture it named can still be loaded
+int g_NextUnnamed=20;
+
+// memory accounting and residency
+Usage g_Usage[CATEGORY_COUNT];
+std::vector<Residency> g_Residency;
+int g_Resident=0;
+int g_Budget=0;
+int g_Frame=0;
+int g_Evictions=0;
+int g_Reloads=0;
+
 }
 
 // test if a texture is null
@@ -39,49 +64,315 @@ bool Textures::isNull(const GLuint &id) {
 	return (g_NullTexture.id==id);
 }
 
+// get the handle of a texture
+Textures::Handle Textures::getHandle(const ustring &id) {
+	Symbols::Symbol sym=Symbols::find(id);
+	if (sym!=Symbols::NULL_SYMBOL)
+		return getHandle(sym);
+	
+	// it might not have been loaded yet
+	if (Assets::require(id))
+		return getHandle(Symbols::find(id));
+	
+	return NULL_HANDLE;
+}
+
+// get the handle of a texture by symbol
+Textures::Handle Textures::getHandle(Symbols::Symbol sym) {
+	if (sym>=0 && sym<g_SymbolHandles.size() && g_SymbolHandles[sym]!=NULL_HANDLE)
+		return g_SymbolHandles[sym];
+	
+	// it might not have been loaded yet
+	if (sym!=Symbols::NULL_SYMBOL && Assets::require(Symbols::name(sym)))
+		return getHandle(sym);
+	
+	return NULL_HANDLE;
+}
+
+// get the handle of a texture by gl id
+Textures::Handle Textures::getHandle(const GLuint &id) {
+	if (id<g_GLHandles.size() && g_GLHandles[id]!=NULL_HANDLE)
+		return g_GLHandles[id];
+	
+	// it might not have been loaded yet
+	if (Assets::require(id))
+		return getHandle(id);
+	
+	return NULL_HANDLE;
+}
+
+// get a texture by handle
+Textures::Texture Textures::getTexture(Handle handle) {
+	if (handle<0 || handle>=g_Textures.size())
+		return g_NullTexture;
+	
+	return g_Textures[handle];
+}
+
 // get a texture from the map
 Textures::Texture Textures::queryTexture(const ustring &id) {
 	// automatically return the null texture if requested
 	if (id=="no_texture")
 		return g_NullTexture;
 	
-	// see if this texture exists
-	if (g_TextureMap.find(id)==g_TextureMap.end())
-		return g_NullTexture;
-	
-	return g_TextureMap[id];
+	return getTexture(getHandle(id));
+}
+
+Textures::Texture Textures::queryTexture(Symbols::Symbol sym) {
+	return getTexture(getHandle(sym));
 }
 
 Textures::Texture Textures::queryTexture(const GLuint &id) {
-	for (std::map<ustring, Texture>::iterator it=g_TextureMap.begin(); it!=g_TextureMap.end(); ++it) {
-		if ((*it).second.id==id)
-			return queryTexture((*it).first);
-	}
-	
-	return queryTexture("no_texture");
+	return getTexture(getHandle(id));
 }
 
 // add a new texture
 void Textures::pushTexture(const ustring &id, const Texture &tex) {
-	if (g_TextureMap.find(id)!=g_TextureMap.end())
+	Symbols::Symbol sym=Symbols::intern(id);
+	if (sym<g_SymbolHandles.size() && g_SymbolHandles[sym]!=NULL_HANDLE)
 		popTexture(id);
-	g_TextureMap[id]=tex;
+	
+	// reuse the handle of a removed texture, if possible
+	Handle handle;
+	if (!g_FreeHandles.empty()) {
+		handle=g_FreeHandles.back();
+		g_FreeHandles.pop_back();
+		
+		g_Textures[handle]=tex;
+		g_TextureIds[handle]=sym;
+	}
+	
+	else {
+		handle=g_Textures.size();
+		g_Textures.push_back(tex);
+		g_TextureIds.push_back(sym);
+	}
+	
+	// index the texture by gl id and name
+	if (tex.id>=g_GLHandles.size())
+		g_GLHandles.resize(tex.id+1, NULL_HANDLE);
+	g_GLHandles[tex.id]=handle;
+	
+	if (sym>=g_SymbolHandles.size())
+		g_SymbolHandles.resize(sym+1, NULL_HANDLE);
+	g_SymbolHandles[sym]=handle;
+}
+
+// unlink a texture from its id and gl name, and free its handle for reuse
+static void unregisterTexture(Textures::Handle handle) {
+	Textures::Texture &tex=Textures::g_Textures[handle];
+	
+	Textures::g_SymbolHandles[Textures::g_TextureIds[handle]]=Textures::NULL_HANDLE;
+	Textures::g_GLHandles[tex.id]=Textures::NULL_HANDLE;
+	
+	tex=Textures::g_NullTexture;
+	Textures::g_TextureIds[handle]=Symbols::NULL_SYMBOL;
+	Textures::g_FreeHandles.push_back(handle);
 }
 
 // remove a texture from the stack
 void Textures::popTexture(const ustring &id) {
-	glDeleteTextures(1, &queryTexture(id).id);
-	g_TextureMap.erase(id);
+	Symbols::Symbol sym=Symbols::find(id);
+	if (sym==Symbols::NULL_SYMBOL || sym>=g_SymbolHandles.size() || g_SymbolHandles[sym]==NULL_HANDLE)
+		return;
+	
+	Handle handle=g_SymbolHandles[sym];
+	deleteName(g_Textures[handle].id);
+	unregisterTexture(handle);
 }
 
 // clear the texture stack
 void Textures::clearStack() {
-	for (std::map<ustring, Texture>::iterator it=g_TextureMap.begin(); it!=g_TextureMap.end(); ++it)
-		glDeleteTextures(1, &(*it).second.id);
+	for (int i=0; i<g_Textures.size(); i++) {
+		if (g_TextureIds[i]!=Symbols::NULL_SYMBOL)
+			deleteName(g_Textures[i].id);
+	}
+	
+	deleteName(g_NullTexture.id);
+	
+	g_Textures.clear();
+	g_TextureIds.clear();
+	g_FreeHandles.clear();
+	g_GLHandles.clear();
+	g_SymbolHandles.clear();
+}
+
+// reserve a new texture name
+GLuint Textures::generateName() {
+	if (!Renderer::g_Output)
+		return g_NextName++;
+	
+	GLuint name;
+	glGenTextures(1, &name);
+	return name;
+}
+
+// give back a texture name
+void Textures::deleteName(GLuint name) {
+	release(name);
+	if (name<g_Residency.size())
+		g_Residency[name].category=CATEGORY_OTHER;
+	
+	if (Renderer::g_Output)
+		glDeleteTextures(1, &name);
+}
+
+// get the residency record of a texture, creating it if needed
+static Textures::Residency& residency(const GLuint &id) {
+	if (id>=Textures::g_Residency.size()) {
+		Textures::Residency r={ Textures::CATEGORY_OTHER, 0, 0, 0, false, false };
+		Textures::g_Residency.resize(id+1, r);
+	}
+	
+	return Textures::g_Residency[id];
+}
+
+// set the category of a texture
+void Textures::setCategory(const GLuint &id, Category category) {
+	Residency &r=residency(id);
+	
+	// move the memory of an already resident texture over
+	if (r.resident) {
+		g_Usage[r.category].count--;
+		g_Usage[r.category].logical-=r.logical;
+		g_Usage[r.category].allocated-=r.allocated;
+		
+		g_Usage[category].count++;
+		g_Usage[category].logical+=r.logical;
+		g_Usage[category].allocated+=r.allocated;
+	}
+	
+	r.category=category;
+}
+
+// record the memory used by a texture
+void Textures::account(const GLuint &id, int logical, int allocated) {
+	release(id);
+	
+	Residency &r=residency(id);
+	r.logical=logical;
+	r.allocated=allocated;
+	r.lastDrawn=g_Frame;
+	r.resident=true;
+	
+	// a texture that was evicted is being loaded again
+	if (r.evicted) {
+		g_Reloads++;
+		r.evicted=false;
+	}
+	
+	g_Usage[r.category].count++;
+	g_Usage[r.category].logical+=logical;
+	g_Usage[r.category].allocated+=allocated;
+	g_Resident+=allocated;
+}
+
+// record that a texture has no storage
+void Textures::release(const GLuint &id) {
+	if (id>=g_Residency.size() || !g_Residency[id].resident)
+		return;
+	
+	Residency &r=g_Residency[id];
+	r.resident=false;
+	
+	g_Usage[r.category].count--;
+	g_Usage[r.category].logical-=r.logical;
+	g_Usage[r.category].allocated-=r.allocated;
+	g_Resident-=r.allocated;
+}
+
+// note that a texture is being drawn
+void Textures::touch(const GLuint &id) {
+	if (id<g_Residency.size())
+		g_Residency[id].lastDrawn=g_Frame;
+}
+
+// set the texture memory budget
+void Textures::setBudget(int bytes) {
+	g_Budget=std::max(0, bytes);
+}
+
+// free the storage of a texture, so that it is loaded again when needed
+bool Textures::evict(Handle handle) {
+	if (handle<0 || handle>=g_Textures.size() || g_TextureIds[handle]==Symbols::NULL_SYMBOL)
+		return false;
+	
+	// only textures that can be decoded again may go
+	GLuint id=g_Textures[handle].id;
+	if (!Assets::hasSource(id))
+		return false;
+	
+	ustring name=Symbols::name(g_TextureIds[handle]);
+	unregisterTexture(handle);
+	
+	// keep the name, since it is still referenced, but drop its storage
+	if (Renderer::g_Output) {
+		glBindTexture(GL_TEXTURE_2D, id);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+	
+	release(id);
+	residency(id).evicted=true;
+	g_Evictions++;
+	
+	// the next query for this texture will decode it again
+	Assets::restore(id, name);
 	
-	glDeleteTextures(1, &g_NullTexture.id);
+	return true;
+}
+
+// order eviction candidates, least recently drawn first
+static bool compareLastDrawn(const std::pair<int, Textures::Handle> &a, const std::pair<int, Textures::Handle> &b) {
+	return a.first<b.first;
+}
+
+// evict textures until the budget is met
+void Textures::trim() {
+	g_Frame++;
+	if (g_Budget<=0 || g_Resident<=g_Budget)
+		return;
+	
+	// textures drawn in the last frame will most likely be drawn again
+	std::vector<std::pair<int, Handle> > candidates;
+	for (int i=0; i<g_Textures.size(); i++) {
+		if (g_TextureIds[i]==Symbols::NULL_SYMBOL)
+			continue;
+		
+		Residency &r=residency(g_Textures[i].id);
+		if (r.resident && r.lastDrawn<g_Frame-1)
+			candidates.push_back(std::make_pair(r.lastDrawn, (Handle) i));
+	}
+	
+	std::sort(candidates.begin(), candidates.end(), compareLastDrawn);
+	for (int i=0; i<candidates.size() && g_Resident>g_Budget; i++)
+		evict(candidates[i].second);
+}
+
+// get the name of a category
+ustring Textures::categoryName(Category category) {
+	switch(category) {
+		case CATEGORY_BACKGROUNDS: return "backgrounds";
+		case CATEGORY_SPRITES: return "sprites";
+		case CATEGORY_EVIDENCE: return "evidence";
+		case CATEGORY_GLYPHS: return "glyphs";
+		case CATEGORY_GUI: return "stock gui";
+		default: return "other";
+	}
+}
+
+// print texture memory use
+void Textures::printUsage() {
+	std::cout << "Texture memory (KB, image/allocated):\n";
+	for (int i=0; i<CATEGORY_COUNT; i++) {
+		std::cout << "  " << categoryName((Category) i) << ": " << g_Usage[i].count << " textures, " 
+			  << g_Usage[i].logical/1024 << "/" << g_Usage[i].allocated/1024 << "\n";
+	}
 	
-	g_TextureMap.clear();
+	std::cout << "  (glyphs and retained screen regions are pinned)\n";
+	std::cout << "  total: " << g_Resident/1024 << "KB";
+	if (g_Budget>0)
+		std::cout << " of " << g_Budget/1024 << "KB budget";
+	std::cout << ", " << g_Evictions << " evictions, " << g_Reloads << " reloads\n";
 }
 
 // create a texture after loading an image from file
@@ -98,45 +389,66 @@ GLuint Textures::createTexture(const ustring &id, const ustring &str, int alpha)
 		file.erase(0, 1);
 	}
 	
-	// load the image
-	SDL_Surface *surface=IMG_Load(file.c_str());
+	// load the image, either from the resource pack or from disk
+	SDL_Surface *surface=IMG_Load_RW(VFS::open(file), 1);
 	if (!surface)
 		return 0;
 	
-	return createTexture(id, surface, alpha);
+	// the file can be read again if the texture is evicted
+	GLuint tex=createTexture(id, surface, alpha);
+	if (tex!=0)
+		Assets::addSource(tex, file, alpha);
+	
+	return tex;
 }
 
 // create a texture from data
 GLuint Textures::createTexture(const ustring &id, SDL_Surface *surface, int alpha) {
-	// our new texture struct
-	Texture tex;
+	PreparedImage img;
+	if (!prepareSurface(surface, alpha, img))
+		return 0;
+	
+	return uploadTexture(id, img);
+}
+
+// convert a surface into an uploadable rgba image
+bool Textures::prepareSurface(SDL_Surface *surface, int alpha, PreparedImage &img) {
+	img.surface=NULL;
+	if (!surface)
+		return false;
 	
 	// set the width and height
-	int w=tex.w=surface->w;
-	int h=tex.h=surface->h;
+	int w=img.w=surface->w;
+	int h=img.h=surface->h;
 	
 	// default texture coordinates
-	tex.u=tex.v=1.0f;
-	
-	// just in case we need to expand the surface
-	SDL_Surface *expanded=NULL;
+	img.u=img.v=1.0f;
 	
 	// test to see if the texture's width and height aren't powers of 2
-	if ((tex.w & (tex.w-1))!=0 || (tex.h & (tex.h-1))!=0) {
+	if ((img.w & (img.w-1))!=0 || (img.h & (img.h-1))!=0) {
 		// find new dimensions
 		w=Utils::nearestPower2(surface->w);
 		h=Utils::nearestPower2(surface->h);
 		
 		// now calculate the texture coordinates
-		tex.u=(float) surface->w/w;
-		tex.v=(float) surface->h/h;
-		
+		img.u=(float) surface->w/w;
+		img.v=(float) surface->h/h;
+	}
+	
+	// surfaces that need expanding or that aren't 32 bit are blitted onto a new
+	// rgba surface; this avoids SDL_DisplayFormat(), which is not safe to call
+	// outside of the main thread
+	if (w!=surface->w || h!=surface->h || surface->format->BytesPerPixel!=4) {
 		// get our rgba color masks
 		Uint32 rm, gm, bm, am;
 		Utils::setRGBAMasks(rm, gm, bm, am);
 		
 		// create a new surface for this expanded texture
-		expanded=SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32, rm, gm, bm, am);
+		SDL_Surface *expanded=SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32, rm, gm, bm, am);
+		if (!expanded) {
+			SDL_FreeSurface(surface);
+			return false;
+		}
 		
 		// clear the alpha if it is enabled
 		SDL_SetAlpha(surface, 0, 0);
@@ -144,27 +456,17 @@ GLuint Textures::createTexture(const ustring &id, SDL_Surface *surface, int alph
 		// only blit the actual surface onto the new one
 		SDL_Rect rect={ 0, 0, surface->w, surface->h };
 		SDL_BlitSurface(surface, &rect, expanded, &rect);
+		
+		SDL_FreeSurface(surface);
+		surface=expanded;
 	}
 	
-	else {
-		// make sure to convert surfaces which aren't 32 bit
-		if (surface->format->BytesPerPixel!=4) {
-			SDL_Surface *tmp=SDL_DisplayFormat(surface);
-			SDL_FreeSurface(surface);
-			surface=tmp;
-		}
-	}
-	
-	// set a pointer to our active surface
-	SDL_Surface *ptr=(expanded ? expanded : surface);
-	
-	SDL_LockSurface(ptr);
+	SDL_LockSurface(surface);
 	
 	// iterate over pixels, and modify the pixel data
-	// all surfaces will have 4 bytes per pixel, since they will either be recreated
-	// through a new size, or converted to display format
-	char *pixel=(char*) ptr->pixels;
-	for (int i=0; i<ptr->w*ptr->h*4; i+=4, pixel+=4) {
+	// all surfaces have 4 bytes per pixel at this point
+	char *pixel=(char*) surface->pixels;
+	for (int i=0; i<surface->w*surface->h*4; i+=4, pixel+=4) {
 			// set new alpha if not fully opaque
 		if (alpha!=255)
 			*(pixel+3)=alpha;
@@ -175,23 +477,50 @@ GLuint Textures::createTexture(const ustring &id, SDL_Surface *surface, int alph
 			*(pixel+3)=0;
 	}
 		
-	SDL_UnlockSurface(ptr);
+	SDL_UnlockSurface(surface);
 	
-	// generate a new texture
-	glGenTextures(1, &tex.id);
-	glBindTexture(GL_TEXTURE_2D, tex.id);
+	img.surface=surface;
+	return true;
+}
+
+// upload a prepared image as a texture
+GLuint Textures::uploadTexture(const ustring &id, PreparedImage &img, GLuint glId) {
+	if (!img.surface)
+		return 0;
 	
-	// set parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	// our new texture struct
+	Texture tex;
+	tex.w=img.w;
+	tex.h=img.h;
+	tex.u=img.u;
+	tex.v=img.v;
+	
+	// generate a new texture, unless one was already reserved
+	tex.id=(glId!=0 ? glId : generateName());
+	
+	if (Renderer::g_Output) {
+		glBindTexture(GL_TEXTURE_2D, tex.id);
+		
+		// set parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		
+		// now create the actual texture
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, img.surface->w, img.surface->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, img.surface->pixels);
+		
+		// a reserved name may already be drawn in a retained region
+		if (glId!=0)
+			Renderer::invalidateRegions();
+		
+		Profiler::count(Profiler::COUNTER_UPLOADS);
+	}
 	
-	// now create the actual texture
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, ptr->pixels);
+	// padding to a power of 2 counts against the budget as well
+	account(tex.id, img.w*img.h*4, img.surface->w*img.surface->h*4);
 	
-	// free used surfaces
-	if (expanded)
-		SDL_FreeSurface(expanded);
-	SDL_FreeSurface(surface);
+	// free the used surface
+	SDL_FreeSurface(img.surface);
+	img.surface=NULL;
 	
 	// null texture gets its own variable
 	if (id=="no_texture")
@@ -201,7 +530,7 @@ GLuint Textures::createTexture(const ustring &id, SDL_Surface *surface, int alph
 	else if (id==STR_NULL) {
 		// use next available name
 		std::stringstream ss;
-		ss << "UNKNOWN_TEXTURE_" << g_TextureMap.size()+20;
+		ss << "UNKNOWN_TEXTURE_" << g_NextUnnamed++;
 		
 		pushTexture(ss.str(), tex);
 	}
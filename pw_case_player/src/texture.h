@@ -26,9 +26,11 @@
 #include <GL/gl.h>
 #include <GL/glu.h>
 #include <map>
+#include <vector>
 #include "SDL.h"
 
 #include "common.h"
+#include "symbols.h"
 
 /// Namespace for management of individual images used in the player
 namespace Textures {
@@ -43,11 +45,85 @@ struct _Texture {
 };
 typedef struct _Texture Texture;
 
+/// Struct used to hold an image that was converted, but not yet uploaded
+struct _PreparedImage {
+	SDL_Surface *surface;	///< The 32 bit RGBA surface, padded to a power of 2
+	int w;			///< The original width
+	int h;			///< The original height
+	float u;
+	float v;
+};
+typedef struct _PreparedImage PreparedImage;
+
+/// Dense integer handle of a registered texture
+typedef int Handle;
+
+/// Handle returned for textures that don't exist
+const Handle NULL_HANDLE=-1;
+
 /// The null texture to use if a texture is not found but still requested
 extern Texture g_NullTexture;
 
-/// Map of all allocated images
-extern std::map<ustring, Texture> g_TextureMap;
+/// All registered textures, indexed by handle
+extern std::vector<Texture> g_Textures;
+
+/// Symbols of registered texture IDs, indexed by handle
+extern std::vector<Symbols::Symbol> g_TextureIds;
+
+/// Handles of removed textures, available for reuse
+extern std::vector<Handle> g_FreeHandles;
+
+/// Handles of registered textures, indexed by GL texture ID
+extern std::vector<Handle> g_GLHandles;
+
+/// Handles of registered textures, indexed by the symbol of their ID
+extern std::vector<Handle> g_SymbolHandles;
+
+/// Kinds of textures that memory use is accounted for separately
+enum Category { CATEGORY_BACKGROUNDS=0, CATEGORY_SPRITES, CATEGORY_EVIDENCE, CATEGORY_GLYPHS, CATEGORY_GUI, CATEGORY_OTHER, CATEGORY_COUNT };
+
+/// Memory used by the textures of a category
+struct _Usage {
+	int count;		///< Amount of resident textures
+	int logical;		///< Bytes needed for the images themselves
+	int allocated;		///< Bytes allocated, including padding to a power of 2
+};
+typedef struct _Usage Usage;
+
+/// Memory use and residency of a single texture
+struct _Residency {
+	Category category;	///< The category the texture is accounted in
+	int logical;		///< Bytes needed for the image itself
+	int allocated;		///< Bytes allocated for the texture
+	int lastDrawn;		///< Frame the texture was last drawn in
+	bool resident;		///< Whether the texture currently has storage
+	bool evicted;		///< Whether the texture was evicted to stay within the budget
+};
+typedef struct _Residency Residency;
+
+/// Memory use of each category
+extern Usage g_Usage[CATEGORY_COUNT];
+
+/// Residency of textures, indexed by GL texture ID
+extern std::vector<Residency> g_Residency;
+
+/// Bytes allocated for all resident textures
+extern int g_Resident;
+
+/** Most bytes textures may use before some are evicted, or 0 for no limit.
+  * Glyph atlases and retained screen regions count toward the budget, but are 
+  * pinned: they have no source to be loaded again from, so they are never evicted.
+*/
+extern int g_Budget;
+
+/// Frame counter used to find the least recently drawn textures
+extern int g_Frame;
+
+//@{
+/** Amount of textures evicted and loaded again */
+extern int g_Evictions;
+extern int g_Reloads;
+//@}
 
 /** Test if a texture does not exist
   * \param id The OpenGL texture ID to test
@@ -55,12 +131,42 @@ extern std::map<ustring, Texture> g_TextureMap;
 */
 bool isNull(const GLuint &id);
 
+/** Get the handle of a texture
+  * \param id The ID of the image
+  * \return The handle of the texture, or NULL_HANDLE if it doesn't exist
+*/
+Handle getHandle(const ustring &id);
+
+/** Get the handle of a texture based on the symbol of its ID
+  * \param sym The interned ID of the image
+  * \return The handle of the texture, or NULL_HANDLE if it doesn't exist
+*/
+Handle getHandle(Symbols::Symbol sym);
+
+/** Get the handle of a texture based on GL ID
+  * \param id The GL texture ID
+  * \return The handle of the texture, or NULL_HANDLE if it doesn't exist
+*/
+Handle getHandle(const GLuint &id);
+
+/** Get a texture by its handle
+  * \param handle The handle of the texture
+  * \return The requested texture, or the null texture if the handle is invalid
+*/
+Texture getTexture(Handle handle);
+
 /** Get a texture from the map
   * \param id The ID of the image
   * \return The requested texture
 */
 Texture queryTexture(const ustring &id);
 
+/** Get a texture based on the symbol of its ID
+  * \param sym The interned ID of the image
+  * \return The requested texture
+*/
+Texture queryTexture(Symbols::Symbol sym);
+
 /** Get a texture based on GL ID from the map
   * \param id The GL texture ID
   * \return The requested texture
@@ -81,6 +187,68 @@ void popTexture(const ustring &id);
 /// Clear the image stack
 void clearStack();
 
+/** Reserve a new texture name.
+  * When there is no renderer output, names are handed out from a counter 
+  * instead of by OpenGL, so that textures can still be told apart.
+  * \return The new texture name
+*/
+GLuint generateName();
+
+/** Give back a texture name, freeing its texture
+  * \param name The name to release
+*/
+void deleteName(GLuint name);
+
+/** Set the category a texture is accounted in
+  * \param id The GL texture ID
+  * \param category The category of the texture
+*/
+void setCategory(const GLuint &id, Category category);
+
+/** Record the memory used by a texture whose storage was just allocated
+  * \param id The GL texture ID
+  * \param logical Bytes needed for the image itself
+  * \param allocated Bytes allocated for the texture
+*/
+void account(const GLuint &id, int logical, int allocated);
+
+/** Record that a texture no longer has any storage
+  * \param id The GL texture ID
+*/
+void release(const GLuint &id);
+
+/** Note that a texture is being drawn in the current frame
+  * \param id The GL texture ID
+*/
+void touch(const GLuint &id);
+
+/** Set the most memory textures may use
+  * \param bytes The budget in bytes, or 0 for no limit
+*/
+void setBudget(int bytes);
+
+/** Free the storage of a texture, keeping its GL name so that it is loaded
+  * again from its source the next time it is queried
+  * \param handle The handle of the texture
+  * \return <b>true</b> if the texture was evicted, <b>false</b> if it can't be loaded again
+*/
+bool evict(Handle handle);
+
+/** Evict the least recently drawn textures until the budget is met.
+  * This should be called once per frame, before anything is drawn. Pinned 
+  * textures are skipped, so the budget can't be met if they alone exceed it.
+*/
+void trim();
+
+/** Get a category's name
+  * \param category The category
+  * \return Displayable name of the category
+*/
+ustring categoryName(Category category);
+
+/// Print the memory used by each category of textures
+void printUsage();
+
 /** Create a usable surface after loading an image from file
   * \param id The ID of the image
   * \param file The path to the image
@@ -97,6 +265,24 @@ GLuint createTexture(const ustring &id, const ustring &file, int alpha=255);
 */
 GLuint createTexture(const ustring &id, SDL_Surface *surface, int alpha=255);
 
+/** Pad a surface and apply alpha and the color key, without touching OpenGL.
+  * This function is safe to call from threads other than the main one. The 
+  * passed surface is freed by this function.
+  * \param surface Pointer to an SDL_Surface
+  * \param alpha The requested alpha value to apply
+  * \param img PreparedImage struct to fill in
+  * \return <b>true</b> if no errors occurred, <b>false</b> otherwise
+*/
+bool prepareSurface(SDL_Surface *surface, int alpha, PreparedImage &img);
+
+/** Upload a prepared image as an OpenGL texture
+  * \param id The ID of the image
+  * \param img The prepared image; its surface is freed
+  * \param glId A previously generated GL texture name to use, or 0 to create one
+  * \return ID of this texture
+*/
+GLuint uploadTexture(const ustring &id, PreparedImage &img, GLuint glId=0);
+
 }; // namespace Textures
 
 #endif
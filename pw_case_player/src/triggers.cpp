@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// triggers.cpp: implementation of Triggers namespace
+
+#include "triggers.h"
+#include "utilities.h"
+
+namespace Triggers {
+
+// name, arity, exact, preparse, filterable
+const Info g_Triggers[TRIGGER_COUNT]={
+	{ "goto", 1, false, false, true },
+	{ "direct_goto", 1, false, false, true },
+	{ "timed_goto", 2, false, false, true },
+	{ "hide_text_box", 0, false, false, true },
+	{ "show_text_box", 0, false, false, true },
+	{ "add_evidence_silent", 1, false, false, true },
+	{ "add_evidence_animated", 1, false, false, true },
+	{ "add_profile", 1, false, false, true },
+	{ "show_evidence", 2, false, false, true },
+	{ "hide_evidence", 0, false, false, true },
+	{ "set_location", 1, false, false, true },
+	{ "add_location", 2, false, false, true },
+	{ "set_location_trigger", 2, false, false, true },
+	{ "set_animation", 2, false, false, true },
+	{ "put_character", 2, false, false, true },
+	{ "add_talk_option", 3, false, false, true },
+	{ "remove_talk_option", 2, false, false, true },
+	{ "clear_talk_options", 1, false, false, true },
+	{ "add_presentable", 3, false, false, true },
+	{ "remove_presentable", 2, false, false, true },
+	{ "clear_presentables", 1, false, false, true },
+	{ "set_bad_presentable_block", 2, false, false, true },
+	{ "set_location_music", 2, false, false, true },
+	{ "clear_location_music", 1, false, false, true },
+	{ "request_evidence", 0, false, false, true },
+	{ "request_answer", 0, false, false, true },
+	{ "request_image_contradiction", 7, true, false, true },
+	{ "play_music", 1, false, false, true },
+	{ "halt_music", 0, false, false, true },
+	{ "sfx", 1, false, false, true },
+	{ "fade_out", 1, false, false, true },
+	{ "flash", 0, false, false, true },
+	{ "special_effect", 1, false, false, true },
+	{ "move_court_camera", 1, false, false, true },
+	{ "speaker", 1, false, true, false },
+	{ "set_court_overview_image", 2, false, false, true },
+	{ "set_temp_image", 1, false, false, true },
+	{ "hide_temp_image", 0, false, false, true },
+	{ "display_testimony", 1, false, false, true },
+	{ "cross_examine", 1, false, false, true },
+	{ "resume_cross_examination", 0, false, false, true },
+	{ "change_character_gender", 2, false, false, true },
+	{ "change_character_name", 2, false, false, true },
+	{ "change_character_caption", 2, false, false, true },
+	{ "change_character_desc", 2, false, false, true },
+	{ "change_evidence_name", 2, false, false, true },
+	{ "change_evidence_caption", 2, false, false, true },
+	{ "change_evidence_desc", 2, false, false, true },
+	{ "set_location_state", 2, false, false, true },
+	{ "fade_bg", 0, false, false, true },
+	{ "restore_bg", 0, false, false, true },
+	{ "flashback_image", 1, false, false, true },
+	{ "hold_it", 1, false, false, true },
+	{ "objection", 1, false, false, true },
+	{ "take_that", 1, false, false, true }
+};
+
+TriggerIndex g_TriggerIndex;
+
+}
+
+// find the identifier of a trigger
+Triggers::ID Triggers::lookup(const ustring &name) {
+	// build the index the first time it's needed
+	if (g_TriggerIndex.empty()) {
+		for (int i=0; i<TRIGGER_COUNT; i++)
+			g_TriggerIndex[g_Triggers[i].name]=(ID) i;
+	}
+	
+	TriggerIndex::const_iterator it=g_TriggerIndex.find(name);
+	if (it==g_TriggerIndex.end())
+		return TRIGGER_UNKNOWN;
+	
+	return (*it).second;
+}
+
+// get the description of a trigger
+const Triggers::Info& Triggers::info(ID id) {
+	return g_Triggers[id];
+}
+
+// check a trigger's arguments
+bool Triggers::checkArguments(ID id, const ustring &args) {
+	int arity=g_Triggers[id].arity;
+	if (arity==0)
+		return true;
+	
+	// an empty string holds no arguments at all
+	if (args.empty())
+		return false;
+	
+	int count=Utils::explodeString(',', args).size();
+	return (g_Triggers[id].exact ? count==arity : count>=arity);
+}
@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// triggers.h: registry of script triggers
+
+#ifndef TRIGGERS_H
+#define TRIGGERS_H
+
+#include <tr1/unordered_map>
+
+#include "common.h"
+
+/// Namespace for the registry of triggers that can be used in the game script
+namespace Triggers {
+
+/// Identifiers of the known triggers
+enum ID {
+	TRIGGER_UNKNOWN=-1,
+	TRIGGER_GOTO=0,
+	TRIGGER_DIRECT_GOTO,
+	TRIGGER_TIMED_GOTO,
+	TRIGGER_HIDE_TEXT_BOX,
+	TRIGGER_SHOW_TEXT_BOX,
+	TRIGGER_ADD_EVIDENCE_SILENT,
+	TRIGGER_ADD_EVIDENCE_ANIMATED,
+	TRIGGER_ADD_PROFILE,
+	TRIGGER_SHOW_EVIDENCE,
+	TRIGGER_HIDE_EVIDENCE,
+	TRIGGER_SET_LOCATION,
+	TRIGGER_ADD_LOCATION,
+	TRIGGER_SET_LOCATION_TRIGGER,
+	TRIGGER_SET_ANIMATION,
+	TRIGGER_PUT_CHARACTER,
+	TRIGGER_ADD_TALK_OPTION,
+	TRIGGER_REMOVE_TALK_OPTION,
+	TRIGGER_CLEAR_TALK_OPTIONS,
+	TRIGGER_ADD_PRESENTABLE,
+	TRIGGER_REMOVE_PRESENTABLE,
+	TRIGGER_CLEAR_PRESENTABLES,
+	TRIGGER_SET_BAD_PRESENTABLE_BLOCK,
+	TRIGGER_SET_LOCATION_MUSIC,
+	TRIGGER_CLEAR_LOCATION_MUSIC,
+	TRIGGER_REQUEST_EVIDENCE,
+	TRIGGER_REQUEST_ANSWER,
+	TRIGGER_REQUEST_IMAGE_CONTRADICTION,
+	TRIGGER_PLAY_MUSIC,
+	TRIGGER_HALT_MUSIC,
+	TRIGGER_SFX,
+	TRIGGER_FADE_OUT,
+	TRIGGER_FLASH,
+	TRIGGER_SPECIAL_EFFECT,
+	TRIGGER_MOVE_COURT_CAMERA,
+	TRIGGER_SPEAKER,
+	TRIGGER_SET_COURT_OVERVIEW_IMAGE,
+	TRIGGER_SET_TEMP_IMAGE,
+	TRIGGER_HIDE_TEMP_IMAGE,
+	TRIGGER_DISPLAY_TESTIMONY,
+	TRIGGER_CROSS_EXAMINE,
+	TRIGGER_RESUME_CROSS_EXAMINATION,
+	TRIGGER_CHANGE_CHARACTER_GENDER,
+	TRIGGER_CHANGE_CHARACTER_NAME,
+	TRIGGER_CHANGE_CHARACTER_CAPTION,
+	TRIGGER_CHANGE_CHARACTER_DESC,
+	TRIGGER_CHANGE_EVIDENCE_NAME,
+	TRIGGER_CHANGE_EVIDENCE_CAPTION,
+	TRIGGER_CHANGE_EVIDENCE_DESC,
+	TRIGGER_SET_LOCATION_STATE,
+	TRIGGER_FADE_BG,
+	TRIGGER_RESTORE_BG,
+	TRIGGER_FLASHBACK_IMAGE,
+	TRIGGER_HOLD_IT,
+	TRIGGER_OBJECTION,
+	TRIGGER_TAKE_THAT,
+	TRIGGER_COUNT
+};
+
+/// Static description of a trigger
+struct _Info {
+	const char *name;	///< Name of the trigger as used in the script
+	int arity;		///< Minimum amount of comma separated arguments
+	bool exact;		///< Whether exactly <i>arity</i> arguments are required
+	bool preparse;		///< Whether the trigger is executed as soon as it is parsed
+	bool filterable;	///< Whether the trigger is dropped during cross examination
+};
+typedef struct _Info Info;
+
+/// Hashed index of trigger names to identifiers
+typedef std::tr1::unordered_map<std::string, ID> TriggerIndex;
+
+/// Descriptions of all known triggers, indexed by identifier
+extern const Info g_Triggers[TRIGGER_COUNT];
+
+/// Index of trigger names, built on first lookup
+extern TriggerIndex g_TriggerIndex;
+
+/** Find the identifier of a trigger
+  * \param name The name of the trigger
+  * \return The identifier, or TRIGGER_UNKNOWN if there is no such trigger
+*/
+ID lookup(const ustring &name);
+
+/** Get the description of a trigger
+  * \param id The identifier of the trigger
+  * \return The trigger's description
+*/
+const Info& info(ID id);
+
+/** Check a trigger's arguments against its description
+  * \param id The identifier of the trigger
+  * \param args The trigger arguments
+  * \return <b>true</b> if enough arguments, or exactly as many as required, were given, <b>false</b> otherwise
+*/
+bool checkArguments(ID id, const ustring &args);
+
+}; // namespace Triggers
+
+#endif
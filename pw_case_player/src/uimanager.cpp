@@ -20,9 +20,11 @@
 // uimanager.cpp: implementations of UI namespace
 
 #include <cstdarg>
+#include <cstdlib>
 #include "SDL_gfxPrimitives.h"
 
 #include "audio.h"
+#include "clock.h"
 #include "game.h"
 #include "renderer.h"
 #include "texture.h"
@@ -60,19 +62,93 @@ void UI::Button::initAnim(const Point &p, const ustring &text, int width, const
 	m_Anim.callback=slot;
 	m_Anim.texture1Active=true;
 	m_Anim.speed=(text!=STR_NULL ? 100 : 1000);
-	m_Anim.ticks=50;
+	m_Anim.ticks=50*Clock::FRAME_TIME;
 	m_Anim.sfx=sfx;
 	m_Anim.velocity=0; // 0 for idle, 1 for clicked
 	
 	m_IdleID=idle;
 	m_ActiveID=active;
+	m_IdleSym=Symbols::intern(idle);
+	m_ActiveSym=Symbols::intern(active);
 }
 
 // get the button's height
 int UI::Button::getHeight() const {
 	// NOTE: even though textures of text buttons are 26 px high, this should
 	// be changed so its customizable
-	return (m_Anim.txt==STR_NULL ? Textures::queryTexture(m_IdleID).h : 26);
+	return (m_Anim.txt==STR_NULL ? Textures::queryTexture(m_IdleSym).h : 26);
+}
+
+// count the steps of an animation that are due
+int UI::stepsDue(Animation &anim, int interval) {
+	int now=Clock::frame();
+	if (interval<1)
+		interval=1;
+	
+	// start counting if this is the first step
+	if (anim.lastDraw==0) {
+		anim.lastDraw=now;
+		Clock::schedule(now+interval);
+		return 1;
+	}
+	
+	// catch up on the missed steps, but drop anything beyond a hitch's worth
+	int steps=(now-anim.lastDraw)/interval;
+	if (steps>ANIM_MAX_STEPS) {
+		steps=ANIM_MAX_STEPS;
+		anim.lastDraw=now;
+	}
+	
+	// otherwise keep the remainder for the next frame
+	else
+		anim.lastDraw+=steps*interval;
+	
+	// the next step will be due after another interval
+	Clock::schedule(anim.lastDraw+interval);
+	
+	return steps;
+}
+
+// count the steps of a speed gated animation that are due
+int UI::gatedStepsDue(Animation &anim) {
+	Uint32 now=Clock::frame();
+	
+	// length of a step in frames at the tuned rate, and in thousandths of those frames
+	int frames=(anim.speed*ANIM_TUNED_FPS+999)/1000;
+	Uint64 period=1000*(Uint64) (frames>1 ? frames : 1);
+	
+	// index of the step on the grid that a time falls into
+	Uint64 step=((Uint64) now*ANIM_TUNED_FPS)/period;
+	
+	// the next step is due when the following one begins
+	Clock::schedule((Uint32) (((step+1)*period+ANIM_TUNED_FPS-1)/ANIM_TUNED_FPS));
+	
+	// take the first step right away
+	if (anim.lastDraw==0) {
+		anim.lastDraw=now;
+		return 1;
+	}
+	
+	// count the steps started since the last time, but drop anything beyond a hitch's worth
+	int steps=(int) (step-((Uint64) anim.lastDraw*ANIM_TUNED_FPS)/period);
+	anim.lastDraw=now;
+	
+	return (steps>ANIM_MAX_STEPS ? ANIM_MAX_STEPS : steps);
+}
+
+// apply an easing curve
+double UI::ease(Easing curve, double t) {
+	if (t<=0.0)
+		return 0.0;
+	else if (t>=1.0)
+		return 1.0;
+	
+	switch(curve) {
+		case EASE_IN: return t*t;
+		case EASE_OUT: return t*(2.0-t);
+		case EASE_IN_OUT: return (t<0.5 ? 2.0*t*t : -1.0+(4.0-2.0*t)*t);
+		default: return t;
+	}
 }
 
 // draw the button
@@ -81,13 +157,15 @@ void UI::Button::draw() {
 	if (m_Anim.txt!=STR_NULL) {
 		// if velocity is 1, then the button was clicked
 		if (m_Anim.velocity==1) {
-			int now=SDL_GetTicks();
+			Clock::busy();
+			
+			int now=Clock::frame();
 			if (now-m_Anim.lastDraw>m_Anim.speed) {
 				m_Anim.lastDraw=now;
 				m_Anim.texture1Active=!m_Anim.texture1Active;
 			}
 		
-			m_Anim.ticks-=1;
+			m_Anim.ticks-=Clock::delta();
 			if (m_Anim.ticks<=0) {
 				initAnim(m_Anim.current, m_Anim.txt, m_Anim.w, m_IdleID, m_ActiveID, m_Anim.callback, m_Anim.sfx);
 			
@@ -105,8 +183,10 @@ void UI::Button::draw() {
 	else {
 		// velocity is 1 if clicked, like above
 		if (m_Anim.velocity==1) {
+			Clock::busy();
+			
 			// time expired, switch to previous texture
-			int now=SDL_GetTicks();
+			int now=Clock::frame();
 			if (now-m_Anim.lastDraw>m_Anim.speed) {
 				m_Anim.lastDraw=now;
 				m_Anim.velocity=0;
@@ -116,11 +196,11 @@ void UI::Button::draw() {
 					m_Anim.callback->emit(m_ID);
 			}
 			
-			Renderer::drawImage(m_Anim.current, m_ActiveID);
+			Renderer::drawImage(m_Anim.current, m_ActiveSym);
 		}
 		
 		else
-			Renderer::drawImage(m_Anim.current, m_IdleID);
+			Renderer::drawImage(m_Anim.current, m_IdleSym);
 	}
 }
 
@@ -150,16 +230,22 @@ UI::Manager* UI::Manager::instance() {
 
 // frees any used memory
 void UI::Manager::free() {
-	for (std::map<ustring, UI::Button>::iterator it=m_Buttons.begin(); it!=m_Buttons.end(); ++it)
+	for (UI::ButtonMap::iterator it=m_Buttons.begin(); it!=m_Buttons.end(); ++it)
 		(*it).second.free();
 }
 
 // get a pointer to an animation struct
 UI::Animation* UI::Manager::getAnimation(const ustring &id) {
-	if (m_Animations.find(id)==m_Animations.end())
+	return getAnimation(Symbols::find(id));
+}
+
+// get a pointer to an animation struct by symbol
+UI::Animation* UI::Manager::getAnimation(Symbols::Symbol sym) {
+	AnimationMap::iterator it=m_Animations.find(sym);
+	if (it==m_Animations.end())
 		return NULL;
 	
-	return &m_Animations[id];
+	return &(*it).second;
 }
 
 // handle any mouse events on a gui element
@@ -175,45 +261,48 @@ void UI::Manager::handleGUIClick(const Point &p, const StringVector &ids) {
 	// iterate over provided buttons
 	for (int i=0; i<ids.size(); i++) {
 		// see if this button was clicked, and if it was, flag it
-		if (mouseOverButton(ids[i], p)) {
-			UI::Button *button=&m_Buttons[ids[i]];
-			button->click();
-		}
+		if (mouseOverButton(ids[i], p))
+			(*m_Buttons.find(Symbols::find(ids[i]))).second.click();
 	}
 }
 
 // reverse the velocity of a registered animation
 void UI::Manager::reverseVelocity(const ustring &id) {
 	// if this animation exists, multiply its velocity by -1
-	if (m_Animations.find(id)!=m_Animations.end()) {
-		UI::Animation &anim=m_Animations[id];
-		anim.velocity*=-1;
-	}
+	UI::Animation *anim=getAnimation(id);
+	if (anim)
+		anim->velocity*=-1;
 }
 
 // disable one texture of a synchronized bounce animation
 void UI::Manager::unsyncBounceTexture(const ustring &id, bool left) {
-	Animation &anim=m_Animations[id];
+	UI::Animation *anim=getAnimation(id);
+	if (!anim)
+		return;
+	
 	if (left)
-		anim.texture1Active=false;
+		anim->texture1Active=false;
 	else
-		anim.texture2Active=false;
+		anim->texture2Active=false;
 }
 
 // enable one texture of a synchronized bounce animation
 void UI::Manager::resyncBounceTexture(const ustring &id, bool left) {
-	Animation &anim=m_Animations[id];
+	UI::Animation *anim=getAnimation(id);
+	if (!anim)
+		return;
+	
 	if (left)
-		anim.texture1Active=true;
+		anim->texture1Active=true;
 	else
-		anim.texture2Active=true;
+		anim->texture2Active=true;
 }
 
 // see if any gui animations are still occurring
 bool UI::Manager::isGUIBusy() {
-	for (std::map<ustring, UI::Button>::iterator it=m_Buttons.begin(); it!=m_Buttons.end(); ++it) {
+	for (UI::ButtonMap::iterator it=m_Buttons.begin(); it!=m_Buttons.end(); ++it) {
 		if ((*it).second.isAnimating()) {
-			std::cout << (*it).first << std::endl;
+			std::cout << Symbols::name((Symbols::Symbol) (*it).first) << std::endl;
 			return true;
 		}
 	}
@@ -223,11 +312,12 @@ bool UI::Manager::isGUIBusy() {
 
 // check to see if the mouse is over a button
 bool UI::Manager::mouseOverButton(const ustring &id, const Point &p) {
-	if (m_Buttons.find(id)==m_Buttons.end()) {
+	ButtonMap::iterator it=m_Buttons.find(Symbols::find(id));
+	if (it==m_Buttons.end()) {
 		Utils::alert("Button id '"+id+"' doesn't exist!");
 		return false;
 	}
-	UI::Button &button=m_Buttons[id];
+	UI::Button &button=(*it).second;
 	
 	Rect rect(button.getOrigin(), button.getWidth(), button.getHeight());
 	return Utils::pointInRect(p, rect);
@@ -235,8 +325,8 @@ bool UI::Manager::mouseOverButton(const ustring &id, const Point &p) {
 
 // register a gui button
 void UI::Manager::registerGUIButton(const ustring &id, const Button &b) {
-	m_Buttons[id]=b;
-	UI::Button *button=&m_Buttons[id];
+	UI::Button *button=&m_Buttons[Symbols::intern(id)];
+	*button=b;
 	button->setID(id);
 }
 
@@ -274,7 +364,7 @@ void UI::Manager::registerSideBounceAnimation(const ustring &id, const ustring &
 	anim.texture=texture;
 	
 	// add this animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a fade out effect
@@ -290,7 +380,7 @@ void UI::Manager::registerFadeOut(const ustring &id, int speed, const AnimType &
 	anim.velocity=1;
 	
 	// add animatiom
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a flash effect
@@ -304,7 +394,7 @@ void UI::Manager::registerFlash(const ustring &id, int speed) {
 	anim.ticks=0;
 	
 	// add animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a court camera effect
@@ -320,7 +410,7 @@ void UI::Manager::registerCourtCameraMovement(const ustring &id) {
 	anim.current=Point(0, 0);
 	
 	// add animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a testimony sprite sequence animation
@@ -337,7 +427,7 @@ void UI::Manager::registerTestimonySequence(const ustring &id) {
 	anim.multiplier=3;
 	
 	// add animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a cross examination sprite sequence animation
@@ -356,7 +446,7 @@ void UI::Manager::registerCrossExamineSequence(const ustring &id) {
 	anim.multiplier=3;
 	
 	// add the animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a blinking animation
@@ -373,7 +463,7 @@ void UI::Manager::registerBlink(const ustring &id, const ustring &texture, const
 	anim.texture=texture;
 	
 	// add the animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a synchronized bounce animation
@@ -397,7 +487,7 @@ void UI::Manager::registerSyncBounce(const ustring &id, const ustring &tex1, con
 	anim.texture2Active=true;
 	
 	// add the animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a green bar control animation
@@ -415,7 +505,7 @@ void UI::Manager::registerGreenBarControl(const ustring &id, const ustring &text
 	anim.leftLimit=0; // amount to decrease
 	
 	// add the animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register an exclamation animation ("Objection!", "Hold It!", and "Take That!")
@@ -426,11 +516,12 @@ void UI::Manager::registerExclamation(const ustring &id, const ustring &texture,
 	anim.type=ANIM_EXCLAMATION;
 	anim.speed=75; // 1.25 seconds at 60 fps
 	anim.ticks=0;
+	anim.lastDraw=0;
 	anim.texture=texture;
 	anim.current=p;
 	
 	// add the animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a sliding background animation
@@ -440,11 +531,12 @@ void UI::Manager::registerBGSlide(const ustring &id) {
 	// fill in values
 	anim.type=ANIM_BG_SLIDE;
 	anim.speed=5;
+	anim.lastDraw=0;
 	anim.current=Point(0, 0);
 	anim.bottomLimit=192;
 	
 	// add the animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register an animation to handle adding evidence
@@ -459,7 +551,7 @@ void UI::Manager::registerAddEvidenceSequence(const ustring &id) {
 	anim.current=Point(256, 0, Z_ANIM_SPRITE);
 	
 	// add the animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register an alpha fade animation
@@ -474,7 +566,7 @@ void UI::Manager::registerAlphaDecay(const ustring &id, int alpha) {
 	anim.alpha=alpha;
 	
 	// add the animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // register a white flash animation
@@ -490,25 +582,34 @@ void UI::Manager::registerWhiteFlash(const ustring &id) {
 	anim.alpha=0;
 	
 	// add the animation
-	m_Animations[id]=anim;
+	m_Animations[Symbols::intern(id)]=anim;
 }
 
 // draw an animation
 void UI::Manager::drawAnimation(const ustring &id) {
-	// get the requested animation
-	if (!getAnimation(id)) {
+	Symbols::Symbol sym=Symbols::find(id);
+	if (sym==Symbols::NULL_SYMBOL) {
 		Utils::debugMessage("UIManager: animation '"+id+"' not registered.");
 		return;
 	}
 	
-	UI::Animation &anim=*getAnimation(id);
+	drawAnimation(sym);
+}
+
+// draw an arbitrary animation by symbol
+void UI::Manager::drawAnimation(Symbols::Symbol sym) {
+	// get the requested animation
+	UI::Animation *ptr=getAnimation(sym);
+	if (!ptr) {
+		Utils::debugMessage("UIManager: animation '"+Symbols::name(sym)+"' not registered.");
+		return;
+	}
 	
-	// see if it's time to progress the animation
-	int now=SDL_GetTicks();
-	if (now-anim.lastDraw>=anim.speed) {
-		// record this time
-		anim.lastDraw=now;
-		
+	UI::Animation &anim=*ptr;
+	
+	// progress the animation by as many steps as are due
+	int steps=UI::gatedStepsDue(anim);
+	for (int i=0; i<steps; i++) {
 		// see if we crossed the limit moving on x axis
 		if (anim.type==ANIM_SIDE_HBOUNCE) {
 			// moving left
@@ -530,13 +631,24 @@ void UI::Manager::drawAnimation(const ustring &id) {
 
 // draw a button
 void UI::Manager::drawButton(const ustring &id) {
-	if (m_Buttons.find(id)==m_Buttons.end()) {
+	Symbols::Symbol sym=Symbols::find(id);
+	if (sym==Symbols::NULL_SYMBOL) {
 		Utils::alert("Button id '"+id+"' doesn't exist!");
 		return;
 	}
 	
-	UI::Button *button=&m_Buttons[id];
-	button->draw();
+	drawButton(sym);
+}
+
+// draw a button by symbol
+void UI::Manager::drawButton(Symbols::Symbol sym) {
+	ButtonMap::iterator it=m_Buttons.find(sym);
+	if (it==m_Buttons.end()) {
+		Utils::alert("Button id '"+Symbols::name(sym)+"' doesn't exist!");
+		return;
+	}
+	
+	(*it).second.draw();
 }
 
 // fade out the current scene to black
@@ -550,12 +662,10 @@ UI::AnimStage UI::Manager::fadeOut(const ustring &id) {
 	UI::Animation &anim=*getAnimation(id);
 	
 	// see if it's time to increase the alpha
-	int now=SDL_GetTicks();
-	if (now-anim.lastDraw>=anim.speed) {
-		anim.lastDraw=now;
-		
-		// increment the alpha value by 1
-		anim.alpha+=(2*anim.speed)*anim.velocity;
+	int steps=UI::gatedStepsDue(anim);
+	if (steps>0) {
+		// increment the alpha value for each step
+		anim.alpha+=(2*anim.speed)*anim.velocity*steps;
 		
 		// clamp values
 		if (anim.alpha>255) anim.alpha=255;
@@ -624,7 +734,7 @@ UI::AnimStage UI::Manager::animateAddEvidence(const ustring &id, const Case::Evi
 	// moving the info strip to the left
 	int x=anim.current.x();
 	if (x!=0) {
-		anim.current.setX(x-anim.speed);
+		anim.current.setX(x-anim.speed*UI::stepsDue(anim, Clock::FRAME_TIME));
 		
 		// still moving left initially
 		if (anim.velocity==1) {
@@ -664,7 +774,6 @@ UI::AnimStage UI::Manager::whiteFlash(const ustring &id) {
 	Animation &anim=*getAnimation(id);
 	
 	// first, fade out into white
-	int now=SDL_GetTicks();
 	if (anim.velocity==1) {
 		// play the initial wooshing sound effect
 		if (anim.sfx=="0") {
@@ -673,10 +782,7 @@ UI::AnimStage UI::Manager::whiteFlash(const ustring &id) {
 		}
 		
 		// increase the alpha
-		if (now-anim.lastDraw>=anim.speed) {
-			anim.lastDraw=now;
-			anim.alpha+=anim.velocity*anim.multiplier;
-		}
+		anim.alpha+=anim.velocity*anim.multiplier*UI::gatedStepsDue(anim);
 		
 		// we've reached the mid point
 		if (anim.alpha>255) {
@@ -692,10 +798,7 @@ UI::AnimStage UI::Manager::whiteFlash(const ustring &id) {
 	
 	else {
 		// decrease the alpha at a much faster pace
-		if (now-anim.lastDraw>=anim.speed) {
-			anim.lastDraw=now;
-			anim.alpha+=anim.velocity;
-		}
+		anim.alpha+=anim.velocity*UI::gatedStepsDue(anim);
 		
 		// we're done if the alpha is less than or equal to zero
 		if (anim.alpha<=0)
@@ -718,12 +821,13 @@ bool UI::Manager::flash(const ustring &id) {
 	Animation &anim=*getAnimation(id);
 	bool ret;
 	
-	// increment tick count
-	anim.ticks++;
+	// increment tick count by the frames that passed
+	anim.ticks+=UI::stepsDue(anim, Clock::FRAME_TIME);
 	
 	// we're done
 	if (anim.ticks>=anim.speed) {
 		anim.ticks=0;
+		anim.lastDraw=0;
 		anim.alpha=0;
 		ret=false;
 	}
@@ -752,12 +856,9 @@ bool UI::Manager::blink(const ustring &id) {
 	// get the texture
 	Textures::Texture tex=Textures::queryTexture(anim.texture);
 	
-	// see if it's time to display the image
-	int now=SDL_GetTicks();
-	if (now-anim.lastDraw>anim.speed) {
-		anim.lastDraw=now;
+	// see if it's time to display the image, or hide it again
+	if (UI::gatedStepsDue(anim)%2==1)
 		anim.velocity=(anim.velocity ? 0 : 1);
-	}
 	
 	// if our velocity (in this context, to draw or not) is positive, we draw the texture
 	if (anim.velocity)
@@ -777,17 +878,15 @@ bool UI::Manager::decayAlpha(const ustring &id, int &alpha) {
 	Animation &anim=*getAnimation(id);
 	
 	// decrement the alpha value
-	int now=SDL_GetTicks();
-	if (now-anim.lastDraw>anim.speed) {
-		if (anim.alpha-anim.multiplier<=0) {
+	int steps=UI::gatedStepsDue(anim);
+	if (steps>0) {
+		if (anim.alpha-anim.multiplier*steps<=0) {
 			anim.alpha=0;
 			return true;
 		}
 		
 		else
-			anim.alpha-=anim.multiplier;
-		
-		anim.lastDraw=now;
+			anim.alpha-=anim.multiplier*steps;
 	}
 	
 	// update the parameter
@@ -812,7 +911,7 @@ bool UI::Manager::moveCourtCamera(const ustring &id, UI::Limit start, UI::Limit
 	Point &cur=anim.current;
 	
 	// get the panorama texture
-	Textures::Texture panorama=Textures::queryTexture("court_panorama");
+	Textures::Texture panorama=Textures::queryTexture(Symbols::SYM_COURT_PANORAMA);
 	
 	// modify velocity based on direction once
 	if (anim.velocity==0) {
@@ -838,70 +937,52 @@ bool UI::Manager::moveCourtCamera(const ustring &id, UI::Limit start, UI::Limit
 			else if (end==UI::LIMIT_DEFENSE_STAND)
 				anim.velocity=-1;
 		}
+		
+		// remember where and when the movement started
+		anim.p1=cur;
+		anim.lastDraw=Clock::frame();
+	}
+	
+	// calculate the end point
+	int endPt=cur.x();
+	if (end==UI::LIMIT_DEFENSE_STAND)
+		endPt=0;
+	else if (end==UI::LIMIT_PROSECUTOR_STAND)
+		endPt=panorama.w-256;
+	else if (end==UI::LIMIT_WITNESS_STAND)
+		endPt=472;
+	
+	// the camera takes as long as it did moving by multiplier pixels every 8ms, 
+	// but eases in and out of the movement
+	int distance=abs(endPt-anim.p1.x());
+	int duration=distance*8/anim.multiplier;
+	int elapsed=Clock::frame()-anim.lastDraw;
+	
+	// we've reached the end point, so start over next time
+	if (elapsed>=duration) {
+		cur.setX(endPt);
+		anim.velocity=0;
+		ret=true;
 	}
 	
 	// move the panorama
-	int now=SDL_GetTicks();
-	if (now-anim.lastDraw>7) {
-		anim.lastDraw=now;
-		
-		// calculate real velocity based on multiplier value
-		int velocity=anim.velocity*anim.multiplier;
-		
-		// calculate the end point
-		int endPt;
-		if (end==UI::LIMIT_DEFENSE_STAND)
-			endPt=0;
-		else if (end==UI::LIMIT_PROSECUTOR_STAND)
-			endPt=panorama.w-256;
-		else if (end==UI::LIMIT_WITNESS_STAND)
-			endPt=472;
-		
-		// cache our x coordinate
-		int x=cur.x();
-		
-		// moving the camera to the left
-		if (velocity<0) {
-			// if we are still not done, move the camera
-			if (x>endPt) {
-				// make sure not to overshoot the end point
-				if (x+velocity<=endPt)
-					cur.setX(endPt);
-				else
-					cur.setX(x+velocity);
-			}
-			
-			// we're reached the end point
-			else
-				ret=true;
-		}
+	else {
+		Clock::busy();
 		
-		// moving camera to the right
-		else if (velocity>0) {
-			// if we are still not done, move the camera
-			if (x<endPt) {
-				// once again, make sure not to overshoot the far right point
-				if (x+velocity>=endPt)
-					cur.setX(endPt);
-				else
-					cur.setX(x+velocity);
-			}
-			
-			// we're done
-			else
-				ret=true;
-		}
+		double progress=UI::ease(UI::EASE_IN_OUT, (double) elapsed/duration);
+		cur.setX(anim.p1.x()+(int) ((endPt-anim.p1.x())*progress));
 	}
 	
-	// now use the panorama texture
-	glBindTexture(GL_TEXTURE_2D, panorama.id);
-	
-	// save our current matrix
-	glPushMatrix();
-	glLoadIdentity();
+	// draw anything queued so far with the current matrix
+	Renderer::flush();
 	
-	// and translate our texture by however much pixels the current point is at
-	glTranslatef(-cur.x(), 0, 0);
+	// save our current matrix, and translate our texture by however 
+	// much pixels the current point is at
+	if (Renderer::g_Output) {
+		glPushMatrix();
+		glLoadIdentity();
+		glTranslatef(-cur.x(), 0, 0);
+	}
 	
 	Case::Case *pCase=Game::instance()->getCase();
 	
@@ -918,15 +999,17 @@ bool UI::Manager::moveCourtCamera(const ustring &id, UI::Limit start, UI::Limit
 	Character *witness=pCase->getCharacter(wStand->character);
 	
 	// draw the benches for each character
-	Renderer::drawImage(Point(0, 0, Z_SPRITE+0.1f), "defense_bench");
-	Renderer::drawImage(Point(520, 0, Z_SPRITE+0.1f), "witness_bench");
-	Renderer::drawImage(Point(panorama.w-256, 0, Z_SPRITE+0.1f), "prosecutor_bench");
+	Renderer::drawImage(Point(0, 0, Z_SPRITE+0.1f), Symbols::SYM_DEFENSE_BENCH);
+	Renderer::drawImage(Point(520, 0, Z_SPRITE+0.1f), Symbols::SYM_WITNESS_BENCH);
+	Renderer::drawImage(Point(panorama.w-256, 0, Z_SPRITE+0.1f), Symbols::SYM_PROSECUTOR_BENCH);
 	
 	if (defense) defense->getSprite()->renderFrame(Point(0, 0, Z_SPRITE));
 	if (witness) witness->getSprite()->renderFrame(Point(520, 0, Z_SPRITE));
 	if (prosecutor) prosecutor->getSprite()->renderFrame(Point(panorama.w-256, 0, Z_SPRITE));
 	
-	glPopMatrix();
+	Renderer::flush();
+	if (Renderer::g_Output)
+		glPopMatrix();
 	
 	return ret;
 }
@@ -949,6 +1032,9 @@ bool UI::Manager::animateTestimonySequence(const ustring &id) {
 		return true;
 	}
 	
+	// see how many frames worth of movement are due
+	int steps=UI::stepsDue(anim, Clock::FRAME_TIME);
+	
 	// now get sprites
 	Sprite *stt=tt->getSprite();
 	Sprite *stb=tb->getSprite();
@@ -980,8 +1066,8 @@ bool UI::Manager::animateTestimonySequence(const ustring &id) {
 			}
 			
 			// move sprites across the screen
-			anim.topLimit+=1*anim.multiplier;
-			anim.bottomLimit-=3*anim.multiplier;
+			anim.topLimit+=1*anim.multiplier*steps;
+			anim.bottomLimit-=3*anim.multiplier*steps;
 			
 			// center the top
 			if (anim.topLimit>=centerxTop)
@@ -1002,8 +1088,8 @@ bool UI::Manager::animateTestimonySequence(const ustring &id) {
 			}
 			
 			// move sprites across the screen
-			anim.topLimit+=1*anim.multiplier;
-			anim.bottomLimit-=1*anim.multiplier;
+			anim.topLimit+=1*anim.multiplier*steps;
+			anim.bottomLimit-=1*anim.multiplier*steps;
 			
 			// clamp the top limit
 			if (anim.topLimit>=256)
@@ -1033,7 +1119,7 @@ bool UI::Manager::animateTestimonySequence(const ustring &id) {
 		if (ticks<5) {
 			// draw the rectangle
 			Renderer::drawRect(Rect(Point(0, 0, Z_FADE), 256, 192), Color(255, 255, 255));
-			ticks++;
+			ticks+=steps;
 		}
 		
 		// once that's done, proceed to animate the sprites
@@ -1078,6 +1164,9 @@ bool UI::Manager::animateCrossExamineSequence(const ustring &id, const Textures:
 		return true;
 	}
 	
+	// see how many frames worth of movement are due
+	int steps=UI::stepsDue(anim, Clock::FRAME_TIME);
+	
 	// now get sprites
 	Sprite *xtt=xt->getSprite();
 	Sprite *xtb=xb->getSprite();
@@ -1099,7 +1188,7 @@ bool UI::Manager::animateCrossExamineSequence(const ustring &id, const Textures:
 	static int yBottom=topFr.h+10;
 	
 	// for the lower screen, always draw the colorized court overview
-	Renderer::drawImage(Point(0, 197, 1.0f), "court_overview_c");
+	Renderer::drawImage(Point(0, 197, 1.0f), Symbols::SYM_COURT_OVERVIEW_C);
 	
 	// now draw bounding rectangles for containment of lawyer images
 	Renderer::drawRect(Rect(Point(0, 227, 1.1f), 256, 2), Color(0, 0, 0));
@@ -1109,8 +1198,8 @@ bool UI::Manager::animateCrossExamineSequence(const ustring &id, const Textures:
 	Renderer::drawRect(Rect(Point(0, 357, 1.1f), 256, 2), Color(0, 0, 0));
 	
 	// then draw the blue line images
-	Renderer::drawImage(Point(0, 229, 1.2f), "blueline");
-	Renderer::drawImage(Point(0, 309, 1.2f), "blueline");
+	Renderer::drawImage(Point(0, 229, 1.2f), Symbols::SYM_BLUELINE);
+	Renderer::drawImage(Point(0, 309, 1.2f), Symbols::SYM_BLUELINE);
 	
 	// and finally, draw the two lawyers' images
 	Renderer::drawImage(Point(anim.leftLimit, 229, 1.3f), leftImg);
@@ -1133,8 +1222,8 @@ bool UI::Manager::animateCrossExamineSequence(const ustring &id, const Textures:
 			}
 			
 			// move sprites across the screen
-			anim.topLimit+=1*anim.multiplier;
-			anim.bottomLimit-=3*anim.multiplier;
+			anim.topLimit+=1*anim.multiplier*steps;
+			anim.bottomLimit-=3*anim.multiplier*steps;
 			
 			// center the top
 			if (anim.topLimit>=centerxTop)
@@ -1160,7 +1249,7 @@ bool UI::Manager::animateCrossExamineSequence(const ustring &id, const Textures:
 				return true;
 			
 			// increase the y delta
-			anim.delta.setY(anim.delta.y()+2*anim.multiplier);
+			anim.delta.setY(anim.delta.y()+2*anim.multiplier*steps);
 		}
 		
 		// draw top sprite frame
@@ -1206,7 +1295,7 @@ bool UI::Manager::animateCrossExamineSequence(const ustring &id, const Textures:
 		if (ticks<8) {
 			// draw the rectangle
 			Renderer::drawRect(Rect(Point(0, 0, Z_FADE), 256, 192), Color(255, 255, 255));
-			ticks++;
+			ticks+=steps;
 		}
 		
 		// once that's done, proceed to animate the sprites
@@ -1230,11 +1319,11 @@ bool UI::Manager::animateCrossExamineSequence(const ustring &id, const Textures:
 	
 	// the two lawyer images should move ever so slightly as well
 	static int ticks=0;
-	if (SDL_GetTicks()-ticks>300) {
+	if (Clock::frame()-ticks>300) {
 		anim.rightLimit-=1;
 		anim.leftLimit+=1;
 		
-		ticks=SDL_GetTicks();
+		ticks=Clock::frame();
 	}
 	
 	return false;
@@ -1250,11 +1339,9 @@ bool UI::Manager::animateSyncBounce(const ustring &id) {
 	
 	Animation &anim=*getAnimation(id);
 	
-	// see if its time to progress the animation
-	int now=SDL_GetTicks();
-	if (now-anim.lastDraw>=anim.speed) {
-		anim.lastDraw=now;
-		
+	// progress the animation by as many steps as are due
+	int steps=UI::gatedStepsDue(anim);
+	for (int i=0; i<steps; i++) {
 		// moving outward
 		if (anim.velocity==1) {
 			if (anim.delta.x()>=anim.rightLimit)
@@ -1296,14 +1383,12 @@ bool UI::Manager::animateGreenBar(const ustring &id) {
 	Textures::Texture texture=Textures::queryTexture(anim.texture);
 	
 	// see if we need to progress the animation
-	int now=SDL_GetTicks();
-	if (now-anim.lastDraw>=anim.speed) {
-		anim.lastDraw=now;
-		
+	int steps=UI::gatedStepsDue(anim);
+	if (steps>0) {
 		// decrease fill in percentage until leftLimit is 0
 		if (anim.leftLimit!=0) {
-			anim.rightLimit-=anim.velocity;
-			anim.leftLimit-=anim.velocity;
+			anim.rightLimit-=anim.velocity*steps;
+			anim.leftLimit-=anim.velocity*steps;
 			
 			// clamp the value
 			if (anim.leftLimit<0)
@@ -1365,8 +1450,8 @@ bool UI::Manager::exclamation(const ustring &id, const Audio::Sample *effect, co
 		// draw the texture
 		Renderer::drawImage(anim.current+shake, texture);
 		
-		// increment tick counter
-		anim.ticks++;
+		// increment tick counter by the frames that passed
+		anim.ticks+=UI::stepsDue(anim, Clock::FRAME_TIME);
 		
 		return false;
 	}
@@ -1374,6 +1459,7 @@ bool UI::Manager::exclamation(const ustring &id, const Audio::Sample *effect, co
 	// we're done
 	else {
 		anim.ticks=0;
+		anim.lastDraw=0;
 		return true;
 	}
 }
@@ -1396,7 +1482,7 @@ bool UI::Manager::slideBG(const ustring &id, const GLuint &bg) {
 	if (y!=192) {
 		// draw the texture at this current point
 		Renderer::drawImage(Point(0, y+5, 1.5f), tex);
-		y+=anim.speed;
+		y+=anim.speed*UI::stepsDue(anim, Clock::FRAME_TIME);
 		if (y>192)
 			y=192;
 		
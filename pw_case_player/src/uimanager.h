@@ -25,11 +25,13 @@
 #include <iostream>
 #include <GL/gl.h>
 #include <map>
+#include <tr1/unordered_map>
 #include "SDL.h"
 
 #include "audio.h"
 #include "callback.h"
 #include "common.h"
+#include "symbols.h"
 #include "texture.h"
 
 class Case::Case;
@@ -53,6 +55,19 @@ enum AnimStage { STAGE_ANIM_INITIAL=-1,		/// The animation is progressing from t
 		 STAGE_ANIM_END 		/// The animation has completed
 };
 
+/// Easing curves for animations that run for a set amount of time
+enum Easing { EASE_LINEAR=0,		///< Constant speed
+	      EASE_IN,			///< Start slow and speed up
+	      EASE_OUT,			///< Start fast and slow down
+	      EASE_IN_OUT		///< Start and end slow
+};
+
+/// Most steps an animation takes in one frame to catch up after a hitch
+const int ANIM_MAX_STEPS=16;
+
+/// Frame rate that the speed of animations was tuned at
+const int ANIM_TUNED_FPS=65;
+
 /// Types of animations
 enum AnimType { ANIM_SIDE_HBOUNCE=0,
 		ANIM_SIDE_VBOUNCE,
@@ -150,11 +165,39 @@ struct _Animation {
 	/// The duration of the animation in milliseconds
 	int speed;
 	
-	/// The last time this animation was drawn
+	/// Time on the frame clock up to which this animation was advanced, or 0 if it hasn't started
 	int lastDraw;
 };
 typedef struct _Animation Animation;
 
+/** Count how many steps of an animation are due.
+  * Animations move in steps of a fixed length of time, and take as many steps in 
+  * a frame as fit in the time that passed on the frame clock, so their speed doesn't 
+  * depend on the frame rate. The first time an animation is advanced, a single step 
+  * is taken. After a hitch, at most ANIM_MAX_STEPS are taken and any time beyond 
+  * that is dropped.
+  * \param anim The animation, whose lastDraw time is moved forward by the steps taken
+  * \param interval Length of a single step, in milliseconds
+  * \return The amount of steps to take, from 0 to ANIM_MAX_STEPS
+*/
+int stepsDue(Animation &anim, int interval);
+
+/** Count how many steps of an animation are due, based on its speed.
+  * At the frame rate they were tuned at, these animations took a single step on the 
+  * first frame after at least their speed in milliseconds had passed. Steps are counted 
+  * on that same grid of frames, so the animation lasts as long at any frame rate.
+  * \param anim The animation, whose lastDraw time is moved forward
+  * \return The amount of steps to take, from 0 to ANIM_MAX_STEPS
+*/
+int gatedStepsDue(Animation &anim);
+
+/** Apply an easing curve
+  * \param curve The easing curve
+  * \param t Progress of the animation, from 0.0 to 1.0
+  * \return The eased progress, from 0.0 to 1.0
+*/
+double ease(Easing curve, double t);
+
 /** Class that represents a GUI button.
   * For simplicity, each GUI button has to be allocated by providing this class
   * with the proper values. The UI::Manager then handles converting the values to 
@@ -238,9 +281,18 @@ class Button {
 		ustring m_IdleID;
 		ustring m_ActiveID;
 		
+		Symbols::Symbol m_IdleSym;
+		Symbols::Symbol m_ActiveSym;
+		
 		Animation m_Anim;
 };
 
+/// Hashed table of animations, keyed by the symbol of their ID
+typedef std::tr1::unordered_map<int, Animation> AnimationMap;
+
+/// Hashed table of buttons, keyed by the symbol of their ID
+typedef std::tr1::unordered_map<int, Button> ButtonMap;
+
 /** The core class that manages all user interface animations and GUI effects.
   * This class is responsible for storing, allocating, and drawing various types of
   * animations that are found in the player. There should only be once instance of this
@@ -278,6 +330,12 @@ class Manager {
 		*/
 		Animation* getAnimation(const ustring &id);
 		
+		/** Get a pointer to an animation struct
+		  * \param sym The interned ID of the animation
+		  * \return A pointer to the Animation struct requested, NULL if it doesn't exist
+		*/
+		Animation* getAnimation(Symbols::Symbol sym);
+		
 		/** Handle any mouse events on a GUI element
 		  * \param mouse Current position of cursor
 		  * \param id ID of GUI element to check
@@ -316,7 +374,13 @@ class Manager {
 		  * \param id The button's ID
 		  * \return A pointer to the requested button
 		*/
-		Button* getButton(const ustring &id) { return &m_Buttons[id]; }
+		Button* getButton(const ustring &id) { return &m_Buttons[Symbols::intern(id)]; }
+		
+		/** Get a button from the internal stack
+		  * \param sym The interned ID of the button
+		  * \return A pointer to the requested button
+		*/
+		Button* getButton(Symbols::Symbol sym) { return &m_Buttons[sym]; }
 		
 		/** Check to see if the mouse is over a button
 		  * \param id The ID of the button to check
@@ -441,11 +505,21 @@ class Manager {
 		*/
 		void drawAnimation(const ustring &id);
 		
+		/** Draw an arbitrary animation
+		  * \param sym The interned ID of the animation
+		*/
+		void drawAnimation(Symbols::Symbol sym);
+		
 		/** Draw a button
 		  * \param id The button's ID
 		*/
 		void drawButton(const ustring &id);
 		
+		/** Draw a button
+		  * \param sym The interned ID of the button
+		*/
+		void drawButton(Symbols::Symbol sym);
+		
 		/** Fade out the current scene to black
 		  * \param id The ID of the animation
 		  * \return An animation return code (see the description of these functions)
@@ -538,10 +612,10 @@ class Manager {
 		Case::Case *m_Case;
 		
 		/// Map of registered animations
-		std::map<ustring, Animation> m_Animations;
+		AnimationMap m_Animations;
 		
 		/// Map of registered GUI buttons
-		std::map<ustring, Button> m_Buttons;
+		ButtonMap m_Buttons;
 };
 
 }; // namespace UI
@@ -22,6 +22,7 @@
 #include <cmath>
 #include <dirent.h>
 #include <sstream>
+#include <unistd.h>
 
 // include windows.h for directory/file management functions
 #ifdef __WIN32__
@@ -31,11 +32,16 @@
 #endif
 
 #include "font.h"
+#include "input.h"
 #include "utilities.h"
 
 namespace Utils {
 	bool g_DebugOn=false;
 	bool g_IDebugOn=false;
+	
+	// random number generator state
+	Uint32 g_RandomSeed=1;
+	Uint32 g_RandomState=1;
 }
 
 // get the current working directory
@@ -272,6 +278,17 @@ void Utils::setRGBAMasks(Uint32 &r, Uint32 &g, Uint32 &b, Uint32 &a) {
 #endif
 }
 
+// seed the random number generator
+void Utils::seedRandom(Uint32 seed) {
+	g_RandomSeed=seed;
+	g_RandomState=seed;
+}
+
+// get the last random seed
+Uint32 Utils::getRandomSeed() {
+	return g_RandomSeed;
+}
+
 // get a random number in the provided range
 int Utils::randomRange(int min, int max) {
 	// programmer stupidity check
@@ -285,18 +302,32 @@ int Utils::randomRange(int min, int max) {
 	if (min==max)
 		return min;
 	
+	// advance the generator; a plain lcg is good enough for visual effects
+	g_RandomState=g_RandomState*1103515245+12345;
+	
 	// return a randomized number
-	int num=(rand()%(max-min+1))+min;
+	int num=((g_RandomState >> 16) & 0x7fff)%(max-min+1)+min;
 	return num;
 }
 
+// get the amount of processors available
+int Utils::processorCount() {
+	int count=1;
+#ifndef __WIN32__
+	count=sysconf(_SC_NPROCESSORS_ONLN);
+#else
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	count=info.dwNumberOfProcessors;
+#endif
+	
+	return (count<1 ? 1 : count);
+}
+
 // get the location of the mouse pointer
 Point Utils::getMouseLocation(Uint8 *modState) {
-	int x, y;
-	Uint8 state=SDL_GetMouseState(&x, &y);
-	if (modState)
-		(*modState)=state;
-	return Point(x, y);
+	// the tracked state is used, so that recorded input plays back the same
+	return Input::getMouseLocation(modState);
 }
 
 // create a blank surface
@@ -320,6 +351,11 @@ ustring Utils::itoa(int num) {
 
 // convert a ustring to array of Uint16's
 Uint16* Utils::ustringToArray(const ustring &str) {
+	return ustringToArray(toUTF32(str));
+}
+
+// convert a decoded string to array of Uint16's
+Uint16* Utils::ustringToArray(const UTF32String &str) {
 	Uint16 *array=new Uint16[str.size()+1];
 	for (int i=0; i<str.size(); i++)
 		array[i]=str[i];
@@ -328,6 +364,29 @@ Uint16* Utils::ustringToArray(const ustring &str) {
 	return array;
 }
 
+// decode a utf-8 string
+UTF32String Utils::toUTF32(const ustring &str) {
+	// walk the string with iterators, since indexing utf-8 is linear
+	UTF32String decoded;
+	decoded.reserve(str.bytes());
+	for (ustring::const_iterator it=str.begin(); it!=str.end(); ++it)
+		decoded+=*it;
+	
+	return decoded;
+}
+
+// encode a decoded string as utf-8
+ustring Utils::fromUTF32(const UTF32String &str) {
+	std::string utf8;
+	utf8.reserve(str.size());
+	for (int i=0; i<str.size(); i++) {
+		char buf[6];
+		utf8.append(buf, g_unichar_to_utf8(str[i], buf));
+	}
+	
+	return ustring(utf8);
+}
+
 // break a string apart based on a delimiting string
 StringVector Utils::explodeString(const ustring &delimiter, const ustring &strc) {
 	ustring str=strc;
@@ -128,6 +128,18 @@ Point calculateShakePoint(int highestRadius);
 */
 void setRGBAMasks(Uint32 &r, Uint32 &g, Uint32 &b, Uint32 &a);
 
+/** Seed the random number generator.
+  * The generator doesn't depend on the C library, so the same seed gives the 
+  * same sequence on every platform.
+  * \param seed The seed to use
+*/
+void seedRandom(Uint32 seed);
+
+/** Get the seed the random number generator was last seeded with
+  * \return The seed
+*/
+Uint32 getRandomSeed();
+
 /** Get a random number in the provided range
   * \param min The lower value in the range
   * \param max The upper value in the range
@@ -135,6 +147,11 @@ void setRGBAMasks(Uint32 &r, Uint32 &g, Uint32 &b, Uint32 &a);
 */
 int randomRange(int min, int max);
 
+/** Get the amount of processors available on this system
+  * \return Amount of online processors, at least 1
+*/
+int processorCount();
+
 /** Get the location of the mouse pointer
   * \param modState Optional SDL mod button state
   * \return The current mouse location
@@ -167,6 +184,25 @@ ustring itoa(int num);
 */
 Uint16* ustringToArray(const ustring &str);
 
+/** Convert a decoded string to an array of Uint16's
+  * \warning The returned array needs to be freed afterwards
+  * \param str The string to convert
+  * \return An array of Uint16's representing the string
+*/
+Uint16* ustringToArray(const UTF32String &str);
+
+/** Decode a UTF-8 string into Unicode characters
+  * \param str The string to decode
+  * \return The decoded string
+*/
+UTF32String toUTF32(const ustring &str);
+
+/** Encode a string of Unicode characters as UTF-8
+  * \param str The string to encode
+  * \return The encoded string
+*/
+ustring fromUTF32(const UTF32String &str);
+
 /** Break a string apart based on a delimiting substring
   * \param delimiter The substring to use as a separator
   * \param str The string to break apart
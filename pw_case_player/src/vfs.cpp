@@ -0,0 +1,91 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// vfs.cpp: implementation of the VFS namespace
+
+#include "vfs.h"
+
+namespace VFS {
+
+std::map<ustring, File> g_Files;
+
+}
+
+// normalize a path to the form used for keys
+static ustring normalize(const ustring &path) {
+	ustring str=path;
+	
+	// windows paths use a different separator
+	for (int i=0; i<str.size(); i++) {
+		if (str[i]=='\\')
+			str.replace(i, 1, "/");
+	}
+	
+	// remove any leading current directory components
+	while(str.size()>2 && str.substr(0, 2)=="./")
+		str.erase(0, 2);
+	
+	return str;
+}
+
+// add a file
+void VFS::addFile(const ustring &path, char *data, int size) {
+	ustring key=normalize(path);
+	
+	// replace any previous file
+	if (g_Files.find(key)!=g_Files.end())
+		delete [] g_Files[key].data;
+	
+	File file;
+	file.data=data;
+	file.size=size;
+	g_Files[key]=file;
+}
+
+// get a file held in memory
+const VFS::File* VFS::getFile(const ustring &path) {
+	std::map<ustring, File>::iterator it=g_Files.find(normalize(path));
+	if (it==g_Files.end())
+		return NULL;
+	
+	return &(*it).second;
+}
+
+// see if a file is held in memory
+bool VFS::exists(const ustring &path) {
+	return (getFile(path)!=NULL);
+}
+
+// open a file through sdl
+SDL_RWops* VFS::open(const ustring &path) {
+	const File *file=getFile(path);
+	if (file)
+		return SDL_RWFromConstMem(file->data, file->size);
+	
+	// fall back to the disk
+	return SDL_RWFromFile(path.c_str(), "rb");
+}
+
+// free all files
+void VFS::clear() {
+	for (std::map<ustring, File>::iterator it=g_Files.begin(); it!=g_Files.end(); ++it)
+		delete [] (*it).second.data;
+	
+	g_Files.clear();
+}
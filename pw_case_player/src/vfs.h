@@ -0,0 +1,79 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// vfs.h: in-memory resource file system
+
+#ifndef VFS_H
+#define VFS_H
+
+#include <map>
+#include "SDL.h"
+
+#include "common.h"
+
+/** Namespace for files read from the resource pack.
+  * Instead of extracting the resource pack to disk, each of its entries is 
+  * decompressed into a memory buffer once, and kept for the lifetime of the player. 
+  * Paths are relative to the root of the archive, such as "data/theme.xml". Files 
+  * which aren't part of the resource pack are read from disk instead.
+*/
+namespace VFS {
+
+/// Struct representing a file held in memory
+struct _File {
+	char *data;	///< The contents of the file
+	int size;	///< Size of the contents in bytes
+};
+typedef struct _File File;
+
+/// Map of archive paths to file contents
+extern std::map<ustring, File> g_Files;
+
+/** Add a file to the file system
+  * \param path The path of the file
+  * \param data The contents of the file, allocated with new[]; ownership is taken
+  * \param size The size of the contents in bytes
+*/
+void addFile(const ustring &path, char *data, int size);
+
+/** Get a file held in memory
+  * \param path The path of the file
+  * \return Pointer to the file, or NULL if it isn't in memory
+*/
+const File* getFile(const ustring &path);
+
+/** See if a file is held in memory
+  * \param path The path of the file
+  * \return <b>true</b> if it is, <b>false</b> otherwise
+*/
+bool exists(const ustring &path);
+
+/** Open a file for reading through SDL
+  * Files not held in memory are opened from disk.
+  * \param path The path of the file
+  * \return An SDL_RWops structure, or NULL on error
+*/
+SDL_RWops* open(const ustring &path);
+
+/// Free all files held in memory
+void clear();
+
+}; // namespace VFS
+
+#endif
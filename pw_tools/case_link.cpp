@@ -0,0 +1,742 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Mike Polan                                      *
+ *   kanadakid@gmail.com                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+// case_link.cpp: case linker and dependency graph tool
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <tr1/unordered_map>
+#include <vector>
+
+#include "common.h"
+
+// kinds of objects that script arguments can refer to
+enum RefKind { REF_NONE=0, REF_BLOCK, REF_TESTIMONY, REF_LOCATION, REF_EVIDENCE, REF_CHARACTER,
+	       REF_ITEM, REF_STATE, REF_BACKGROUND, REF_IMAGE, REF_AUDIO, REF_KIND_COUNT };
+
+// names of each kind, used in reports and in the graph
+static const char *g_KindNames[REF_KIND_COUNT]={
+	"case", "block", "testimony", "location", "evidence", "character",
+	"item", "state", "background", "image", "audio"
+};
+
+// what each argument of a trigger refers to
+struct _TriggerRefs {
+	const char *name;
+	RefKind args[3];
+};
+typedef struct _TriggerRefs TriggerRefs;
+
+// triggers that refer to other objects; arguments not listed refer to nothing
+static const TriggerRefs g_TriggerRefs[]={
+	{ "goto", { REF_BLOCK } },
+	{ "direct_goto", { REF_BLOCK } },
+	{ "timed_goto", { REF_BLOCK } },
+	{ "add_evidence_silent", { REF_EVIDENCE } },
+	{ "add_evidence_animated", { REF_EVIDENCE } },
+	{ "add_profile", { REF_CHARACTER } },
+	{ "show_evidence", { REF_EVIDENCE } },
+	{ "set_location", { REF_LOCATION } },
+	{ "add_location", { REF_LOCATION, REF_LOCATION } },
+	{ "set_location_trigger", { REF_LOCATION, REF_BLOCK } },
+	{ "set_animation", { REF_CHARACTER } },
+	{ "put_character", { REF_CHARACTER, REF_LOCATION } },
+	{ "add_talk_option", { REF_CHARACTER, REF_NONE, REF_BLOCK } },
+	{ "remove_talk_option", { REF_CHARACTER } },
+	{ "clear_talk_options", { REF_CHARACTER } },
+	{ "add_presentable", { REF_CHARACTER, REF_ITEM, REF_BLOCK } },
+	{ "remove_presentable", { REF_CHARACTER, REF_ITEM } },
+	{ "clear_presentables", { REF_CHARACTER } },
+	{ "set_bad_presentable_block", { REF_CHARACTER, REF_BLOCK } },
+	{ "set_location_music", { REF_AUDIO, REF_LOCATION } },
+	{ "clear_location_music", { REF_LOCATION } },
+	{ "play_music", { REF_AUDIO } },
+	{ "sfx", { REF_AUDIO } },
+	{ "speaker", { REF_CHARACTER } },
+	{ "set_court_overview_image", { REF_NONE, REF_IMAGE } },
+	{ "set_temp_image", { REF_IMAGE } },
+	{ "display_testimony", { REF_TESTIMONY } },
+	{ "cross_examine", { REF_TESTIMONY } },
+	{ "change_character_gender", { REF_CHARACTER } },
+	{ "change_character_name", { REF_CHARACTER } },
+	{ "change_character_caption", { REF_CHARACTER } },
+	{ "change_character_desc", { REF_CHARACTER } },
+	{ "change_evidence_name", { REF_EVIDENCE } },
+	{ "change_evidence_caption", { REF_EVIDENCE } },
+	{ "change_evidence_desc", { REF_EVIDENCE } },
+	{ "set_location_state", { REF_LOCATION } },
+	{ "flashback_image", { REF_IMAGE } },
+	{ "hold_it", { REF_AUDIO } },
+	{ "objection", { REF_AUDIO } },
+	{ "take_that", { REF_AUDIO } }
+};
+
+// triggers that are understood by the player, but refer to nothing
+static const char *g_PlainTriggers[]={
+	"hide_text_box", "show_text_box", "hide_evidence", "request_evidence", "request_answer",
+	"request_image_contradiction", "halt_music", "fade_out", "flash", "special_effect",
+	"move_court_camera", "hide_temp_image", "resume_cross_examination", "fade_bg",
+	"restore_bg"
+};
+
+typedef std::tr1::unordered_map<std::string, int> IdIndex;
+
+// a node in the dependency graph
+struct _Node {
+	RefKind kind;
+	std::string id;
+	bool defined; // false for references to objects that don't exist
+	bool reachable;
+};
+typedef struct _Node Node;
+
+// an edge in the dependency graph
+struct _Edge {
+	int from;
+	int to;
+	std::string via; // trigger or field that made the reference
+};
+typedef struct _Edge Edge;
+
+// the whole dependency graph
+struct _Graph {
+	std::vector<Node> nodes;
+	std::vector<Edge> edges;
+	std::vector<std::vector<int> > out; // outgoing edge indices per node
+	IdIndex index[REF_KIND_COUNT];
+	std::vector<std::string> errors;
+};
+typedef struct _Graph Graph;
+
+// a case file held in memory
+struct _Reader {
+	const char *data;
+	int size;
+	int pos;
+	bool overrun;
+};
+typedef struct _Reader Reader;
+
+// move the read position, flagging offsets outside the file
+static void seek(Reader &r, int offset) {
+	if (offset<0 || offset>r.size) {
+		r.overrun=true;
+		r.pos=r.size;
+	}
+	
+	else
+		r.pos=offset;
+}
+
+// read an integer
+static int readInt(Reader &r) {
+	int value=0;
+	if ((int) sizeof(int)>r.size-r.pos) {
+		r.overrun=true;
+		r.pos=r.size;
+		return 0;
+	}
+	
+	memcpy(&value, r.data+r.pos, sizeof(int));
+	r.pos+=sizeof(int);
+	return value;
+}
+
+// read a boolean
+static bool readBool(Reader &r) {
+	bool value=false;
+	if ((int) sizeof(bool)>r.size-r.pos) {
+		r.overrun=true;
+		r.pos=r.size;
+		return false;
+	}
+	
+	memcpy(&value, r.data+r.pos, sizeof(bool));
+	r.pos+=sizeof(bool);
+	return value;
+}
+
+// read a string of 4 byte characters, keeping them as they are
+static void readChars(Reader &r, std::vector<unsigned int> &str) {
+	int len=readInt(r);
+	if (len<0 || len>(r.size-r.pos)/4) {
+		r.overrun=true;
+		r.pos=r.size;
+		str.clear();
+		return;
+	}
+	
+	str.resize(len);
+	if (len>0)
+		memcpy(&str[0], r.data+r.pos, len*4);
+	r.pos+=len*4;
+}
+
+// convert 4 byte characters to utf-8
+static std::string toUTF8(const unsigned int *str, int len) {
+	std::string out;
+	out.reserve(len);
+	for (int i=0; i<len; i++) {
+		unsigned int ch=str[i];
+		if (ch<0x80)
+			out+=(char) ch;
+		else if (ch<0x800) {
+			out+=(char) (0xc0 | (ch >> 6));
+			out+=(char) (0x80 | (ch & 0x3f));
+		}
+		else if (ch<0x10000) {
+			out+=(char) (0xe0 | (ch >> 12));
+			out+=(char) (0x80 | ((ch >> 6) & 0x3f));
+			out+=(char) (0x80 | (ch & 0x3f));
+		}
+		else {
+			out+=(char) (0xf0 | (ch >> 18));
+			out+=(char) (0x80 | ((ch >> 12) & 0x3f));
+			out+=(char) (0x80 | ((ch >> 6) & 0x3f));
+			out+=(char) (0x80 | (ch & 0x3f));
+		}
+	}
+	
+	return out;
+}
+
+// read a string as utf-8
+static std::string readUTF8(Reader &r) {
+	static std::vector<unsigned int> chars;
+	readChars(r, chars);
+	return (chars.empty() ? std::string() : toUTF8(&chars[0], chars.size()));
+}
+
+// skip over an image
+static void skipImage(Reader &r) {
+	int size=readInt(r);
+	if (size<=0 || size>r.size-r.pos) {
+		r.overrun=true;
+		r.pos=r.size;
+		return;
+	}
+	
+	r.pos+=size;
+}
+
+// get the node for an object, adding it if needed
+static int getNode(Graph &g, RefKind kind, const std::string &id) {
+	IdIndex::iterator it=g.index[kind].find(id);
+	if (it!=g.index[kind].end())
+		return (*it).second;
+	
+	Node node;
+	node.kind=kind;
+	node.id=id;
+	node.defined=false;
+	node.reachable=false;
+	
+	g.nodes.push_back(node);
+	g.out.push_back(std::vector<int>());
+	g.index[kind][id]=g.nodes.size()-1;
+	
+	return g.nodes.size()-1;
+}
+
+// define an object that exists in the case
+static int defineNode(Graph &g, RefKind kind, const std::string &id) {
+	int node=getNode(g, kind, id);
+	g.nodes[node].defined=true;
+	return node;
+}
+
+// see if a reference is intentionally empty
+static bool isEmptyRef(const std::string &id) {
+	return (id.empty() || id=="null" || id=="none");
+}
+
+// add a reference from one node to an object
+static void addRef(Graph &g, int from, RefKind kind, const std::string &id, const std::string &via) {
+	if (kind==REF_NONE || isEmptyRef(id))
+		return;
+	
+	// blocks with this prefix are generated by the player itself
+	if (kind==REF_BLOCK && id.compare(0, 9, "INTERNAL_")==0)
+		return;
+	
+	Edge edge;
+	edge.from=from;
+	edge.to=getNode(g, kind, id);
+	edge.via=via;
+	
+	g.edges.push_back(edge);
+	g.out[from].push_back(g.edges.size()-1);
+}
+
+// split trigger arguments the same way the player does
+static std::vector<std::string> splitArgs(const std::string &args) {
+	std::vector<std::string> split;
+	std::string::size_type start=0;
+	while(1) {
+		std::string::size_type npos=args.find(',', start);
+		if (npos==std::string::npos) {
+			split.push_back(args.substr(start));
+			break;
+		}
+		
+		split.push_back(args.substr(start, npos-start));
+		start=npos+1;
+	}
+	
+	return split;
+}
+
+// find a trigger's reference table
+static const TriggerRefs* findTrigger(const std::string &name, bool &known) {
+	static IdIndex index;
+	if (index.empty()) {
+		for (int i=0; i<(int) (sizeof(g_TriggerRefs)/sizeof(TriggerRefs)); i++)
+			index[g_TriggerRefs[i].name]=i;
+		for (int i=0; i<(int) (sizeof(g_PlainTriggers)/sizeof(const char*)); i++)
+			index[g_PlainTriggers[i]]=-1;
+	}
+	
+	IdIndex::iterator it=index.find(name);
+	known=(it!=index.end());
+	if (!known || (*it).second<0)
+		return NULL;
+	
+	return &g_TriggerRefs[(*it).second];
+}
+
+// find an unsigned int in a character string
+static int findChar(const std::vector<unsigned int> &str, unsigned int ch, int pos) {
+	for (int i=pos; i<(int) str.size(); i++) {
+		if (str[i]==ch)
+			return i;
+	}
+	
+	return -1;
+}
+
+// scan a text block for triggers, the same way the player compiles it
+static void scanScript(Graph &g, int from, const std::vector<unsigned int> &block, const std::string &where) {
+	bool tagOpen=false;
+	int pos=0;
+	int size=block.size();
+	while(pos<size) {
+		unsigned int ch=block[pos];
+		unsigned int next=(pos+1<size ? block[pos+1] : 0);
+		
+		// tags can't contain triggers
+		if (ch=='<') {
+			int end=findChar(block, '>', pos);
+			if (end==-1)
+				break;
+			
+			tagOpen=!tagOpen;
+			pos=end+1;
+		}
+		
+		// trigger, in the form of {*op:args;*}
+		else if (ch=='{') {
+			int colon=findChar(block, ':', pos);
+			if (colon==-1)
+				break;
+			
+			int semicolon=findChar(block, ';', colon);
+			int end=findChar(block, '}', colon);
+			
+			std::string name=(colon-pos-2>0 ? toUTF8(&block[pos+2], colon-pos-2) : std::string());
+			int argsEnd=(semicolon==-1 ? size : semicolon);
+			std::string args=(argsEnd-colon-1>0 ? toUTF8(&block[colon+1], argsEnd-colon-1) : std::string());
+			
+			bool known;
+			const TriggerRefs *refs=findTrigger(name, known);
+			if (!known)
+				g.errors.push_back(where+": unknown trigger '"+name+"'");
+			
+			else if (refs) {
+				std::vector<std::string> params=splitArgs(args);
+				for (int i=0; i<3 && i<(int) params.size(); i++)
+					addRef(g, from, refs->args[i], params[i], name);
+				
+				// the state needs to exist in the location; states are named location#state
+				if (name=="set_location_state" && params.size()>=2)
+					addRef(g, from, REF_STATE, params[0]+"#"+params[1], name);
+			}
+			
+			pos=(end==-1 ? size : end+1);
+		}
+		
+		// dialogue control; speed changes and pauses carry extra characters
+		else if (ch=='\\' && next!='n') {
+			if (next=='+' || next=='-')
+				pos+=3;
+			else if (next=='p')
+				pos+=4;
+			else
+				pos+=2;
+		}
+		
+		else
+			pos++;
+	}
+}
+
+// load a case file into the graph
+static bool loadCase(Reader &r, Graph &g, std::vector<int> &roots) {
+	PWTHeader header;
+	if (r.size<(int) sizeof(PWTHeader)) {
+		std::cout << "This is not a valid case file: file is too small.\n";
+		return false;
+	}
+	memcpy(&header, r.data, sizeof(PWTHeader));
+	
+	// compare magic number
+	if (header.ident!=MAGIC_NUM) {
+		std::cout << "This is not a valid case file. Expected magic number '" << MAGIC_NUM << "', read '" << header.ident << "'.\n";
+		return false;
+	}
+	
+	// check version
+	if (header.version!=VERSION) {
+		std::cout << "Unsupported file version. Expected '" << VERSION << "', read '" << header.version << "'.\n";
+		return false;
+	}
+	
+	// the root of the graph refers to the initial and core blocks
+	int root=defineNode(g, REF_NONE, "case");
+	roots.push_back(root);
+	
+	// overview: name, author, law system and core blocks
+	seek(r, header.overviewOffset);
+	readUTF8(r);
+	readUTF8(r);
+	readInt(r);
+	for (int i=0; i<CORE_BLOCK_COUNT; i++)
+		addRef(g, root, REF_BLOCK, readUTF8(r), "core_block");
+	
+	// overrides, followed by the initial block
+	seek(r, header.overridesOffset);
+	readInt(r);
+	addRef(g, root, REF_IMAGE, readUTF8(r), "title_screen");
+	addRef(g, root, REF_BLOCK, readUTF8(r), "initial_block");
+	
+	// characters
+	seek(r, header.charOffset);
+	int count=readInt(r);
+	for (int i=0; i<count && !r.overrun; i++) {
+		defineNode(g, REF_CHARACTER, readUTF8(r));
+		readUTF8(r);
+		readInt(r);
+		readUTF8(r);
+		readUTF8(r);
+		readUTF8(r);
+		
+		// text box tag
+		if (readBool(r))
+			skipImage(r);
+		
+		// headshot and its thumbnail
+		if (readBool(r)) {
+			skipImage(r);
+			skipImage(r);
+		}
+	}
+	
+	// backgrounds
+	seek(r, header.bgOffset);
+	count=readInt(r);
+	for (int i=0; i<count && !r.overrun; i++) {
+		defineNode(g, REF_BACKGROUND, readUTF8(r));
+		readInt(r);
+		skipImage(r);
+	}
+	
+	// evidence; each can be presented as an item as well
+	seek(r, header.evidenceOffset);
+	count=readInt(r);
+	for (int i=0; i<count && !r.overrun; i++) {
+		std::string id=readUTF8(r);
+		int node=defineNode(g, REF_EVIDENCE, id);
+		defineNode(g, REF_ITEM, id);
+		readUTF8(r);
+		readUTF8(r);
+		readUTF8(r);
+		addRef(g, node, REF_IMAGE, readUTF8(r), "check_image");
+		skipImage(r);
+		skipImage(r);
+	}
+	
+	// images
+	seek(r, header.imgOffset);
+	count=readInt(r);
+	for (int i=0; i<count && !r.overrun; i++) {
+		defineNode(g, REF_IMAGE, readUTF8(r));
+		skipImage(r);
+	}
+	
+	// locations, with their hotspots and states
+	seek(r, header.locationOffset);
+	count=readInt(r);
+	for (int i=0; i<count && !r.overrun; i++) {
+		std::string id=readUTF8(r);
+		int node=defineNode(g, REF_LOCATION, id);
+		readUTF8(r);
+		
+		int hcount=readInt(r);
+		for (int j=0; j<hcount && !r.overrun; j++) {
+			seek(r, r.pos+4*(int) sizeof(int));
+			addRef(g, node, REF_BLOCK, readUTF8(r), "hotspot");
+		}
+		
+		int scount=readInt(r);
+		for (int j=0; j<scount && !r.overrun; j++) {
+			std::string state=readUTF8(r);
+			int stateNode=defineNode(g, REF_STATE, id+"#"+state);
+			addRef(g, node, REF_STATE, id+"#"+state, "state");
+			addRef(g, stateNode, REF_BACKGROUND, readUTF8(r), "background");
+		}
+	}
+	
+	// the court locations can be referred to all at once
+	defineNode(g, REF_LOCATION, "court");
+	
+	// audio
+	seek(r, header.audioOffset);
+	count=readInt(r);
+	for (int i=0; i<count && !r.overrun; i++) {
+		defineNode(g, REF_AUDIO, readUTF8(r));
+		readUTF8(r);
+	}
+	
+	// testimonies, and the blocks their pieces lead to
+	std::vector<unsigned int> text;
+	seek(r, header.testimonyOffset);
+	count=readInt(r);
+	for (int i=0; i<count && !r.overrun; i++) {
+		std::string id=readUTF8(r);
+		int node=defineNode(g, REF_TESTIMONY, id);
+		readUTF8(r);
+		addRef(g, node, REF_CHARACTER, readUTF8(r), "speaker");
+		addRef(g, node, REF_BLOCK, readUTF8(r), "next_block");
+		addRef(g, node, REF_LOCATION, readUTF8(r), "follow_location");
+		addRef(g, node, REF_BLOCK, readUTF8(r), "xexamine_end_block");
+		
+		int pcount=readInt(r);
+		for (int j=0; j<pcount && !r.overrun; j++) {
+			readChars(r, text);
+			scanScript(g, node, text, "testimony '"+id+"'");
+			
+			addRef(g, node, REF_ITEM, readUTF8(r), "present_id");
+			addRef(g, node, REF_BLOCK, readUTF8(r), "present_block");
+			addRef(g, node, REF_BLOCK, readUTF8(r), "press_block");
+			readBool(r);
+		}
+	}
+	
+	// and finally, all text blocks
+	seek(r, header.blockOffset);
+	count=readInt(r);
+	for (int i=0; i<count && !r.overrun; i++) {
+		std::string id=readUTF8(r);
+		int node=defineNode(g, REF_BLOCK, id);
+		
+		readChars(r, text);
+		scanScript(g, node, text, "block '"+id+"'");
+	}
+	
+	// characters can be presented as profiles as well
+	for (IdIndex::iterator it=g.index[REF_CHARACTER].begin(); it!=g.index[REF_CHARACTER].end(); ++it) {
+		if (g.nodes[(*it).second].defined)
+			defineNode(g, REF_ITEM, (*it).first);
+	}
+	
+	if (r.overrun) {
+		std::cout << "Case file is truncated or corrupt.\n";
+		return false;
+	}
+	
+	return true;
+}
+
+// mark everything reachable from the roots
+static void markReachable(Graph &g, const std::vector<int> &roots) {
+	std::vector<int> stack(roots);
+	for (int i=0; i<(int) roots.size(); i++)
+		g.nodes[roots[i]].reachable=true;
+	
+	while(!stack.empty()) {
+		int node=stack.back();
+		stack.pop_back();
+		
+		const std::vector<int> &out=g.out[node];
+		for (int i=0; i<(int) out.size(); i++) {
+			int to=g.edges[out[i]].to;
+			if (!g.nodes[to].reachable) {
+				g.nodes[to].reachable=true;
+				stack.push_back(to);
+			}
+		}
+	}
+}
+
+// escape a string for json output
+static std::string escapeJSON(const std::string &str) {
+	std::string out;
+	out.reserve(str.size()+2);
+	for (int i=0; i<(int) str.size(); i++) {
+		unsigned char ch=str[i];
+		if (ch=='"' || ch=='\\') {
+			out+='\\';
+			out+=ch;
+		}
+		else if (ch<0x20) {
+			char buf[8];
+			sprintf(buf, "\\u%04x", ch);
+			out+=buf;
+		}
+		else
+			out+=ch;
+	}
+	
+	return out;
+}
+
+// write the graph as json
+static bool writeGraph(const Graph &g, const std::string &path) {
+	FILE *f=(path=="-" ? stdout : fopen(path.c_str(), "w"));
+	if (!f)
+		return false;
+	
+	fputs("{\n  \"nodes\": [\n", f);
+	for (int i=0; i<(int) g.nodes.size(); i++) {
+		const Node &n=g.nodes[i];
+		fprintf(f, "    { \"index\": %d, \"kind\": \"%s\", \"id\": \"%s\", \"defined\": %s, \"reachable\": %s }%s\n",
+			i, g_KindNames[n.kind], escapeJSON(n.id).c_str(), (n.defined ? "true" : "false"),
+			(n.reachable ? "true" : "false"), (i+1<(int) g.nodes.size() ? "," : ""));
+	}
+	
+	fputs("  ],\n  \"edges\": [\n", f);
+	for (int i=0; i<(int) g.edges.size(); i++) {
+		const Edge &e=g.edges[i];
+		fprintf(f, "    { \"from\": %d, \"to\": %d, \"via\": \"%s\" }%s\n",
+			e.from, e.to, escapeJSON(e.via).c_str(), (i+1<(int) g.edges.size() ? "," : ""));
+	}
+	fputs("  ]\n}\n", f);
+	
+	if (f!=stdout)
+		fclose(f);
+	return true;
+}
+
+// get a readable name for a node
+static std::string describe(const Node &n) {
+	return std::string(g_KindNames[n.kind])+" '"+n.id+"'";
+}
+
+int main(int argc, char *argv[]) {
+	// check the amount of arguments
+	if (argc<2 || argc>3) {
+		std::cout << "Phoenix Wright Case Editor Tools\n";
+		std::cout << "Case Linker\n\n";
+		std::cout << "Usage: case_link <CASE_FILE> [GRAPH_FILE]\n";
+		std::cout << "Reports unresolved references and unreachable blocks in a case file.\n";
+		std::cout << "If GRAPH_FILE is given, the dependency graph is written to it as JSON ('-' for stdout).\n";
+		return 0;
+	}
+	
+	clock_t start=clock();
+	
+	// read the entire case file into memory
+	FILE *f=fopen(argv[1], "rb");
+	if (!f) {
+		std::cout << "Unable to open case file: '" << argv[1] << "'.\n";
+		return 2;
+	}
+	
+	fseek(f, 0, SEEK_END);
+	int size=ftell(f);
+	fseek(f, 0, SEEK_SET);
+	
+	std::vector<char> data(size>0 ? size : 1);
+	if (size>0 && fread(&data[0], 1, size, f)!=(size_t) size) {
+		std::cout << "Unable to read case file: '" << argv[1] << "'.\n";
+		fclose(f);
+		return 2;
+	}
+	fclose(f);
+	
+	Reader r;
+	r.data=&data[0];
+	r.size=size;
+	r.pos=0;
+	r.overrun=false;
+	
+	// build the graph
+	Graph g;
+	std::vector<int> roots;
+	if (!loadCase(r, g, roots))
+		return 2;
+	
+	markReachable(g, roots);
+	
+	// the graph goes to stdout on its own if requested, so keep the report out of it
+	bool toStdout=(argc==3 && std::string(argv[2])=="-");
+	std::ostream &out=(toStdout ? std::cerr : std::cout);
+	
+	// report problems found while scanning
+	for (int i=0; i<(int) g.errors.size(); i++)
+		out << "error: " << g.errors[i] << "\n";
+	
+	// report references to objects that don't exist
+	int unresolved=0;
+	for (int i=0; i<(int) g.edges.size(); i++) {
+		const Edge &e=g.edges[i];
+		if (!g.nodes[e.to].defined) {
+			out << "error: " << describe(g.nodes[e.from]) << ": " << e.via << " refers to unknown " << describe(g.nodes[e.to]) << "\n";
+			unresolved++;
+		}
+	}
+	
+	// and blocks that can never be run
+	int blocks=0, unreachable=0;
+	for (int i=0; i<(int) g.nodes.size(); i++) {
+		const Node &n=g.nodes[i];
+		if (n.kind!=REF_BLOCK || !n.defined)
+			continue;
+		
+		blocks++;
+		if (!n.reachable) {
+			out << "warning: " << describe(n) << " is unreachable\n";
+			unreachable++;
+		}
+	}
+	
+	if (argc==3 && !writeGraph(g, argv[2])) {
+		std::cout << "Unable to write graph file: '" << argv[2] << "'.\n";
+		return 2;
+	}
+	
+	double ms=(clock()-start)*1000.0/CLOCKS_PER_SEC;
+	out << "Linked " << blocks << " block(s), " << g.edges.size() << " reference(s) in " << ms << "ms: "
+	    << unresolved+g.errors.size() << " error(s), " << unreachable << " unreachable block(s).\n";
+	
+	return (unresolved+g.errors.size()>0 ? 1 : 0);
+}
@@ -28,6 +28,9 @@
 const int MAGIC_NUM=(('T' << 16) + ('W' << 8) + 'P');
 const int VERSION=10;
 
+// amount of core blocks stored in the overview
+const int CORE_BLOCK_COUNT=2;
+
 // the pwt file header
 struct _PWTHeader {
 	int ident; // magic number
@@ -48,7 +51,7 @@ struct _PWTHeader {
 typedef struct _PWTHeader PWTHeader;
 
 // read a string from file
-static std::string readString(FILE *f) {
+inline std::string readString(FILE *f) {
 	// read string length
 	int len;
 	fread(&len, sizeof(int), 1, f);